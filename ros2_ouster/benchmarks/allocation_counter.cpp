@@ -0,0 +1,76 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.hpp"
+
+namespace
+{
+
+std::atomic<uint64_t> g_calls{0};
+std::atomic<uint64_t> g_bytes{0};
+
+}  // namespace
+
+namespace benchmarks
+{
+
+AllocationCount allocations()
+{
+  AllocationCount count;
+  count.calls = g_calls.load(std::memory_order_relaxed);
+  count.bytes = g_bytes.load(std::memory_order_relaxed);
+  return count;
+}
+
+}  // namespace benchmarks
+
+// the nothrow forms of the standard library call these
+void * operator new(std::size_t size)
+{
+  g_calls.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(size, std::memory_order_relaxed);
+  void * ptr = std::malloc(size > 0 ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void * operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
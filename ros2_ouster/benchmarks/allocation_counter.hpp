@@ -0,0 +1,41 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ALLOCATION_COUNTER_HPP_
+#define ALLOCATION_COUNTER_HPP_
+
+#include <cstdint>
+
+namespace benchmarks
+{
+
+/**
+ * @brief Allocations made through operator new since the program started
+ */
+struct AllocationCount
+{
+  uint64_t calls{0};
+  uint64_t bytes{0};
+};
+
+/**
+ * @brief Allocations counted so far, by every thread. Linking
+ * allocation_counter.cpp replaces the global operator new to count them,
+ * memory allocated with malloc directly (e.g. by Eigen's aligned
+ * allocator used for PCL points) is not seen.
+ */
+AllocationCount allocations();
+
+}  // namespace benchmarks
+
+#endif  // ALLOCATION_COUNTER_HPP_
@@ -0,0 +1,130 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BENCHMARK_UTILS_HPP_
+#define BENCHMARK_UTILS_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "ros2_ouster/core/packet_generator.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace benchmarks
+{
+
+/**
+ * @brief Metadata of a synthetic sensor
+ * @param is_3d OLE_3D_V2 if true, OLE_2D_V2 otherwise
+ */
+inline ros2_ouster::Metadata makeMetadata(bool is_3d)
+{
+  return ros2_ouster::syntheticMetadata(is_3d ? "OLE_3D_V2" : "OLE_2D_V2");
+}
+
+/**
+ * @brief Synthetic lidar packets of a room, with some noise and a few
+ * returns missing. They hold 3 whole revolutions, so that they can be
+ * replayed in a loop: 250 packets of 12 blocks for 1000 blocks per
+ * revolution of the 3D lidar, 32 packets of 150 returns for 1600 returns
+ * per revolution of the 2D lidar.
+ * @param is_3d OLE_3D_V2 packets if true, OLE_2D_V2 otherwise
+ */
+inline std::vector<std::vector<uint8_t>> makePackets(bool is_3d)
+{
+  ros2_ouster::SyntheticScene scene = ros2_ouster::SyntheticScene::room();
+  scene.range_noise = 0.01;
+  scene.dropout = 0.01;
+  ros2_ouster::PacketGenerator generator(makeMetadata(is_3d), scene);
+
+  std::vector<std::vector<uint8_t>> packets(is_3d ? 250 : 32);
+  for (auto & packet : packets) {
+    packet.resize(generator.packetSize());
+    generator.next(packet.data());
+  }
+  return packets;
+}
+
+/**
+ * @brief Time and allocations of a measured run
+ */
+struct Measurement
+{
+  double seconds{0.0};
+  uint64_t allocations{0};
+  uint64_t bytes{0};
+};
+
+/**
+ * @brief Run a function a number of times after a warm up run, measuring
+ * the time taken and the allocations made
+ * @param iterations number of measured runs
+ * @param f the function to run
+ */
+template<typename F>
+Measurement measure(std::size_t iterations, F && f)
+{
+  f();
+
+  const AllocationCount before = allocations();
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; i++) {
+    f();
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  const AllocationCount after = allocations();
+
+  Measurement m;
+  m.seconds = std::chrono::duration<double>(stop - start).count();
+  m.allocations = after.calls - before.calls;
+  m.bytes = after.bytes - before.bytes;
+  return m;
+}
+
+/**
+ * @brief Print the header of the result table
+ * @param unit what one iteration processes, e.g. packet or frame
+ */
+inline void printHeader(const std::string & unit)
+{
+  const std::string per_unit = "ns/" + unit;
+  const std::string bytes_per_unit = "bytes/" + unit;
+  const std::string allocs_per_unit = "allocs/" + unit;
+  std::printf(
+    "%-28s %12s %14s %14s %14s\n", "benchmark", per_unit.c_str(), "Mpoints/s",
+    bytes_per_unit.c_str(), allocs_per_unit.c_str());
+}
+
+/**
+ * @brief Print a row of the result table
+ * @param name name of the benchmark
+ * @param units number of packets or frames processed
+ * @param points number of points produced
+ * @param m the measurement
+ */
+inline void printRow(
+  const std::string & name, std::size_t units, std::size_t points, const Measurement & m)
+{
+  std::printf(
+    "%-28s %12.1f %14.2f %14.1f %14.2f\n", name.c_str(),
+    m.seconds * 1e9 / units, points / m.seconds * 1e-6,
+    static_cast<double>(m.bytes) / units, static_cast<double>(m.allocations) / units);
+}
+
+}  // namespace benchmarks
+
+#endif  // BENCHMARK_UTILS_HPP_
@@ -0,0 +1,155 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Conversion of a decoded frame to the published messages: the
+// PointCloud2 and LaserScan toMsg conversions and the range and intensity
+// image fill loop, in ns per frame, points per second and heap
+// allocations per frame. Frames are decoded from synthetic packets.
+//
+// usage: conversion_benchmark [frames] [threads]
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+#include "ros2_ouster/conversions.hpp"
+#include "ros2_ouster/core/frame_decoder.hpp"
+#include "ros2_ouster/OS1/processors/image_processor.hpp"
+#include "ros2_ouster/thread_pool.hpp"
+
+namespace
+{
+
+/**
+ * @brief The last complete frame decoded from the synthetic packets
+ */
+ros2_ouster::LidarFrame decodeFrame(bool is_3d)
+{
+  ros2_ouster::FrameDecoder decoder(benchmarks::makeMetadata(is_3d));
+  const auto packets = benchmarks::makePackets(is_3d);
+
+  // the revolution the packets start in is not reported, it is partial
+  // with packets from a sensor
+  bool completed = false;
+  for (std::size_t i = 0; !completed; i = (i + 1) % packets.size()) {
+    completed = decoder.decode(packets[i].data());
+  }
+  return decoder.lastFrame();
+}
+
+void benchmarkPointCloud(
+  const ros2_ouster::LidarFrame & frame, std::size_t frames, ros2_ouster::ThreadPool * pool)
+{
+  // filled as the pointcloud processor does, only the conversion is timed
+  pcl::PointCloud<point_os::PointOS> cloud(frame.points.size() / frame.height, frame.height);
+  for (std::size_t i = 0; i < frame.size(); i++) {
+    const ros2_ouster::LidarPoint & pt = frame.points[i];
+    cloud.points[i] = point_os::PointOS::make(
+      pt.x, pt.y, pt.z, pt.intensity, pt.t, pt.reflectivity,
+      pt.ring, frame.id, pt.noise, pt.range);
+  }
+
+  const benchmarks::Measurement m = benchmarks::measure(
+    frames, [&]() {
+      uint32_t width = frame.width;
+      sensor_msgs::msg::PointCloud2 msg = ros2_ouster::toMsg(
+        cloud, width, std::chrono::nanoseconds(frame.timestamp), "laser_data_frame", pool);
+      (void)msg;
+    });
+  benchmarks::printRow(
+    pool ? "PointCloud2 toMsg, pool" : "PointCloud2 toMsg", frames, frames * frame.size(), m);
+}
+
+void benchmarkLaserScan(const ros2_ouster::LidarFrame & frame, std::size_t frames, bool is_3d)
+{
+  const ros2_ouster::Metadata mdata = benchmarks::makeMetadata(is_3d);
+  std::vector<scan_os::ScanOS> scans(frame.points.size());
+  for (std::size_t i = 0; i < frame.size(); i++) {
+    const ros2_ouster::LidarPoint & pt = frame.points[i];
+    scans[i] = scan_os::ScanOS::make(
+      pt.x, pt.y, pt.z, pt.intensity, pt.t, pt.reflectivity,
+      pt.ring, frame.id, pt.noise, pt.range);
+  }
+
+  const benchmarks::Measurement m = benchmarks::measure(
+    frames, [&]() {
+      uint32_t width = frame.width;
+      sensor_msgs::msg::LaserScan msg = ros2_ouster::toMsg(
+        scans, width, std::chrono::nanoseconds(frame.timestamp), "laser_data_frame",
+        mdata, static_cast<uint8_t>(mdata.ring_scan));
+      (void)msg;
+    });
+  benchmarks::printRow(
+    is_3d ? "LaserScan toMsg 3D" : "LaserScan toMsg 2D", frames, frames * frame.size(), m);
+}
+
+void benchmarkImageFill(
+  const ros2_ouster::LidarFrame & frame, std::size_t frames, ros2_ouster::ThreadPool * pool)
+{
+  // column shifts of the image processor
+  const std::vector<int> px_offset = {0, 6, 12, 18, 0, 6, 12, 18, 0, 6, 12, 18, 0, 6, 12, 18};
+  std::vector<uint8_t> range(frame.size());
+  std::vector<uint8_t> intensity(frame.size());
+
+  auto fill = [&](std::size_t begin, std::size_t end) {
+      OS1::fillImageRows(
+        frame.points.data(), frame.height, frame.width, px_offset, begin, end,
+        range.data(), intensity.data());
+    };
+  const benchmarks::Measurement m = benchmarks::measure(
+    frames, [&]() {
+      if (pool) {
+        pool->parallelFor(0, frame.height, 1, fill);
+      } else {
+        fill(0, frame.height);
+      }
+    });
+  benchmarks::printRow(
+    pool ? "image fill, pool" : "image fill", frames, frames * frame.size(), m);
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  std::size_t frames = 200;
+  std::size_t threads = std::thread::hardware_concurrency();
+  if (argc > 1) {
+    frames = std::strtoul(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    threads = std::strtoul(argv[2], nullptr, 10);
+  }
+  if (frames == 0) {
+    frames = 1;
+  }
+  if (threads == 0) {
+    threads = 1;
+  }
+
+  const ros2_ouster::LidarFrame frame_3d = decodeFrame(true);
+  const ros2_ouster::LidarFrame frame_2d = decodeFrame(false);
+  ros2_ouster::ThreadPool pool(threads);
+
+  benchmarks::printHeader("frame");
+  benchmarkPointCloud(frame_3d, frames, nullptr);
+  benchmarkPointCloud(frame_3d, frames, &pool);
+  benchmarkLaserScan(frame_3d, frames, true);
+  benchmarkLaserScan(frame_2d, frames, false);
+  benchmarkImageFill(frame_3d, frames, nullptr);
+  benchmarkImageFill(frame_3d, frames, &pool);
+  return 0;
+}
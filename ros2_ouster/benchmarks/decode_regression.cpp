@@ -0,0 +1,420 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Golden output check of the decoding paths against the reference
+// batch_to_iter2 / batch_to_iter3 functions: ros2_ouster::FrameDecoder at
+// full resolution and with column decimation, and packets through the
+// compression of recordings. Frames must split after the same packets
+// with the same widths and timestamps, and every point must match within
+// the tolerances below. Runs on synthetic packets, and on recordings
+// given as arguments, without hardware.
+//
+// usage: decode_regression [recording...]
+// exits with 1 if any path differs from the reference
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ros2_ouster/OS1/OS1_util.hpp"
+#include "ros2_ouster/core/frame_decoder.hpp"
+#include "ros2_ouster/core/load_generator.hpp"
+#include "ros2_ouster/core/packet_codec.hpp"
+#include "ros2_ouster/core/packet_generator.hpp"
+#include "ros2_ouster/core/recording_format.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace
+{
+
+// largest difference of a coordinate in m, a tenth of the range
+// resolution of the 3D lidar; other fields must be equal
+constexpr double XYZ_TOLERANCE = 1e-4;
+
+// columns of the frame the reference decodes into, and of FrameDecoder
+constexpr uint32_t MAX_WIDTH = 2000;
+constexpr uint32_t REFERENCE_WIDTH = 8192;
+
+using Points = std::vector<ros2_ouster::LidarPoint>;
+using Packets = std::vector<std::vector<uint8_t>>;
+
+/**
+ * @brief A frame decoded, with the packet that completed it
+ */
+struct Frame
+{
+  std::size_t packet{0};
+  uint64_t timestamp{0};
+  uint32_t width{0};
+  uint32_t height{0};
+  Points points;
+};
+
+/**
+ * @brief Outcome of comparing a path with the reference
+ */
+struct Result
+{
+  std::size_t frames{0};
+  std::size_t points{0};
+  double max_error{0.0};
+  std::size_t failures{0};
+  std::string first_failure;
+
+  void fail(const std::string & message)
+  {
+    if (failures++ == 0) {
+      first_failure = message;
+    }
+  }
+};
+
+bool is3D(const ros2_ouster::Metadata & mdata)
+{
+  return mdata.lidar_vendor == std::string("OLE_3D_V2");
+}
+
+Packets generatePackets(
+  const ros2_ouster::Metadata & mdata, double rotation_rate, uint32_t columns, uint32_t seed,
+  std::size_t revolutions)
+{
+  ros2_ouster::SyntheticScene scene = ros2_ouster::SyntheticScene::room();
+  scene.range_noise = 0.01;
+  scene.dropout = 0.02;
+  ros2_ouster::PacketGenerator generator(mdata, scene, rotation_rate, columns, seed);
+
+  // 24 columns in a 3D packet, 150 in a 2D one
+  const bool is_3d = is3D(mdata);
+  const std::size_t width = columns > 0 ? columns : (is_3d ? 2000 : 1600);
+  const std::size_t per_packet = is_3d ? 24 : 150;
+  Packets packets(revolutions * width / per_packet + 1);
+  for (auto & packet : packets) {
+    packet.resize(generator.packetSize());
+    generator.next(packet.data());
+  }
+  return packets;
+}
+
+Packets recordedPackets(const ros2_ouster::RecordedPackets & recording)
+{
+  Packets packets;
+  for (std::size_t i = 0; i + 1 < recording.offsets.size(); i++) {
+    packets.emplace_back(
+      recording.data.begin() + recording.offsets[i],
+      recording.data.begin() + recording.offsets[i + 1]);
+  }
+  return packets;
+}
+
+/**
+ * @brief Decode with the batch_to_iter2 / batch_to_iter3 functions the
+ * driver decoded with before FrameDecoder
+ */
+std::vector<Frame> decodeReference(const ros2_ouster::Metadata & mdata, const Packets & packets)
+{
+  const bool is_3d = is3D(mdata);
+  const uint32_t height = is_3d ? 16 : 1;
+  const std::vector<double> sin_lut = OS1::make_sin_lut();
+  const std::vector<double> cos_lut = OS1::make_cos_lut();
+
+  // as FrameDecoder, pad the calibration of missing rings
+  std::vector<double> x_offset_array = mdata.x_offset_array;
+  std::vector<double> y_offset_array = mdata.y_offset_array;
+  std::vector<double> av_offset_array = mdata.av_offset_array;
+  x_offset_array.resize(height, 0.0);
+  y_offset_array.resize(height, 0.0);
+  av_offset_array.resize(height, 0.0);
+
+  uint64_t id_frame = 0;
+  uint32_t id_col = 0;
+  int32_t azimuth_last = -1;
+  int64_t ts_last = -1;
+  uint32_t realwidth = 0;
+  Points points(static_cast<std::size_t>(REFERENCE_WIDTH) * height);
+  std::vector<Frame> frames;
+  std::size_t index = 0;
+
+  auto make_point = [](
+    float x, float y, float z, float intensity, uint32_t t, uint16_t reflectivity,
+    uint8_t ring, uint64_t /*frame*/, uint16_t noise, uint32_t range) {
+      return ros2_ouster::LidarPoint{x, y, z, intensity, t, reflectivity, ring, noise, range};
+    };
+  // called on the wrap, before the columns of the next frame are written
+  auto on_frame = [&](uint64_t ts, uint32_t width) {
+      Frame frame;
+      frame.packet = index;
+      frame.timestamp = ts;
+      frame.width = width;
+      frame.height = height;
+      frame.points.assign(
+        points.begin(), points.begin() + static_cast<std::size_t>(width) * height);
+      frames.push_back(std::move(frame));
+    };
+
+  // both log to stdout, hidden
+  std::ostringstream sink;
+  std::streambuf * stdout_buf = std::cout.rdbuf(sink.rdbuf());
+  std::function<void(const uint8_t *, Points::iterator, uint64_t)> batch;
+  if (is_3d) {
+    batch = OS1::batch_to_iter2<Points::iterator>(
+      sin_lut, cos_lut, x_offset_array, y_offset_array,
+      mdata.ah_offset_array, av_offset_array, id_frame, id_col, azimuth_last,
+      ts_last, realwidth, ros2_ouster::LidarPoint(), make_point, on_frame);
+  } else {
+    batch = OS1::batch_to_iter3<Points::iterator>(
+      sin_lut, cos_lut, x_offset_array, y_offset_array,
+      mdata.ah_offset_array, av_offset_array, id_frame, id_col, azimuth_last,
+      ts_last, realwidth, ros2_ouster::LidarPoint(), make_point, on_frame);
+  }
+
+  // the reference writes past the frame unchecked, stop short of that
+  const uint32_t per_packet = is_3d ? 24 : 150;
+  for (index = 0; index < packets.size(); index++) {
+    if (id_col + per_packet > REFERENCE_WIDTH) {
+      std::cout.rdbuf(stdout_buf);
+      throw ros2_ouster::OusterDriverException(
+              "Frame wider than " + std::to_string(REFERENCE_WIDTH) + " columns.");
+    }
+    batch(packets[index].data(), points.begin(), 0);
+    sink.str(std::string());
+  }
+  std::cout.rdbuf(stdout_buf);
+  return frames;
+}
+
+std::vector<Frame> decodeFrames(
+  const ros2_ouster::Metadata & mdata, const Packets & packets, uint32_t decimation)
+{
+  ros2_ouster::FrameDecoder decoder(mdata, MAX_WIDTH);
+  decoder.setColumnDecimation(decimation);
+  decoder.reset();
+
+  std::vector<Frame> frames;
+  std::size_t index = 0;
+  decoder.setFrameCallback(
+    [&](const ros2_ouster::LidarFrame & lidar_frame) {
+      Frame frame;
+      frame.packet = index;
+      frame.timestamp = lidar_frame.timestamp;
+      frame.width = lidar_frame.width;
+      frame.height = lidar_frame.height;
+      frame.points.assign(
+        lidar_frame.points.begin(), lidar_frame.points.begin() + lidar_frame.size());
+      frames.push_back(std::move(frame));
+    });
+
+  for (index = 0; index < packets.size(); index++) {
+    decoder.decode(packets[index].data());
+  }
+  return frames;
+}
+
+/**
+ * @brief The packets after compressing and decompressing them as
+ * compressed recordings do, in blocks of records
+ */
+Packets roundTrip(const ros2_ouster::Metadata & mdata, const Packets & packets)
+{
+  constexpr std::size_t BLOCK = 64;
+  ros2_ouster::PacketCodec codec(mdata);
+  Packets decoded;
+  std::vector<uint8_t> records;
+  std::vector<uint8_t> compressed;
+  std::vector<uint8_t> decompressed;
+  for (std::size_t start = 0; start < packets.size(); start += BLOCK) {
+    const std::size_t count = std::min(BLOCK, packets.size() - start);
+    records.clear();
+    for (std::size_t i = start; i < start + count; i++) {
+      ros2_ouster::recording::RecordHeader header;
+      header.receive_time = i * 781250;
+      header.size = static_cast<uint32_t>(packets[i].size());
+      header.state = ros2_ouster::ClientState::LIDAR_DATA;
+      const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&header);
+      records.insert(records.end(), bytes, bytes + sizeof(header));
+      records.insert(records.end(), packets[i].begin(), packets[i].end());
+    }
+
+    const std::size_t encoded_size =
+      codec.compress(records.data(), records.size(), count, compressed);
+    if (!codec.decompress(
+        compressed.data(), compressed.size(), count, encoded_size, decompressed))
+    {
+      throw ros2_ouster::OusterDriverException("Failed to decompress a block.");
+    }
+
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      ros2_ouster::recording::RecordHeader header;
+      std::memcpy(&header, decompressed.data() + offset, sizeof(header));
+      offset += sizeof(header);
+      decoded.emplace_back(
+        decompressed.begin() + offset, decompressed.begin() + offset + header.size);
+      offset += header.size;
+    }
+  }
+  return decoded;
+}
+
+void comparePoint(
+  const ros2_ouster::LidarPoint & expected, const ros2_ouster::LidarPoint & actual,
+  const std::string & where, Result & result)
+{
+  const double error = std::max(
+    {std::fabs(expected.x - actual.x), std::fabs(expected.y - actual.y),
+      std::fabs(expected.z - actual.z)});
+  result.max_error = std::max(result.max_error, error);
+  result.points++;
+
+  std::string field;
+  if (!(error <= XYZ_TOLERANCE)) {
+    field = "xyz off by " + std::to_string(error) + " m";
+  } else if (expected.intensity != actual.intensity) {
+    field = "intensity " + std::to_string(actual.intensity) + " instead of " +
+      std::to_string(expected.intensity);
+  } else if (expected.ring != actual.ring) {
+    field = "ring " + std::to_string(actual.ring) + " instead of " +
+      std::to_string(expected.ring);
+  } else if (expected.t != actual.t) {
+    field = "t " + std::to_string(actual.t) + " instead of " + std::to_string(expected.t);
+  } else if (expected.range != actual.range) {
+    field = "range " + std::to_string(actual.range) + " instead of " +
+      std::to_string(expected.range);
+  } else if (expected.reflectivity != actual.reflectivity || expected.noise != actual.noise) {
+    field = "reflectivity or noise";
+  }
+  if (!field.empty()) {
+    result.fail(where + ": " + field);
+  }
+}
+
+/**
+ * @brief Compare frames with those of the reference, keeping every
+ * decimation-th column of them
+ */
+Result compare(
+  const std::vector<Frame> & reference, const std::vector<Frame> & frames, uint32_t decimation)
+{
+  Result result;
+  result.frames = frames.size();
+  if (frames.size() != reference.size()) {
+    result.fail(
+      std::to_string(frames.size()) + " frames instead of " + std::to_string(reference.size()));
+  }
+
+  for (std::size_t f = 0; f < std::min(frames.size(), reference.size()); f++) {
+    const Frame & expected = reference[f];
+    const Frame & actual = frames[f];
+    const std::string where = "frame " + std::to_string(f);
+    const uint32_t width =
+      std::min((expected.width + decimation - 1) / decimation, MAX_WIDTH);
+    if (actual.packet != expected.packet) {
+      result.fail(
+        where + ": split after packet " + std::to_string(actual.packet) + " instead of " +
+        std::to_string(expected.packet));
+    }
+    if (actual.width != width || actual.height != expected.height) {
+      result.fail(
+        where + ": " + std::to_string(actual.width) + "x" + std::to_string(actual.height) +
+        " instead of " + std::to_string(width) + "x" + std::to_string(expected.height));
+      continue;
+    }
+    if (actual.timestamp != expected.timestamp) {
+      result.fail(
+        where + ": timestamp " + std::to_string(actual.timestamp) + " instead of " +
+        std::to_string(expected.timestamp));
+    }
+
+    for (uint32_t col = 0; col < width; col++) {
+      for (uint32_t ring = 0; ring < expected.height; ring++) {
+        comparePoint(
+          expected.points[(static_cast<std::size_t>(col) * decimation) * expected.height + ring],
+          actual.points[static_cast<std::size_t>(col) * actual.height + ring],
+          where + " column " + std::to_string(col) + " ring " + std::to_string(ring), result);
+      }
+    }
+  }
+  return result;
+}
+
+bool report(const std::string & name, const Result & result)
+{
+  std::printf(
+    "%-40s %8lu %10lu %12.2e %s\n", name.c_str(), static_cast<unsigned long>(result.frames),
+    static_cast<unsigned long>(result.points), result.max_error,
+    result.failures == 0 ? "ok" : "FAILED");
+  if (result.failures > 0) {
+    std::printf(
+      "  %lu differences, first: %s\n", static_cast<unsigned long>(result.failures),
+      result.first_failure.c_str());
+  }
+  return result.failures == 0;
+}
+
+/**
+ * @brief Check every path on a corpus of packets
+ */
+bool check(const std::string & name, const ros2_ouster::Metadata & mdata, const Packets & packets)
+{
+  const std::vector<Frame> reference = decodeReference(mdata, packets);
+  if (reference.empty()) {
+    std::printf("%-40s no complete frame, skipped\n", name.c_str());
+    return true;
+  }
+
+  bool ok = report(name + " FrameDecoder", compare(reference, decodeFrames(mdata, packets, 1), 1));
+  for (const uint32_t decimation : {2u, 3u, 4u}) {
+    ok &= report(
+      name + " decimation " + std::to_string(decimation),
+      compare(reference, decodeFrames(mdata, packets, decimation), decimation));
+  }
+  ok &= report(
+    name + " compressed", compare(reference, decodeFrames(mdata, roundTrip(mdata, packets), 1), 1));
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  std::printf(
+    "%-40s %8s %10s %12s %s\n", "path", "frames", "points", "max xyz err", "result");
+
+  bool ok = true;
+  try {
+    for (const char * vendor : {"OLE_3D_V2", "OLE_2D_V2"}) {
+      const ros2_ouster::Metadata mdata = ros2_ouster::syntheticMetadata(vendor);
+      const bool is_3d = is3D(mdata);
+      const std::string format = is_3d ? "3D" : "2D";
+      ok &= check(format + " 10 Hz", mdata, generatePackets(mdata, 10.0, 0, 1, 8));
+      ok &= check(format + " 20 Hz", mdata, generatePackets(mdata, 20.0, 0, 2, 8));
+      ok &= check(
+        format + " narrow", mdata, generatePackets(mdata, 10.0, is_3d ? 1024 : 720, 3, 8));
+    }
+
+    for (int i = 1; i < argc; i++) {
+      const auto recording = ros2_ouster::RecordedPackets::load(argv[i]);
+      ok &= check(argv[i], recording->metadata, recordedPackets(*recording));
+    }
+  } catch (const ros2_ouster::OusterDriverException & e) {
+    std::printf("error: %s\n", e.what());
+    return 1;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,631 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The whole driver under load, for each processor mask and QoS setting:
+// packets are sent over loopback by a load generator to the OS1 sensor
+// (or served in process by the synthetic sensor), the outputs are
+// received by a subscriber in the same process. Reports packet loss,
+// messages per second, CPU use of each core and of the process, and the
+// latency from the kernel receiving the packet that completes a frame to
+// the subscriber receiving the message of the frame, as JSON.
+//
+// The load generator runs in the process, its thread is included in the
+// CPU use. Messages stamped with the time published rather than the
+// sensor time (LaserScan of OLE_2D_V2 sensors) have no latency measured.
+//
+// usage: end_to_end_benchmark [--help] [options]
+
+#include <getopt.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "jsoncpp/json/json.h"
+#include "rclcpp/rclcpp.hpp"
+#include "sensor_msgs/msg/image.hpp"
+#include "sensor_msgs/msg/imu.hpp"
+#include "sensor_msgs/msg/laser_scan.hpp"
+#include "sensor_msgs/msg/point_cloud2.hpp"
+#include "ouster_msgs/msg/packet_batch.hpp"
+#include "ros2_ouster/core/frame_decoder.hpp"
+#include "ros2_ouster/core/load_generator.hpp"
+#include "ros2_ouster/core/packet_generator.hpp"
+#include "ros2_ouster/interfaces/sensor_interface.hpp"
+#include "ros2_ouster/OS1/OS1_sensor.hpp"
+#include "ros2_ouster/OS1/processor_factories.hpp"
+#include "ros2_ouster/OS1/synthetic_sensor.hpp"
+#include "ros2_ouster/ouster_driver.hpp"
+
+namespace
+{
+
+struct Options
+{
+  std::string sensor{"udp"};          // udp or synthetic
+  std::string vendor{"OLE_3D_V2"};
+  std::string recording;              // replayed by the load generator if set
+  double rotation_rate{10.0};
+  double rate{1.0};
+  int port{2368};
+  int threads{1};
+  double warmup{2.0};
+  double duration{10.0};
+  std::vector<std::string> masks{"PCL", "IMG", "SCAN", "PCL|IMG|SCAN"};
+  std::vector<std::string> qos{"sensor_data", "system_default"};
+  std::string output{"end_to_end_benchmark.json"};
+};
+
+uint64_t systemNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::vector<std::string> splitList(const std::string & list)
+{
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+/**
+ * @class MeasuredSensor
+ * @brief Wraps the sensor of the driver, counting the lidar packets and
+ * keeping the time the packet completing each frame was received, keyed
+ * by the stamp FrameDecoder gives the frame
+ */
+class MeasuredSensor : public ros2_ouster::SensorInterface
+{
+public:
+  MeasuredSensor(std::unique_ptr<ros2_ouster::SensorInterface> sensor, bool is_3d)
+  : _sensor(std::move(sensor)), _is_3d(is_3d), _packets(0), _azimuth_last(-1), _stamp(0)
+  {
+  }
+
+  void reset(const ros2_ouster::Configuration & config) override
+  {
+    _sensor->reset(config);
+  }
+
+  void configure(const ros2_ouster::Configuration & config) override
+  {
+    _sensor->configure(config);
+  }
+
+  ros2_ouster::ClientState get() override
+  {
+    return _sensor->get();
+  }
+
+  uint8_t * readPacket(const ros2_ouster::ClientState & state) override
+  {
+    uint8_t * data = _sensor->readPacket(state);
+    if (!data || state != ros2_ouster::ClientState::LIDAR_DATA) {
+      return data;
+    }
+
+    // as OusterCore does, the sensor may not know the receive time
+    uint64_t receive_time = _sensor->receiveTime();
+    if (receive_time == 0) {
+      receive_time = systemNow();
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _packets++;
+    if (ros2_ouster::FrameDecoder::wrapsAround(data, _is_3d, _azimuth_last)) {
+      if (_stamp != 0) {
+        _completed[_stamp] = receive_time;
+        if (_completed.size() > 1000) {
+          _completed.erase(_completed.begin());
+        }
+      }
+      uint32_t ts;
+      if (_is_3d) {
+        std::memcpy(&ts, data + 1200, sizeof(uint32_t));
+        _stamp = static_cast<uint64_t>(ts * 1e3);
+      } else {
+        std::memcpy(&ts, data + 28, sizeof(uint32_t));
+        _stamp = static_cast<uint64_t>(ts * 1e6);
+      }
+    }
+    return data;
+  }
+
+  uint64_t receiveTime() const override
+  {
+    return _sensor->receiveTime();
+  }
+
+  void setIdle(bool idle) override
+  {
+    _sensor->setIdle(idle);
+  }
+
+  std::size_t drain() override
+  {
+    return _sensor->drain();
+  }
+
+  uint64_t packets()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _packets;
+  }
+
+  /**
+   * @brief Time the frame of a stamp was completed, 0 if unknown
+   */
+  uint64_t completed(uint64_t stamp)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _completed.find(stamp);
+    return it != _completed.end() ? it->second : 0;
+  }
+
+private:
+  std::unique_ptr<ros2_ouster::SensorInterface> _sensor;
+  bool _is_3d;
+  std::mutex _mutex;
+  uint64_t _packets;
+  int32_t _azimuth_last;
+  uint64_t _stamp;                          // stamp of the frame assembling
+  std::map<uint64_t, uint64_t> _completed;  // stamp to receive time
+};
+
+/**
+ * @struct TopicStatistics
+ * @brief Messages received on a topic and their latencies in ns
+ */
+struct TopicStatistics
+{
+  uint64_t messages{0};
+  std::vector<uint64_t> latencies;
+};
+
+/**
+ * @class Subscriber
+ * @brief Subscribes to the outputs of a processor mask, recording when
+ * messages arrive
+ */
+class Subscriber
+{
+public:
+  Subscriber(
+    const std::string & mask, const rclcpp::QoS & qos, MeasuredSensor * sensor)
+  : _node(std::make_shared<rclcpp::Node>("end_to_end_subscriber")), _sensor(sensor)
+  {
+    const std::uint32_t bits = ros2_ouster::toProcMask(mask);
+    if (bits & ros2_ouster::OS1_PROC_PCL) {
+      subscribe<sensor_msgs::msg::PointCloud2>("points", qos);
+    }
+    if (bits & ros2_ouster::OS1_PROC_IMG) {
+      subscribe<sensor_msgs::msg::Image>("range_image", qos);
+      subscribe<sensor_msgs::msg::Image>("intensity_image", qos);
+    }
+    if (bits & ros2_ouster::OS1_PROC_SCAN) {
+      subscribe<sensor_msgs::msg::LaserScan>("scan", qos);
+    }
+    if (bits & ros2_ouster::OS1_PROC_IMU) {
+      subscribe<sensor_msgs::msg::Imu>("imu", qos);
+    }
+    if (bits & ros2_ouster::OS1_PROC_RAW) {
+      _subscriptions.push_back(
+        _node->create_subscription<ouster_msgs::msg::PacketBatch>(
+          "packets", qos,
+          [this](const ouster_msgs::msg::PacketBatch::SharedPtr msg) {
+            // latency of the last packet of the batch
+            const uint64_t now = systemNow();
+            const uint64_t received = msg->receive_times.empty() ? 0 : msg->receive_times.back();
+            record("packets", received != 0 && now > received ? now - received : 0);
+          }));
+    }
+  }
+
+  rclcpp::Node::SharedPtr node()
+  {
+    return _node;
+  }
+
+  /**
+   * @brief Take the statistics so far and start over
+   */
+  std::map<std::string, TopicStatistics> take()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::map<std::string, TopicStatistics> statistics;
+    statistics.swap(_statistics);
+    return statistics;
+  }
+
+private:
+  template<typename MessageT>
+  void subscribe(const std::string & topic, const rclcpp::QoS & qos)
+  {
+    _subscriptions.push_back(
+      _node->create_subscription<MessageT>(
+        topic, qos,
+        [this, topic](const typename MessageT::SharedPtr msg) {
+          const uint64_t now = systemNow();
+          const uint64_t stamp =
+          static_cast<uint64_t>(msg->header.stamp.sec) * 1000000000ull + msg->header.stamp.nanosec;
+          const uint64_t completed = _sensor->completed(stamp);
+          record(topic, completed != 0 && now > completed ? now - completed : 0);
+        }));
+  }
+
+  void record(const std::string & topic, uint64_t latency)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    TopicStatistics & stats = _statistics[topic];
+    stats.messages++;
+    if (latency != 0) {
+      stats.latencies.push_back(latency);
+    }
+  }
+
+  rclcpp::Node::SharedPtr _node;
+  MeasuredSensor * _sensor;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> _subscriptions;
+  std::mutex _mutex;
+  std::map<std::string, TopicStatistics> _statistics;
+};
+
+/**
+ * @struct CpuSample
+ * @brief Jiffies of each core from /proc/stat and CPU time of the process
+ */
+struct CpuSample
+{
+  std::vector<uint64_t> busy;
+  std::vector<uint64_t> total;
+  double process{0.0};    // s
+};
+
+CpuSample sampleCpu()
+{
+  CpuSample sample;
+  std::ifstream stat("/proc/stat");
+  std::string line;
+  while (std::getline(stat, line)) {
+    // per core lines only, cpuN
+    if (line.compare(0, 3, "cpu") != 0 || line.size() < 4 || line[3] == ' ') {
+      continue;
+    }
+    std::istringstream fields(line.substr(line.find(' ')));
+    uint64_t value, idle = 0, total = 0;
+    for (int i = 0; fields >> value; i++) {
+      total += value;
+      if (i == 3 || i == 4) {   // idle and iowait
+        idle += value;
+      }
+    }
+    sample.busy.push_back(total - idle);
+    sample.total.push_back(total);
+  }
+
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    sample.process = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+      usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+  }
+  return sample;
+}
+
+Json::Value latencyJson(std::vector<uint64_t> latencies)
+{
+  Json::Value json;
+  json["samples"] = static_cast<Json::UInt64>(latencies.size());
+  if (latencies.empty()) {
+    return json;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+      const std::size_t index = static_cast<std::size_t>(p * (latencies.size() - 1) + 0.5);
+      return latencies[index] * 1e-6;
+    };
+  double sum = 0.0;
+  for (uint64_t latency : latencies) {
+    sum += latency;
+  }
+  json["min_ms"] = latencies.front() * 1e-6;
+  json["mean_ms"] = sum / latencies.size() * 1e-6;
+  json["p50_ms"] = percentile(0.5);
+  json["p90_ms"] = percentile(0.9);
+  json["p99_ms"] = percentile(0.99);
+  json["p999_ms"] = percentile(0.999);
+  json["max_ms"] = latencies.back() * 1e-6;
+  return json;
+}
+
+std::vector<rclcpp::Parameter> driverParameters(
+  const Options & options, const ros2_ouster::Metadata & mdata,
+  const std::string & mask, const std::string & qos)
+{
+  const std::vector<double> identity = {
+    1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+  return {
+    rclcpp::Parameter("lidar_ip", "127.0.0.1"),
+    rclcpp::Parameter("computer_ip", "127.0.0.1"),
+    rclcpp::Parameter("lidar_port", options.port),
+    rclcpp::Parameter("imu_port", options.port + 1),
+    rclcpp::Parameter("imu_to_sensor_transform", identity),
+    rclcpp::Parameter("lidar_to_sensor_transform", identity),
+    rclcpp::Parameter("lidar_vendor", mdata.lidar_vendor),
+    rclcpp::Parameter("num_lasers", mdata.num_lasers),
+    rclcpp::Parameter("ring_scan", mdata.ring_scan),
+    rclcpp::Parameter("distance_resolution", mdata.distance_resolution),
+    rclcpp::Parameter("x_offset_array", mdata.x_offset_array),
+    rclcpp::Parameter("y_offset_array", mdata.y_offset_array),
+    rclcpp::Parameter("ah_offset_array", mdata.ah_offset_array),
+    rclcpp::Parameter("av_offset_array", mdata.av_offset_array),
+    rclcpp::Parameter("laser_id_array", mdata.laser_id_array),
+    rclcpp::Parameter("os1_proc_mask", mask),
+    rclcpp::Parameter("use_system_default_qos", qos == "system_default"),
+    rclcpp::Parameter("processor_threads", options.threads),
+    rclcpp::Parameter("idle_without_subscribers", false),
+  };
+}
+
+/**
+ * @brief Run the driver with a processor mask and QoS setting
+ * @return the results of the run
+ */
+Json::Value run(
+  const Options & options, const ros2_ouster::Metadata & mdata,
+  std::shared_ptr<const ros2_ouster::RecordedPackets> recorded,
+  const std::string & mask, const std::string & qos)
+{
+  const bool is_3d = mdata.lidar_vendor == std::string("OLE_3D_V2");
+  ros2_ouster::SyntheticScene scene = ros2_ouster::SyntheticScene::room();
+
+  std::unique_ptr<ros2_ouster::SensorInterface> inner;
+  if (options.sensor == "synthetic") {
+    inner = std::make_unique<OS1::SyntheticSensor>(
+      mdata, scene, options.rotation_rate, options.rate);
+  } else {
+    inner = std::make_unique<OS1::OS1Sensor>();
+  }
+  auto sensor = std::make_unique<MeasuredSensor>(std::move(inner), is_3d);
+  MeasuredSensor * measured = sensor.get();
+
+  rclcpp::NodeOptions node_options;
+  node_options.parameter_overrides(driverParameters(options, mdata, mask, qos));
+  auto driver = std::make_shared<ros2_ouster::OusterDriver>(std::move(sensor), node_options);
+
+  const rclcpp::QoS subscriber_qos = qos == "system_default" ?
+    rclcpp::QoS(rclcpp::SystemDefaultsQoS()) : rclcpp::QoS(rclcpp::SensorDataQoS());
+  Subscriber subscriber(mask, subscriber_qos, measured);
+
+  // the driver and the subscriber each get a thread, as separate processes would
+  rclcpp::executors::SingleThreadedExecutor driver_executor;
+  rclcpp::executors::SingleThreadedExecutor subscriber_executor;
+  driver_executor.add_node(driver->get_node_base_interface());
+  subscriber_executor.add_node(subscriber.node());
+
+  driver->configure();
+  driver->activate();
+  std::thread driver_thread([&driver_executor]() {driver_executor.spin();});
+  std::thread subscriber_thread([&subscriber_executor]() {subscriber_executor.spin();});
+
+  std::unique_ptr<ros2_ouster::LoadGenerator> generator;
+  if (options.sensor != "synthetic") {
+    ros2_ouster::LoadGeneratorOptions load;
+    load.port = options.port;
+    load.rate = options.rate;
+    std::vector<std::unique_ptr<ros2_ouster::PacketSource>> sources;
+    if (recorded) {
+      sources.push_back(std::make_unique<ros2_ouster::RecordedPacketSource>(recorded));
+    } else {
+      sources.push_back(
+        std::make_unique<ros2_ouster::SyntheticPacketSource>(
+          mdata, scene, options.rotation_rate, 0));
+    }
+    generator = std::make_unique<ros2_ouster::LoadGenerator>(load, std::move(sources));
+    generator->start();
+  }
+
+  // measured after the warmup, once subscriptions are matched and the
+  // first frames went through
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.warmup));
+  subscriber.take();
+  const ros2_ouster::LoadStatistics sent_start =
+    generator ? generator->statistics() : ros2_ouster::LoadStatistics();
+  const uint64_t received_start = measured->packets();
+  const CpuSample cpu_start = sampleCpu();
+  const auto start = std::chrono::steady_clock::now();
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.duration));
+
+  const double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  const CpuSample cpu_end = sampleCpu();
+  const uint64_t received = measured->packets() - received_start;
+  const ros2_ouster::LoadStatistics sent_end =
+    generator ? generator->statistics() : ros2_ouster::LoadStatistics();
+  std::map<std::string, TopicStatistics> topics = subscriber.take();
+
+  if (generator) {
+    generator->stop();
+  }
+  driver_executor.cancel();
+  subscriber_executor.cancel();
+  driver_thread.join();
+  subscriber_thread.join();
+  driver->deactivate();
+  driver->cleanup();
+
+  Json::Value result;
+  result["mask"] = mask;
+  result["qos"] = qos;
+  result["seconds"] = elapsed;
+
+  Json::Value & packets = result["packets"];
+  packets["received"] = static_cast<Json::UInt64>(received);
+  packets["per_second"] = received / elapsed;
+  if (generator) {
+    const uint64_t sent = sent_end.sent - sent_start.sent;
+    packets["sent"] = static_cast<Json::UInt64>(sent);
+    packets["late"] = static_cast<Json::UInt64>(sent_end.late - sent_start.late);
+    packets["send_errors"] = static_cast<Json::UInt64>(sent_end.errors - sent_start.errors);
+    packets["loss"] = sent > received ? static_cast<double>(sent - received) / sent : 0.0;
+  }
+
+  result["expected_frames_per_second"] = options.rotation_rate * options.rate;
+  Json::Value & outputs = result["topics"];
+  for (auto & topic : topics) {
+    Json::Value & json = outputs[topic.first];
+    json["messages"] = static_cast<Json::UInt64>(topic.second.messages);
+    json["per_second"] = topic.second.messages / elapsed;
+    json["latency"] = latencyJson(std::move(topic.second.latencies));
+  }
+
+  Json::Value & cpu = result["cpu"];
+  cpu["process_percent"] = (cpu_end.process - cpu_start.process) / elapsed * 100.0;
+  Json::Value & cores = cpu["cores_percent"];
+  cores = Json::Value(Json::arrayValue);
+  for (std::size_t i = 0; i < cpu_end.busy.size() && i < cpu_start.busy.size(); i++) {
+    const uint64_t total = cpu_end.total[i] - cpu_start.total[i];
+    const uint64_t busy = cpu_end.busy[i] - cpu_start.busy[i];
+    cores.append(total > 0 ? 100.0 * busy / total : 0.0);
+  }
+  return result;
+}
+
+void usage(const char * name)
+{
+  std::printf(
+    "Usage: %s [options]\n"
+    "  --sensor TYPE        udp: OS1 sensor fed over loopback, synthetic: in process (udp)\n"
+    "  --vendor FORMAT      OLE_3D_V2 or OLE_2D_V2 (OLE_3D_V2)\n"
+    "  --recording PATH     packets sent over loopback, synthetic if not set\n"
+    "  --rotation-rate HZ   revolutions per second of the synthetic sensor (10)\n"
+    "  --rate FACTOR        speed relative to the sensor (1)\n"
+    "  --port PORT          lidar port, the next one is the IMU port (2368)\n"
+    "  --threads N          processor threads of the driver (1)\n"
+    "  --warmup S           seconds before measuring each run (2)\n"
+    "  --duration S         seconds measured of each run (10)\n"
+    "  --masks LIST         processor masks, comma separated (PCL,IMG,SCAN,PCL|IMG|SCAN)\n"
+    "  --qos LIST           sensor_data and/or system_default (sensor_data,system_default)\n"
+    "  --output PATH        JSON results (end_to_end_benchmark.json)\n",
+    name);
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  Options options;
+  const option long_options[] = {
+    {"sensor", required_argument, nullptr, 's'},
+    {"vendor", required_argument, nullptr, 'v'},
+    {"recording", required_argument, nullptr, 'f'},
+    {"rotation-rate", required_argument, nullptr, 'r'},
+    {"rate", required_argument, nullptr, 'R'},
+    {"port", required_argument, nullptr, 'p'},
+    {"threads", required_argument, nullptr, 't'},
+    {"warmup", required_argument, nullptr, 'w'},
+    {"duration", required_argument, nullptr, 'd'},
+    {"masks", required_argument, nullptr, 'm'},
+    {"qos", required_argument, nullptr, 'q'},
+    {"output", required_argument, nullptr, 'o'},
+    {"help", no_argument, nullptr, 'h'},
+    {nullptr, 0, nullptr, 0}
+  };
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "h", long_options, nullptr)) != -1) {
+    switch (opt) {
+      case 's': options.sensor = optarg; break;
+      case 'v': options.vendor = optarg; break;
+      case 'f': options.recording = optarg; break;
+      case 'r': options.rotation_rate = std::atof(optarg); break;
+      case 'R': options.rate = std::atof(optarg); break;
+      case 'p': options.port = std::atoi(optarg); break;
+      case 't': options.threads = std::atoi(optarg); break;
+      case 'w': options.warmup = std::atof(optarg); break;
+      case 'd': options.duration = std::atof(optarg); break;
+      case 'm': options.masks = splitList(optarg); break;
+      case 'q': options.qos = splitList(optarg); break;
+      case 'o': options.output = optarg; break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+
+  rclcpp::init(argc, argv);
+
+  // a recording brings its own metadata
+  std::shared_ptr<const ros2_ouster::RecordedPackets> recorded;
+  ros2_ouster::Metadata mdata = ros2_ouster::syntheticMetadata(options.vendor);
+  if (!options.recording.empty()) {
+    recorded = ros2_ouster::RecordedPackets::load(options.recording);
+    mdata = recorded->metadata;
+  }
+
+  Json::Value results;
+  Json::Value & config = results["config"];
+  config["sensor"] = options.sensor;
+  config["vendor"] = mdata.lidar_vendor;
+  config["recording"] = options.recording;
+  config["rotation_rate"] = options.rotation_rate;
+  config["rate"] = options.rate;
+  config["threads"] = options.threads;
+  config["warmup"] = options.warmup;
+  config["duration"] = options.duration;
+  config["cores"] = std::thread::hardware_concurrency();
+
+  Json::Value & runs = results["runs"];
+  runs = Json::Value(Json::arrayValue);
+  for (const std::string & qos : options.qos) {
+    for (const std::string & mask : options.masks) {
+      std::fprintf(stderr, "Running %s with %s QoS\n", mask.c_str(), qos.c_str());
+      runs.append(run(options, mdata, recorded, mask, qos));
+    }
+  }
+
+  rclcpp::shutdown();
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "  ";
+  std::ofstream output(options.output);
+  output << Json::writeString(builder, results) << std::endl;
+  if (!output) {
+    std::fprintf(stderr, "Failed to write %s\n", options.output.c_str());
+    return 1;
+  }
+  std::fprintf(stderr, "Results written to %s\n", options.output.c_str());
+  return 0;
+}
@@ -0,0 +1,116 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Scaling of ros2_ouster::ThreadPool for 1..N threads on a per-column
+// workload where one sector of the scan is much denser than the rest,
+// comparing fixed partitioning (one chunk per thread) against small
+// chunks balanced by work stealing.
+//
+// usage: thread_pool_benchmark [max_threads] [frames]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ros2_ouster/thread_pool.hpp"
+
+namespace
+{
+
+constexpr std::size_t kColumns = 2000;
+constexpr std::size_t kRows = 16;
+constexpr std::size_t kSteals = 16;
+
+// returns in a 45 degree sector cost ten times as much as elsewhere
+inline std::size_t columnCost(std::size_t column)
+{
+  return column < kColumns / 8 ? 10 : 1;
+}
+
+void processColumns(std::size_t begin, std::size_t end, std::vector<double> & out)
+{
+  for (std::size_t c = begin; c < end; c++) {
+    double acc = 0.0;
+    const std::size_t iterations = columnCost(c) * kRows * 8;
+    for (std::size_t i = 0; i < iterations; i++) {
+      acc += std::sin(c * 0.001 + i) * std::cos(i * 0.01);
+    }
+    out[c] = acc;
+  }
+}
+
+double runFrames(
+  ros2_ouster::ThreadPool & pool, std::size_t grain, std::size_t frames,
+  std::vector<double> & out)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t f = 0; f < frames; f++) {
+    pool.parallelFor(
+      0, kColumns, grain, [&out](std::size_t begin, std::size_t end) {
+        processColumns(begin, end, out);
+      });
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / frames;
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  std::size_t max_threads = std::thread::hardware_concurrency();
+  std::size_t frames = 50;
+  if (argc > 1) {
+    max_threads = std::strtoul(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    frames = std::strtoul(argv[2], nullptr, 10);
+  }
+  if (max_threads == 0) {
+    max_threads = 1;
+  }
+
+  std::vector<double> out(kColumns);
+  double fixed_baseline = 0.0;
+  double stealing_baseline = 0.0;
+
+  std::printf(
+    "%8s %16s %10s %16s %10s\n",
+    "threads", "fixed ms/frame", "speedup", "stealing ms/frame", "speedup");
+
+  for (std::size_t threads = 1; threads <= max_threads; threads++) {
+    ros2_ouster::ThreadPool pool(threads);
+
+    // warm up the workers and caches
+    runFrames(pool, kSteals, 2, out);
+
+    const std::size_t fixed_grain = (kColumns + threads - 1) / threads;
+    const double fixed = runFrames(pool, fixed_grain, frames, out);
+    const double stealing = runFrames(pool, kSteals, frames, out);
+
+    if (threads == 1) {
+      fixed_baseline = fixed;
+      stealing_baseline = stealing;
+    }
+
+    std::printf(
+      "%8zu %16.3f %10.2f %16.3f %10.2f\n", threads,
+      fixed, fixed_baseline / fixed, stealing, stealing_baseline / stealing);
+  }
+
+  return out[0] == 42.0 ? 1 : 0;
+}
@@ -36,6 +36,7 @@
 #include "arpa/inet.h"
 #include "sys/socket.h"
 #include "sys/types.h"
+#include "sys/uio.h"
 
 #include "jsoncpp/json/json.h"
 #include "ros2_ouster/OS1/OS1_packet.hpp"
@@ -117,6 +118,21 @@ inline int udp_data_socket(int port)
     return -1;
   }
 
+  // have the kernel stamp packets on arrival, so the time spent queued
+  // in the socket buffer counts towards the age of the data
+  int timestamp_on = 1;
+  if (setsockopt(sock_fd, SOL_SOCKET, SO_TIMESTAMPNS, &timestamp_on, sizeof(timestamp_on)) < 0) {
+    std::cerr << "udp setsockopt(): " << std::strerror(errno) << std::endl;
+  }
+
+  // have the kernel report the packets it dropped for lack of buffer space
+#ifdef SO_RXQ_OVFL
+  int overflow_on = 1;
+  if (setsockopt(sock_fd, SOL_SOCKET, SO_RXQ_OVFL, &overflow_on, sizeof(overflow_on)) < 0) {
+    std::cerr << "udp setsockopt(): " << std::strerror(errno) << std::endl;
+  }
+#endif
+
   return sock_fd;
 }
 
@@ -183,15 +199,61 @@ inline ros2_ouster::ClientState poll_client(const client & c, const int timeout_
  * @param buf buffer to which to write lidar data. Must be at least
  * lidar_packet_bytes + 1 bytes
  * @param len length of packet
+ * @param receive_time if not null, set to the time the kernel received
+ * the packet in ns since epoch, or the current time if not available
+ * @param drops if not null, set to the number of packets the kernel dropped
+ * on the socket since it was opened, wrapping around at 2^32
  * @return true if a lidar packet was successfully read
  */
-static bool recv_fixed(int fd, void * buf, size_t len)
+static bool recv_fixed(
+  int fd, void * buf, size_t len, uint64_t * receive_time = nullptr,
+  uint32_t * drops = nullptr)
 {
-  ssize_t n = recvfrom(fd, buf, len + 1, 0, NULL, NULL);
+  iovec iov;
+  iov.iov_base = buf;
+  iov.iov_len = len + 1;
+
+  char control[CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t))];
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t n = recvmsg(fd, &msg, 0);
+
+  // the drop count is only reported once the kernel dropped a packet
+  if (drops && n >= 0) {
+    *drops = 0;
+#ifdef SO_RXQ_OVFL
+    for (cmsghdr * cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+        memcpy(drops, CMSG_DATA(cmsg), sizeof(*drops));
+      }
+    }
+#endif
+  }
+
+  if (receive_time && n >= 0) {
+    *receive_time = 0;
+    for (cmsghdr * cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+        timespec ts;
+        memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+        *receive_time = static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+      }
+    }
+    if (*receive_time == 0) {
+      *receive_time = std::chrono::duration_cast<ns>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+  }
+
   if (n == (ssize_t)len) {
     return true;
   } else if (n == -1) {
-    std::cerr << "recvfrom: " << std::strerror(errno) << std::endl;
+    std::cerr << "recvmsg: " << std::strerror(errno) << std::endl;
   } else {
     std::cerr << "Unexpected udp packet length: " << n << std::endl;
   }
@@ -203,11 +265,15 @@ static bool recv_fixed(int fd, void * buf, size_t len)
  * @param cli client returned by init_client associated with the connection
  * @param buf buffer to which to write lidar data. Must be at least
  * lidar_packet_bytes + 1 bytes
+ * @param receive_time if not null, set to the time the packet was received
+ * @param drops if not null, set to the number of packets the kernel dropped
  * @return true if a lidar packet was successfully read
  */
-inline bool read_lidar_packet(const client & cli, uint8_t * buf, uint16_t packet_size)
+inline bool read_lidar_packet(
+  const client & cli, uint8_t * buf, uint16_t packet_size,
+  uint64_t * receive_time = nullptr, uint32_t * drops = nullptr)
 {
-  return recv_fixed(cli.lidar_fd, buf, packet_size);
+  return recv_fixed(cli.lidar_fd, buf, packet_size, receive_time, drops);
 }
 
 /**
@@ -215,11 +281,63 @@ inline bool read_lidar_packet(const client & cli, uint8_t * buf, uint16_t packet
  * @param cli client returned by init_client associated with the connection
  * @param buf buffer to which to write imu data. Must be at least
  * imu_packet_bytes + 1 bytes
+ * @param receive_time if not null, set to the time the packet was received
+ * @param drops if not null, set to the number of packets the kernel dropped
  * @return true if an imu packet was successfully read
  */
-inline bool read_imu_packet(const client & cli, uint8_t * buf, uint16_t packet_size)
+inline bool read_imu_packet(
+  const client & cli, uint8_t * buf, uint16_t packet_size,
+  uint64_t * receive_time = nullptr, uint32_t * drops = nullptr)
+{
+  return recv_fixed(cli.imu_fd, buf, packet_size, receive_time, drops);
+}
+
+/**
+ * Discard the packets queued on a socket without copying them. Will not block.
+ * @param fd Socket connection for sensor data
+ * @return number of packets discarded
+ */
+inline size_t drain_socket(int fd)
 {
-  return recv_fixed(cli.imu_fd, buf, packet_size);
+  size_t drained = 0;
+  char byte;
+  while (recv(fd, &byte, sizeof(byte), MSG_TRUNC | MSG_DONTWAIT) >= 0) {
+    drained++;
+  }
+  return drained;
+}
+
+/**
+ * Get the size of the kernel receive buffer of a socket.
+ * @param fd Socket connection for sensor data
+ * @return size in bytes as requested with set_receive_buffer, -1 on error
+ */
+inline int get_receive_buffer(int fd)
+{
+  int bytes = 0;
+  socklen_t len = sizeof(bytes);
+  if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bytes, &len) < 0) {
+    std::cerr << "udp getsockopt(): " << std::strerror(errno) << std::endl;
+    return -1;
+  }
+  // the kernel reports twice the requested size to account for overhead
+  return bytes / 2;
+}
+
+/**
+ * Set the size of the kernel receive buffer of a socket. Packets arriving
+ * while the buffer is full are dropped by the kernel.
+ * @param fd Socket connection for sensor data
+ * @param bytes requested size, the kernel clamps it to its minimum
+ * @return true on success
+ */
+inline bool set_receive_buffer(int fd, int bytes)
+{
+  if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof(bytes)) < 0) {
+    std::cerr << "udp setsockopt(): " << std::strerror(errno) << std::endl;
+    return false;
+  }
+  return true;
 }
 
 }  // namespace OS1
@@ -14,11 +14,10 @@
 #ifndef ROS2_OUSTER__OS1__OS1_SENSOR_HPP_
 #define ROS2_OUSTER__OS1__OS1_SENSOR_HPP_
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
-#include "ros2_ouster/OS1/processor_factories.hpp"
-
 #include "ros2_ouster/interfaces/data_processor_interface.hpp"
 #include "ros2_ouster/interfaces/sensor_interface.hpp"
 #include "ros2_ouster/OS1/OS1.hpp"
@@ -64,7 +63,40 @@ public:
    */
   uint8_t * readPacket(const ros2_ouster::ClientState & state) override;
 
+  /**
+   * @brief Time the packet last read was received by the kernel
+   * @return time in ns since epoch
+   */
+  uint64_t receiveTime() const override;
+
+  /**
+   * @brief Packets dropped by the kernel on the sockets, thread safe
+   * @return total since construction, but for drops while idle
+   */
+  uint64_t kernelDrops() const override;
+
+  /**
+   * @brief Shrink the socket buffers to their minimum while idle so the
+   * kernel drops packets, restore them and drop stale packets on resume
+   * @param idle true to enter idle mode
+   */
+  void setIdle(bool idle) override;
+
+  /**
+   * @brief Discard all packets queued on the sockets
+   * @return number of packets discarded
+   */
+  std::size_t drain() override;
+
 private:
+  /**
+   * @brief Account for the drop count reported by a socket
+   * @param reported drops reported with the packet just read
+   * @param last drops reported with the previous packet of the socket
+   * @param resync true to take the count reported as a new baseline
+   */
+  void countDrops(uint32_t reported, uint32_t & last, bool & resync);
+
   std::shared_ptr<client> _ouster_client;
   std::vector<uint8_t> _lidar_packet;
   std::vector<uint8_t> _imu_packet;
@@ -72,6 +104,15 @@ private:
   std::string _lidar_vendor;
   uint32_t _lidar_packet_size;
   uint32_t _imu_packet_size;
+  uint64_t _receive_time;
+  bool _idle;
+  int _lidar_receive_buffer;
+  int _imu_receive_buffer;
+  uint32_t _lidar_drops;      // last drop count reported by each socket
+  uint32_t _imu_drops;
+  bool _lidar_resync;         // the next count reported is a new baseline
+  bool _imu_resync;
+  std::atomic<uint64_t> _kernel_drops;
 
 };
 
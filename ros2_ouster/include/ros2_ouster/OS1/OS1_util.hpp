@@ -16,8 +16,13 @@
 
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <iostream>
 #include <iterator>
+#include <string>
 #include <vector>
 
 #include "ros2_ouster/OS1/OS1_packet.hpp"
@@ -202,7 +207,7 @@ std::function<void(const uint8_t *, iterator_type it, uint64_t)> batch_to_iter3(
            // 3.scan packet
            // 1 x 150
            for (int icol = 0; icol < 150; icol++) {
-        	 memcpy(&azimuth, packet_buf + 40 + 8 * icol, sizeof(uint32_t));
+        	 memcpy(&azimuth, packet_buf + 40 + 8 * icol, sizeof(uint16_t));
              if(azimuth_last == -1){
                azimuth_last = azimuth;
              }
@@ -0,0 +1,140 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__OS1__PCAP_SENSOR_HPP_
+#define ROS2_OUSTER__OS1__PCAP_SENSOR_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ros2_ouster/interfaces/sensor_interface.hpp"
+
+namespace OS1
+{
+
+/**
+ * @class OS1::PcapSensor
+ * @brief A sensor interface implementation replaying the UDP packets of a
+ * sensor captured in a pcap file, in place of a live sensor. The file is
+ * memory mapped and packets are handed out straight from the mapping.
+ *
+ * Packets are replayed at the pace they were captured, scaled by a rate,
+ * or as fast as they are read. Lidar and IMU packets are told apart by
+ * their destination port, as configured for a live sensor. Replay stops
+ * at the end of the file, get() then only returns TIMEOUT.
+ */
+class PcapSensor : public ros2_ouster::SensorInterface
+{
+public:
+  /**
+   * @brief A constructor for OS1::PcapSensor
+   * @param path path of the pcap file
+   * @param rate replay speed relative to the capture, e.g. 2.0 for twice
+   * as fast, 0 to replay as fast as possible
+   */
+  PcapSensor(const std::string & path, double rate = 1.0);
+
+  ~PcapSensor() override;
+
+  /**
+   * @brief Restart the replay from the start of the file
+   * @param configuration file to use
+   */
+  void reset(const ros2_ouster::Configuration & config) override;
+
+  /**
+   * @brief Map the pcap file and check its format
+   * @param configuration file to use
+   */
+  void configure(const ros2_ouster::Configuration & config) override;
+
+  /**
+   * @brief Wait until the next packet of the sensor is due
+   * @return the state enum value
+   */
+  ros2_ouster::ClientState get() override;
+
+  /**
+   * @brief reading the packet corresponding to the sensor state
+   * @param state of the sensor
+   * @return the packet of data, valid until the file is unmapped
+   */
+  uint8_t * readPacket(const ros2_ouster::ClientState & state) override;
+
+  /**
+   * @brief Skip the packets due while idle on resume
+   * @param idle true to enter idle mode
+   */
+  void setIdle(bool idle) override;
+
+  /**
+   * @brief Skip the packets already due, none when replaying as fast
+   * as possible
+   * @return number of packets skipped
+   */
+  std::size_t drain() override;
+
+  /**
+   * @brief Whether every packet of the file was replayed
+   */
+  bool finished() const
+  {
+    return _finished;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Find the next packet of the sensor from the current offset
+   * @return true if a packet was found, false at the end of the file
+   */
+  bool findNext();
+
+  /**
+   * @brief Time the packet found last is due for replay
+   */
+  Clock::time_point due() const;
+
+  void unmap();
+
+  std::string _path;
+  double _rate;
+
+  uint8_t * _map;
+  std::size_t _map_size;
+  bool _swapped;          // byte order of the file differs from the host's
+  bool _nanoseconds;      // timestamps in ns rather than us
+  uint32_t _link_type;
+
+  int _lidar_port;
+  int _imu_port;
+  std::size_t _lidar_packet_size;
+  std::size_t _imu_packet_size;
+
+  std::size_t _offset;    // offset of the record following the next packet
+  uint8_t * _next;        // payload of the next packet, null if not found
+  ros2_ouster::ClientState _next_state;
+  uint64_t _next_ts;      // capture time of the next packet in ns
+  uint64_t _first_ts;     // capture time of the first packet in ns
+  Clock::time_point _start;
+  bool _started;
+  bool _finished;
+  bool _idle;
+};
+
+}  // namespace OS1
+
+#endif  // ROS2_OUSTER__OS1__PCAP_SENSOR_HPP_
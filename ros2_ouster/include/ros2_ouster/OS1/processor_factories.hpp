@@ -22,8 +22,12 @@
 #include "rclcpp/qos.hpp"
 #include "ros2_ouster/conversions.hpp"
 #include "ros2_ouster/string_utils.hpp"
+#include "ros2_ouster/OS1/processors/decoder_processor.hpp"
+#include "ros2_ouster/OS1/processors/frame_ring_processor.hpp"
+#include "ros2_ouster/OS1/processors/frame_writer_processor.hpp"
 #include "ros2_ouster/OS1/processors/image_processor.hpp"
 #include "ros2_ouster/OS1/processors/imu_processor.hpp"
+#include "ros2_ouster/OS1/processors/packet_processor.hpp"
 #include "ros2_ouster/OS1/processors/pointcloud_processor.hpp"
 #include "ros2_ouster/OS1/processors/scan_processor.hpp"
 
@@ -34,6 +38,9 @@ constexpr std::uint32_t OS1_PROC_IMG = (1 << 0);
 constexpr std::uint32_t OS1_PROC_PCL = (1 << 1);
 constexpr std::uint32_t OS1_PROC_IMU = (1 << 2);
 constexpr std::uint32_t OS1_PROC_SCAN = (1 << 3);
+constexpr std::uint32_t OS1_PROC_RAW = (1 << 4);
+constexpr std::uint32_t OS1_PROC_FILE = (1 << 5);
+constexpr std::uint32_t OS1_PROC_SHM = (1 << 6);
 
 constexpr std::uint32_t OS1_DEFAULT_PROC_MASK =
   OS1_PROC_IMG | OS1_PROC_PCL | OS1_PROC_IMU | OS1_PROC_SCAN;
@@ -48,6 +55,9 @@ constexpr std::uint32_t OS1_DEFAULT_PROC_MASK =
  * IMG|PCL|IMU|SCAN
  * IMG|PCL
  * PCL
+ * RAW
+ * PCL|FILE
+ * SHM
  *
  * @param[in] mask_str The string to convert into a mask
  * @return The mask obtained from the parsed input string.
@@ -67,12 +77,29 @@ toProcMask(const std::string & mask_str)
       mask |= ros2_ouster::OS1_PROC_IMU;
     } else if (token == "SCAN") {
       mask |= ros2_ouster::OS1_PROC_SCAN;
+    } else if (token == "RAW") {
+      mask |= ros2_ouster::OS1_PROC_RAW;
+    } else if (token == "FILE") {
+      mask |= ros2_ouster::OS1_PROC_FILE;
+    } else if (token == "SHM") {
+      mask |= ros2_ouster::OS1_PROC_SHM;
     }
   }
 
   return mask;
 }
 
+/**
+ * @brief Factory method to get a pointer to a processor
+ * to decode lidar packets into frames for the other processors
+ * @return Raw pointer to a data processor interface to use
+ */
+inline ros2_ouster::DataProcessorInterface * createDecoderProcessor(
+  const ros2_ouster::Metadata & mdata)
+{
+  return new OS1::DecoderProcessor(mdata);
+}
+
 /**
  * @brief Factory method to get a pointer to a processor
  * to create the image (range, intensity, noise) interfaces
@@ -129,16 +156,67 @@ inline ros2_ouster::DataProcessorInterface * createScanProcessor(
   return new OS1::ScanProcessor(node, mdata, frame, qos);
 }
 
+/**
+ * @brief Factory method to get a pointer to a processor
+ * to publish the raw lidar packets in batches
+ * @return Raw pointer to a data processor interface to use
+ */
+inline ros2_ouster::DataProcessorInterface * createPacketProcessor(
+  const rclcpp_lifecycle::LifecycleNode::SharedPtr node,
+  const ros2_ouster::Metadata & mdata,
+  const std::string & frame,
+  const rclcpp::QoS & qos,
+  std::size_t packets_per_message)
+{
+  return new OS1::PacketProcessor(node, mdata, frame, qos, packets_per_message);
+}
+
+/**
+ * @brief Factory method to get a pointer to a processor
+ * to write frames to PCD or PLY files
+ * @return Raw pointer to a data processor interface to use
+ */
+inline ros2_ouster::DataProcessorInterface * createFrameWriterProcessor(
+  const rclcpp_lifecycle::LifecycleNode::SharedPtr node,
+  const ros2_ouster::FrameWriterOptions & options)
+{
+  return new OS1::FrameWriterProcessor(node, options);
+}
+
+/**
+ * @brief Factory method to get a pointer to a processor
+ * to publish frames in a shared memory ring
+ * @return Raw pointer to a data processor interface to use
+ */
+inline ros2_ouster::DataProcessorInterface * createFrameRingProcessor(
+  const rclcpp_lifecycle::LifecycleNode::SharedPtr node,
+  const ros2_ouster::FrameRingOptions & options)
+{
+  return new OS1::FrameRingProcessor(node, options);
+}
+
 inline std::multimap<ClientState, DataProcessorInterface *> createProcessors(
   const rclcpp_lifecycle::LifecycleNode::SharedPtr node,
   const ros2_ouster::Metadata & mdata,
   const std::string & imu_frame,
   const std::string & laser_frame,
   const rclcpp::QoS & qos,
-  std::uint32_t mask = ros2_ouster::OS1_DEFAULT_PROC_MASK)
+  std::uint32_t mask = ros2_ouster::OS1_DEFAULT_PROC_MASK,
+  std::size_t packets_per_message = 0,
+  const ros2_ouster::FrameWriterOptions & frame_files = ros2_ouster::FrameWriterOptions(),
+  const ros2_ouster::FrameRingOptions & frame_ring = ros2_ouster::FrameRingOptions())
 {
   std::multimap<ClientState, DataProcessorInterface *> data_processors;
 
+  const std::uint32_t frame_consumers =
+    ros2_ouster::OS1_PROC_IMG | ros2_ouster::OS1_PROC_PCL | ros2_ouster::OS1_PROC_SCAN |
+    ros2_ouster::OS1_PROC_FILE | ros2_ouster::OS1_PROC_SHM;
+  if ((mask & frame_consumers) != 0) {
+    data_processors.insert(
+      std::pair<ClientState, DataProcessorInterface *>(
+        ClientState::LIDAR_DATA, createDecoderProcessor(mdata)));
+  }
+
   if ((mask & ros2_ouster::OS1_PROC_IMG) == ros2_ouster::OS1_PROC_IMG) {
     data_processors.insert(
       std::pair<ClientState, DataProcessorInterface *>(
@@ -167,6 +245,27 @@ inline std::multimap<ClientState, DataProcessorInterface *> createProcessors(
           node, mdata, laser_frame, qos)));
   }
 
+  if ((mask & ros2_ouster::OS1_PROC_RAW) == ros2_ouster::OS1_PROC_RAW) {
+    data_processors.insert(
+      std::pair<ClientState, DataProcessorInterface *>(
+        ClientState::LIDAR_DATA, createPacketProcessor(
+          node, mdata, laser_frame, qos, packets_per_message)));
+  }
+
+  if ((mask & ros2_ouster::OS1_PROC_FILE) == ros2_ouster::OS1_PROC_FILE) {
+    data_processors.insert(
+      std::pair<ClientState, DataProcessorInterface *>(
+        ClientState::LIDAR_DATA, createFrameWriterProcessor(
+          node, frame_files)));
+  }
+
+  if ((mask & ros2_ouster::OS1_PROC_SHM) == ros2_ouster::OS1_PROC_SHM) {
+    data_processors.insert(
+      std::pair<ClientState, DataProcessorInterface *>(
+        ClientState::LIDAR_DATA, createFrameRingProcessor(
+          node, frame_ring)));
+  }
+
   return data_processors;
 }
 
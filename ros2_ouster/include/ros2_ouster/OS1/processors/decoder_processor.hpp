@@ -0,0 +1,167 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__OS1__PROCESSORS__DECODER_PROCESSOR_HPP_
+#define ROS2_OUSTER__OS1__PROCESSORS__DECODER_PROCESSOR_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "ros2_ouster/core/frame_decoder.hpp"
+#include "ros2_ouster/core/packet_loss_estimator.hpp"
+#include "ros2_ouster/interfaces/data_processor_interface.hpp"
+
+namespace OS1
+{
+/**
+ * @class OS1::DecoderProcessor
+ * @brief A data processor interface implementation decoding lidar
+ * packets into frames once for all processors consuming decoded frames.
+ */
+class DecoderProcessor : public ros2_ouster::DataProcessorInterface
+{
+public:
+  /**
+   * @brief A constructor for OS1::DecoderProcessor
+   * @param mdata metadata about the sensor
+   */
+  explicit DecoderProcessor(const ros2_ouster::Metadata & mdata)
+  : DataProcessorInterface(), _decoder(mdata),
+    _loss(mdata.lidar_vendor == std::string("OLE_3D_V2")),
+    _frame_missing(0.0)
+  {
+  }
+
+  /**
+   * @brief Process method to decode packets, providing the frame
+   * to downstream processors when the packet completes it
+   * @param data the packet data
+   */
+  bool process(uint8_t * data, uint64_t /*override_ts*/) override
+  {
+    const ros2_ouster::Packet * packet =
+      _products->get<ros2_ouster::Packet>(ros2_ouster::RAW_PACKET);
+    const uint64_t receive_time = packet ? packet->receive_time : 0;
+    if (_load) {
+      _decoder.setColumnDecimation(_load->columnDecimation());
+    }
+
+    const auto start = startStage();
+    const bool completed = _decoder.decode(data, receive_time);
+    recordStage(ros2_ouster::PipelineStage::DECODE, start);
+    countPacket(data, completed);
+
+    if (completed) {
+      const ros2_ouster::LidarFrame & frame = _decoder.lastFrame();
+      _products->set(ros2_ouster::DECODED_FRAME, &frame);
+      if (_load) {
+        _load->addFrame();
+      }
+
+      // from the kernel receiving the packet completing the frame
+      if (_statistics && frame.receive_time != 0) {
+        const uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch()).count();
+        _statistics->stage(ros2_ouster::PipelineStage::ASSEMBLY).record(
+          now > frame.receive_time ? now - frame.receive_time : 0);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Name of the processor in statistics
+   */
+  const char * name() const override
+  {
+    return "decoder";
+  }
+
+
+  /**
+   * @brief Activating processor from lifecycle state transitions
+   */
+  void onActivate() override
+  {
+  }
+
+  /**
+   * @brief Deactivating processor from lifecycle state transitions,
+   * the partially assembled frame is stale once reactivated
+   */
+  void onDeactivate() override
+  {
+    reset();
+  }
+
+  /**
+   * @brief Decoded frames are only consumed by other processors
+   */
+  bool hasSubscribers() const override
+  {
+    return false;
+  }
+
+  /**
+   * @brief Drop the partially assembled frame
+   */
+  void reset() override
+  {
+    _decoder.reset();
+    _loss.restart();
+    _frame_missing = 0.0;
+  }
+
+  /**
+   * @brief Produces the frames decoded from the packets
+   */
+  std::uint32_t produces() const override
+  {
+    return ros2_ouster::DECODED_FRAME;
+  }
+
+private:
+  /**
+   * @brief Count a packet decoded, and the packets of a frame and those
+   * estimated missing from it once it completes
+   * @param data the packet data
+   * @param completed whether the packet completed a frame
+   */
+  void countPacket(const uint8_t * data, bool completed)
+  {
+    if (!_statistics) {
+      return;
+    }
+
+    ros2_ouster::PipelineCounters & counters = _statistics->counters();
+    counters.add(ros2_ouster::PipelineCounter::DECODED_PACKETS);
+    _frame_missing += _loss.update(data);
+    if (completed) {
+      counters.add(ros2_ouster::PipelineCounter::FRAMES);
+      counters.add(ros2_ouster::PipelineCounter::FRAME_PACKETS, _decoder.lastFrame().packets);
+      counters.add(
+        ros2_ouster::PipelineCounter::MISSING_PACKETS,
+        static_cast<uint64_t>(_frame_missing + 0.5));
+      _frame_missing = 0.0;
+    }
+  }
+
+  ros2_ouster::FrameDecoder _decoder;
+  ros2_ouster::PacketLossEstimator _loss;
+  double _frame_missing;      // packets estimated missing from the frame being assembled
+};
+
+}  // namespace OS1
+
+#endif  // ROS2_OUSTER__OS1__PROCESSORS__DECODER_PROCESSOR_HPP_
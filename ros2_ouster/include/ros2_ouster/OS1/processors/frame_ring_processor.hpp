@@ -0,0 +1,136 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__OS1__PROCESSORS__FRAME_RING_PROCESSOR_HPP_
+#define ROS2_OUSTER__OS1__PROCESSORS__FRAME_RING_PROCESSOR_HPP_
+
+#include <memory>
+#include <string>
+
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+
+#include "ros2_ouster/core/frame_ring_writer.hpp"
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/exception.hpp"
+#include "ros2_ouster/interfaces/data_processor_interface.hpp"
+
+namespace OS1
+{
+/**
+ * @class OS1::FrameRingProcessor
+ * @brief A data processor interface implementation of a processor
+ * for publishing the decoded frames in a shared memory ring, see
+ * ros2_ouster::FrameRingWriter, for processes on the host not using ROS.
+ * The ring is created with the first frame, sized after its buffer.
+ */
+class FrameRingProcessor : public ros2_ouster::DataProcessorInterface
+{
+public:
+  /**
+   * @brief A constructor for OS1::FrameRingProcessor
+   * @param node Node for logging
+   * @param options name and size of the ring
+   */
+  FrameRingProcessor(
+    const rclcpp_lifecycle::LifecycleNode::SharedPtr node,
+    const ros2_ouster::FrameRingOptions & options)
+  : DataProcessorInterface(), _node(node),
+    _options(options),
+    _active(false),
+    _failed(false)
+  {
+  }
+
+  /**
+   * @brief Process method to write the frame to the ring
+   * @param data the packet data
+   */
+  bool process(uint8_t * /*data*/, uint64_t /*override_ts*/) override
+  {
+    if (!_active || _failed) {
+      return true;
+    }
+
+    const ros2_ouster::LidarFrame * frame =
+      _products->get<ros2_ouster::LidarFrame>(ros2_ouster::DECODED_FRAME);
+    if (!_writer) {
+      try {
+        _writer = std::make_unique<ros2_ouster::FrameRingWriter>(
+          _options.name, _options.slots, frame->points.size());
+      } catch (const ros2_ouster::OusterDriverException & e) {
+        RCLCPP_ERROR(
+          _node->get_logger(), "Frame ring disabled: %s", e.what());
+        _failed = true;
+        return true;
+      }
+      RCLCPP_INFO(
+        _node->get_logger(), "Publishing frames in shared memory %s.", _options.name.c_str());
+    }
+
+    _writer->write(*frame);
+    return true;
+  }
+
+  /**
+   * @brief Name of the processor in statistics
+   */
+  const char * name() const override
+  {
+    return "frame_ring";
+  }
+
+  /**
+   * @brief Consumes the frames decoded from the packets
+   */
+  std::uint32_t consumes() const override
+  {
+    return ros2_ouster::DECODED_FRAME;
+  }
+
+  /**
+   * @brief Whether readers are attached to the ring. Until the ring
+   * exists there is nothing readers could attach to, so it counts as
+   * subscribed to be created.
+   */
+  bool hasSubscribers() const override
+  {
+    return !_failed && (!_writer || _writer->readers() > 0);
+  }
+
+  /**
+   * @brief Activating processor from lifecycle state transitions
+   */
+  void onActivate() override
+  {
+    _active = true;
+  }
+
+  /**
+   * @brief Deactivating processor from lifecycle state transitions
+   */
+  void onDeactivate() override
+  {
+    _active = false;
+  }
+
+private:
+  rclcpp_lifecycle::LifecycleNode::SharedPtr _node;
+  std::unique_ptr<ros2_ouster::FrameRingWriter> _writer;
+  ros2_ouster::FrameRingOptions _options;
+  bool _active;
+  bool _failed;
+};
+
+}  // namespace OS1
+
+#endif  // ROS2_OUSTER__OS1__PROCESSORS__FRAME_RING_PROCESSOR_HPP_
@@ -0,0 +1,131 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__OS1__PROCESSORS__FRAME_WRITER_PROCESSOR_HPP_
+#define ROS2_OUSTER__OS1__PROCESSORS__FRAME_WRITER_PROCESSOR_HPP_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+
+#include "ros2_ouster/core/frame_writer.hpp"
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/interfaces/data_processor_interface.hpp"
+
+namespace OS1
+{
+/**
+ * @class OS1::FrameWriterProcessor
+ * @brief A data processor interface implementation of a processor
+ * for writing every Nth frame to a PCD or PLY file, for labeling tools.
+ * Files are written in the background, see ros2_ouster::FrameWriter,
+ * frames are skipped rather than delaying the publishers if the disk
+ * cannot keep up.
+ */
+class FrameWriterProcessor : public ros2_ouster::DataProcessorInterface
+{
+public:
+  /**
+   * @brief A constructor for OS1::FrameWriterProcessor
+   * @param node Node for logging
+   * @param options where and how to write the frames
+   */
+  FrameWriterProcessor(
+    const rclcpp_lifecycle::LifecycleNode::SharedPtr node,
+    const ros2_ouster::FrameWriterOptions & options)
+  : DataProcessorInterface(), _node(node),
+    _every(std::max<std::size_t>(options.every, 1)),
+    _active(false),
+    _reported_skips(0),
+    _reported_failures(0)
+  {
+    _writer = std::make_unique<ros2_ouster::FrameWriter>(
+      options.directory, options.format, options.direct_io);
+  }
+
+  /**
+   * @brief Process method to write the frame
+   * @param data the packet data
+   */
+  bool process(uint8_t * /*data*/, uint64_t /*override_ts*/) override
+  {
+    if (!_active) {
+      return true;
+    }
+
+    const ros2_ouster::LidarFrame * frame =
+      _products->get<ros2_ouster::LidarFrame>(ros2_ouster::DECODED_FRAME);
+    if (frame->id % _every != 0) {
+      return true;
+    }
+    _writer->write(*frame);
+
+    const uint64_t skips = _writer->skipped();
+    const uint64_t failures = _writer->failed();
+    if (skips != _reported_skips || failures != _reported_failures) {
+      RCLCPP_WARN_THROTTLE(
+        _node->get_logger(), *_node->get_clock(), 5000,
+        "Frame files: %lu skipped while the disk was busy, %lu failed to be written.",
+        static_cast<unsigned long>(skips), static_cast<unsigned long>(failures));
+      _reported_skips = skips;
+      _reported_failures = failures;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Name of the processor in statistics
+   */
+  const char * name() const override
+  {
+    return "frame_writer";
+  }
+
+  /**
+   * @brief Consumes the frames decoded from the packets
+   */
+  std::uint32_t consumes() const override
+  {
+    return ros2_ouster::DECODED_FRAME;
+  }
+
+  /**
+   * @brief Activating processor from lifecycle state transitions
+   */
+  void onActivate() override
+  {
+    _active = true;
+  }
+
+  /**
+   * @brief Deactivating processor from lifecycle state transitions
+   */
+  void onDeactivate() override
+  {
+    _active = false;
+  }
+
+private:
+  rclcpp_lifecycle::LifecycleNode::SharedPtr _node;
+  std::unique_ptr<ros2_ouster::FrameWriter> _writer;
+  std::size_t _every;
+  bool _active;
+  uint64_t _reported_skips;
+  uint64_t _reported_failures;
+};
+
+}  // namespace OS1
+
+#endif  // ROS2_OUSTER__OS1__PROCESSORS__FRAME_WRITER_PROCESSOR_HPP_
@@ -19,22 +19,70 @@
 #include <string>
 #include <utility>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include <functional>
 
 #include "rclcpp/qos.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
 
 #include "ros2_ouster/conversions.hpp"
+#include "ros2_ouster/core/tracing.hpp"
 
 #include "sensor_msgs/msg/image.hpp"
 
+#include "ros2_ouster/core/lidar_frame.hpp"
 #include "ros2_ouster/interfaces/data_processor_interface.hpp"
-#include "ros2_ouster/OS1/OS1_util.hpp"
+#include "ros2_ouster/triple_buffer.hpp"
 
 //#include "ros2_ouster/image_os.hpp"
 
 namespace OS1
 {
+/**
+ * @brief Fill rows of the range and intensity images of a frame, one
+ * byte per pixel, rows being rings
+ * @param points points of the frame, column major
+ * @param frame_height number of rings of the frame
+ * @param width number of columns of the images
+ * @param px_offset column shift of each ring
+ * @param begin first row to fill
+ * @param end row past the last one to fill
+ * @param range range image data, width bytes per row
+ * @param intensity intensity image data, width bytes per row
+ */
+inline void fillImageRows(
+  const ros2_ouster::LidarPoint * points,
+  uint32_t frame_height,
+  uint32_t width,
+  const std::vector<int> & px_offset,
+  std::size_t begin,
+  std::size_t end,
+  uint8_t * range,
+  uint8_t * intensity)
+{
+  for (uint u = begin; u != end; u++) {
+    for (uint v = 0; v != width; v++) {
+      const size_t vv = (v + px_offset[u]) % width;
+      const size_t index = vv * frame_height + u;
+      const ros2_ouster::LidarPoint & px = points[index];
+
+      const uint & idx = u * width + v;
+      if (px.range == 0) {
+        range[idx] = 0;
+      } else {
+        range[idx] = 255 - std::min(std::round((float)(px.range * 1e-3)), 255.0f);
+      }
+
+      intensity[idx] = std::min(px.intensity, 255.0f);
+    }
+  }
+}
+
 /**
  * @class OS1::ImageProcessor
  * @brief A data processor interface implementation of a processor
@@ -44,9 +92,6 @@ namespace OS1
 class ImageProcessor : public ros2_ouster::DataProcessorInterface
 {
 public:
-  using OSImage = std::vector<picture_os::ImageOS>;
-  using OSImageIt = OSImage::iterator;
-
   /**
    * @brief A constructor for OS1::ImageProcessor
    * @param node Node for creating interfaces
@@ -64,15 +109,8 @@ public:
 	 _px_offset.reserve(16);
 	 _px_offset.assign(&px_init[0],&px_init[16]);
 
-	 _sin_lut = OS1::make_sin_lut();
-	 _cos_lut = OS1::make_cos_lut();
-	 _id_frame = 0;
-	 _id_col = 0;
-	 _azimuth_last = -1;
-	 _ts_last = -1;
 	 _height = mdata.num_lasers;
 	 _width = 2000;
-	 _realwidth = 2000;
 
     _range_image_pub = _node->create_publisher<sensor_msgs::msg::Image>(
       "range_image", qos);
@@ -94,117 +132,10 @@ public:
     _intensity_image.data.resize(_width * _height);
 
 
-    _information_image.resize(_width * _height);
-
-    if(mdata.lidar_vendor == std::string("OLE_3D_V2")){
-      _batch_and_publish =
-      OS1::batch_to_iter2<OSImageIt>(
-       _sin_lut,
-       _cos_lut,
-       mdata.x_offset_array,
-       mdata.y_offset_array,
-       mdata.ah_offset_array,
-       mdata.av_offset_array,
-      _id_frame,
-      _id_col,
-      _azimuth_last,
-      _ts_last,
-	  _realwidth,
-      {},
-	  &picture_os::ImageOS::make,
-      [&](uint64_t scan_ts,uint32_t width) mutable
-      {
-        rclcpp::Time t(scan_ts);
-        _range_image.header.stamp = t;
-        _intensity_image.header.stamp = t;
-
-        OSImageIt it;
-        for (uint u = 0; u != _height; u++) {
-          for (uint v = 0; v != width; v++) {
-            const size_t vv = (v + _px_offset[u]) % width;
-            const size_t index = vv * _height + u;
-            picture_os::ImageOS & px = _information_image[index];
-
-            const uint & idx = u * width + v;
-            if (px.range == 0) {
-              _range_image.data[idx] = 0;
-            } else {
-              _range_image.data[idx] = 255 - std::min(std::round((float)(px.range * 1e-3)), 255.0f);
-            }
-
-            _intensity_image.data[idx] = std::min(px.intensity, 255.0f);
-          }
-        }
-
-        if (_range_image_pub->get_subscription_count() > 0 &&
-        _range_image_pub->is_activated())
-        {
-          _range_image_pub->publish(_range_image);
-        }
-
-        if (_intensity_image_pub->get_subscription_count() > 0 &&
-        _intensity_image_pub->is_activated())
-        {
-          _intensity_image_pub->publish(_intensity_image);
-        }
-
-      }); 
-    }
-    else{
-      _batch_and_publish =
-      OS1::batch_to_iter3<OSImageIt>(
-       _sin_lut,
-       _cos_lut,
-       mdata.x_offset_array,
-       mdata.y_offset_array,
-       mdata.ah_offset_array,
-       mdata.av_offset_array,
-      _id_frame,
-      _id_col,
-      _azimuth_last,
-      _ts_last,
-	  _realwidth,
-      {},
-	  &picture_os::ImageOS::make,
-      [&](uint64_t scan_ts,uint32_t width) mutable
-      {
-        rclcpp::Time t(scan_ts);
-        _range_image.header.stamp = t;
-        _intensity_image.header.stamp = t;
-
-        OSImageIt it;
-        for (uint u = 0; u != _height; u++) {
-          for (uint v = 0; v != width; v++) {
-            const size_t vv = (v + _px_offset[u]) % width;
-            const size_t index = vv * _height + u;
-            picture_os::ImageOS & px = _information_image[index];
-
-            const uint & idx = u * width + v;
-            if (px.range == 0) {
-              _range_image.data[idx] = 0;
-            } else {
-              _range_image.data[idx] = 255 - std::min(std::round((float)(px.range * 1e-3)), 255.0f);
-            }
-
-            _intensity_image.data[idx] = std::min(px.intensity, 255.0f);
-          }
-        }
-
-        if (_range_image_pub->get_subscription_count() > 0 &&
-        _range_image_pub->is_activated())
-        {
-          _range_image_pub->publish(_range_image);
-        }
-
-        if (_intensity_image_pub->get_subscription_count() > 0 &&
-        _intensity_image_pub->is_activated())
-        {
-          _intensity_image_pub->publish(_intensity_image);
-        }
-
-      });  
-    }
-    
+    ImageFrame empty_frame;
+    empty_frame.points.resize(_width * _height);
+    _frames = std::make_unique<ros2_ouster::TripleBuffer<ImageFrame>>(empty_frame);
+    _rendering = false;
   }
 
   /**
@@ -212,6 +143,7 @@ public:
    */
   ~ImageProcessor()
   {
+    stopRendering();
     _intensity_image_pub.reset();
     _range_image_pub.reset();
   }
@@ -220,13 +152,66 @@ public:
    * @brief Process method to create images
    * @param data the packet data
    */
-  bool process(uint8_t * data, uint64_t override_ts) override
+  bool process(uint8_t * /*data*/, uint64_t /*override_ts*/) override
   {
-    OSImageIt it = _information_image.begin();
-    _batch_and_publish(data, it, override_ts);
+    const ros2_ouster::LidarFrame * frame =
+      _products->get<ros2_ouster::LidarFrame>(ros2_ouster::DECODED_FRAME);
+
+    // the render thread would discard the frame, so it is not copied
+    if (!hasSubscribers() || !_range_image_pub->is_activated()) {
+      return true;
+    }
+
+    // images are the first output disabled when over the CPU budget
+    if (_load && (!_load->optionalOutputs() || !_load->publishFrame(frame->id))) {
+      return true;
+    }
+
+    // hands the completed frame over to the render thread, never blocks
+    ImageFrame & image_frame = _frames->writeBuffer();
+    const std::size_t size = std::min(frame->size(), image_frame.points.size());
+    std::copy(frame->points.begin(), frame->points.begin() + size, image_frame.points.begin());
+    image_frame.stamp = frame->timestamp;
+    image_frame.id = frame->id;
+    image_frame.packets = frame->packets;
+    image_frame.receive_time = frame->receive_time;
+    image_frame.width = static_cast<uint32_t>(size / frame->height);
+    image_frame.height = frame->height;
+    {
+      // pairs with the predicate check of the render thread, so the
+      // notification cannot land before it blocks
+      std::lock_guard<std::mutex> lock(_render_mutex);
+      _frames->publish();
+    }
+    _render_cv.notify_one();
     return true;
   }
 
+  /**
+   * @brief Name of the processor in statistics
+   */
+  const char * name() const override
+  {
+    return "image";
+  }
+
+  /**
+   * @brief Consumes the frames decoded from the packets
+   */
+  std::uint32_t consumes() const override
+  {
+    return ros2_ouster::DECODED_FRAME;
+  }
+
+  /**
+   * @brief Whether any of the images is subscribed to
+   */
+  bool hasSubscribers() const override
+  {
+    return _range_image_pub->get_subscription_count() > 0 ||
+           _intensity_image_pub->get_subscription_count() > 0;
+  }
+
   /**
    * @brief Activating processor from lifecycle state transitions
    */
@@ -234,6 +219,7 @@ public:
   {
     _intensity_image_pub->on_activate();
     _range_image_pub->on_activate();
+    startRendering();
   }
 
   /**
@@ -241,33 +227,153 @@ public:
    */
   void onDeactivate() override
   {
+    stopRendering();
     _intensity_image_pub->on_deactivate();
     _range_image_pub->on_deactivate();
   }
 
 private:
+  /**
+   * @brief A completed frame handed from decoding to rendering
+   */
+  struct ImageFrame
+  {
+    std::vector<ros2_ouster::LidarPoint> points;
+    uint64_t stamp{0};
+    uint64_t receive_time{0};
+    uint64_t id{0};
+    uint32_t packets{0};
+    uint32_t width{0};
+    uint32_t height{0};
+  };
+
+  /**
+   * @brief Start the thread rendering and publishing the latest frame
+   */
+  void startRendering()
+  {
+    if (_rendering) {
+      return;
+    }
+    _rendering = true;
+    _render_thread = std::thread(&ImageProcessor::renderLoop, this);
+  }
+
+  /**
+   * @brief Stop the render thread, dropping frames not yet rendered
+   */
+  void stopRendering()
+  {
+    if (!_rendering) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(_render_mutex);
+      _rendering = false;
+    }
+    _render_cv.notify_one();
+    _render_thread.join();
+  }
+
+  /**
+   * @brief Render the most recent frame whenever one was handed over,
+   * frames completed while rendering are skipped in favor of the latest
+   */
+  void renderLoop()
+  {
+    while (_rendering) {
+      {
+        std::unique_lock<std::mutex> lock(_render_mutex);
+        _render_cv.wait(lock, [this] {return !_rendering || _frames->hasNew();});
+      }
+
+      if (_rendering && _frames->update()) {
+        const auto start = std::chrono::steady_clock::now();
+        const ros2_ouster::ResourceSample usage = ros2_ouster::ResourceSample::now();
+        render(_frames->readBuffer());
+        if (_load) {
+          _load->addBusyTime(std::chrono::steady_clock::now() - start);
+        }
+        // rendered off the scheduler threads, so added to the processor here
+        if (_usage) {
+          _usage->record(usage, 0);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Fill and publish the range and intensity images of a frame
+   * @param frame the frame to render
+   */
+  void render(const ImageFrame & frame)
+  {
+    const bool range_wanted = _range_image_pub->get_subscription_count() > 0 &&
+      _range_image_pub->is_activated();
+    const bool intensity_wanted = _intensity_image_pub->get_subscription_count() > 0 &&
+      _intensity_image_pub->is_activated();
+    if (!range_wanted && !intensity_wanted) {
+      return;
+    }
+
+    // the frame may have waited for the previous one to render
+    if (isStale(frame.receive_time)) {
+      return;
+    }
+
+    const auto start = startStage();
+    const uint32_t width = frame.width;
+    const uint32_t height = std::min(_height, frame.height);
+    rclcpp::Time t(frame.stamp);
+    _range_image.header.stamp = t;
+    _intensity_image.header.stamp = t;
+
+    auto fill = [&](std::size_t begin, std::size_t end) {
+        fillImageRows(
+          frame.points.data(), frame.height, width, _px_offset, begin, end,
+          _range_image.data.data(), _intensity_image.data.data());
+      };
+
+    if (_pool) {
+      _pool->parallelFor(0, height, 1, fill);
+    } else {
+      fill(0, height);
+    }
+    recordStage(ros2_ouster::PipelineStage::CONVERSION, start);
+
+    const auto publish_start = startStage();
+    if (range_wanted) {
+      ROS2_OUSTER_TRACEPOINT(
+        publish, name(), frame.id, frame.packets, frame.stamp,
+        static_cast<const void *>(&_range_image));
+      _range_image_pub->publish(_range_image);
+    }
+
+    if (intensity_wanted) {
+      ROS2_OUSTER_TRACEPOINT(
+        publish, name(), frame.id, frame.packets, frame.stamp,
+        static_cast<const void *>(&_intensity_image));
+      _intensity_image_pub->publish(_intensity_image);
+    }
+    recordStage(ros2_ouster::PipelineStage::PUBLISH, publish_start);
+  }
+
   rclcpp_lifecycle::LifecyclePublisher<sensor_msgs::msg::Image>::SharedPtr _intensity_image_pub;
   rclcpp_lifecycle::LifecyclePublisher<sensor_msgs::msg::Image>::SharedPtr _range_image_pub;
-  std::function<void(const uint8_t *, OSImageIt, uint64_t)> _batch_and_publish;
   rclcpp_lifecycle::LifecycleNode::SharedPtr _node;
   sensor_msgs::msg::Image _intensity_image;
   sensor_msgs::msg::Image _range_image;
 
-  std::vector<double> _xyz_lut;
   std::vector<int> _px_offset;
-  OSImage _information_image;
   std::string _frame;
   uint32_t _height;
   uint32_t _width;
 
-  //added by zyl
-  std::vector<double> _cos_lut;
-  std::vector<double> _sin_lut;
-  uint64_t  _id_frame;          //serialNumber of frame
-  uint32_t  _id_col;            //index of column
-  int32_t   _azimuth_last;      //
-  int64_t   _ts_last;           //timestamp of the 1st packet of last frame,
-  uint32_t  _realwidth;
+  std::unique_ptr<ros2_ouster::TripleBuffer<ImageFrame>> _frames;
+  std::thread _render_thread;
+  std::mutex _render_mutex;
+  std::condition_variable _render_cv;
+  std::atomic<bool> _rendering;
 };
 
 }  // namespace OS1
@@ -14,11 +14,13 @@
 #ifndef ROS2_OUSTER__OS1__PROCESSORS__IMU_PROCESSOR_HPP_
 #define ROS2_OUSTER__OS1__PROCESSORS__IMU_PROCESSOR_HPP_
 
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <string>
 
 #include "ros2_ouster/conversions.hpp"
+#include "ros2_ouster/core/tracing.hpp"
 
 #include "rclcpp/qos.hpp"
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
@@ -68,11 +70,37 @@ public:
   bool process(uint8_t * data, uint64_t override_ts) override
   {
     if (_pub->get_subscription_count() > 0 && _pub->is_activated()) {
-      _pub->publish(ros2_ouster::toMsg(data, _frame, override_ts));
+      const auto start = startStage();
+      const sensor_msgs::msg::Imu msg = ros2_ouster::toMsg(data, _frame, override_ts);
+      recordStage(ros2_ouster::PipelineStage::CONVERSION, start);
+
+      const auto publish_start = startStage();
+      ROS2_OUSTER_TRACEPOINT(
+        publish, name(), 0, 1, rclcpp::Time(msg.header.stamp).nanoseconds(),
+        static_cast<const void *>(&msg));
+      _pub->publish(msg);
+      recordStage(ros2_ouster::PipelineStage::PUBLISH, publish_start);
     }
     return true;
   }
 
+  /**
+   * @brief Name of the processor in statistics
+   */
+  const char * name() const override
+  {
+    return "imu";
+  }
+
+
+  /**
+   * @brief Whether the output of this processor is subscribed to
+   */
+  bool hasSubscribers() const override
+  {
+    return _pub->get_subscription_count() > 0;
+  }
+
   /**
    * @brief Activating processor from lifecycle state transitions
    */
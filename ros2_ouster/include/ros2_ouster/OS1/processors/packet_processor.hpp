@@ -0,0 +1,196 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__OS1__PROCESSORS__PACKET_PROCESSOR_HPP_
+#define ROS2_OUSTER__OS1__PROCESSORS__PACKET_PROCESSOR_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "rclcpp/qos.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "ouster_msgs/msg/packet_batch.hpp"
+
+#include "ros2_ouster/core/frame_decoder.hpp"
+#include "ros2_ouster/core/tracing.hpp"
+#include "ros2_ouster/interfaces/data_processor_interface.hpp"
+
+namespace OS1
+{
+/**
+ * @class OS1::PacketProcessor
+ * @brief A data processor interface implementation publishing the raw
+ * lidar packets, batched into one message per frame or per fixed number
+ * of packets, for recording without the cost of decoding.
+ */
+class PacketProcessor : public ros2_ouster::DataProcessorInterface
+{
+public:
+  /**
+   * @brief A constructor for OS1::PacketProcessor
+   * @param node Node for creating interfaces
+   * @param mdata metadata about the sensor
+   * @param frame frame_id to use for messages
+   * @param qos quality of service of the publisher
+   * @param batch_size packets per message, 0 for one message per frame
+   */
+  PacketProcessor(
+    const rclcpp_lifecycle::LifecycleNode::SharedPtr node,
+    const ros2_ouster::Metadata & mdata,
+    const std::string & frame,
+    const rclcpp::QoS & qos,
+    std::size_t batch_size = 0)
+  : DataProcessorInterface(),
+    _node(node),
+    _frame(frame),
+    _is_3d(mdata.lidar_vendor == std::string("OLE_3D_V2")),
+    _packet_size(mdata.lidar_packet_size),
+    _batch_size(batch_size),
+    _reserve(batch_size),
+    _azimuth_last(-1)
+  {
+    _pub = node->create_publisher<ouster_msgs::msg::PacketBatch>("packets", qos);
+  }
+
+  /**
+   * @brief A destructor clearing memory allocated
+   */
+  ~PacketProcessor()
+  {
+    _pub.reset();
+  }
+
+  /**
+   * @brief Process method to add a packet to the batch, publishing the
+   * batch once it completes a frame or holds enough packets
+   * @param data the packet data
+   */
+  bool process(uint8_t * data, uint64_t /*override_ts*/) override
+  {
+    if (!hasSubscribers() || !_pub->is_activated()) {
+      // a partial batch would be published on resubscribing with an old
+      // stamp and a gap, start afresh instead
+      if (_batch) {
+        reset();
+      }
+      return true;
+    }
+
+    const ros2_ouster::Packet * packet =
+      _products->get<ros2_ouster::Packet>(ros2_ouster::RAW_PACKET);
+    const std::size_t size = packet ? packet->size : _packet_size;
+    const uint64_t receive_time = packet ? packet->receive_time : 0;
+
+    if (!_batch) {
+      startBatch(receive_time);
+    }
+    _batch->data.insert(_batch->data.end(), data, data + size);
+    _batch->receive_times.push_back(receive_time);
+
+    // a frame ends with the packet wrapping around, the wrapping
+    // columns of that packet are decoded into the next frame
+    const bool wrapped =
+      ros2_ouster::FrameDecoder::wrapsAround(data, _is_3d, _azimuth_last);
+    const std::size_t count = _batch->receive_times.size();
+    const bool full = _batch_size > 0 ? count >= _batch_size : count >= MAX_BATCH;
+    // published however late, unlike decoded outputs: recorders want
+    // every packet, and a gap gains no latency
+    if ((_batch_size == 0 && wrapped) || full) {
+      _reserve = count;
+      const auto start = startStage();
+      ROS2_OUSTER_TRACEPOINT(
+        publish, name(), 0, static_cast<uint32_t>(count),
+        rclcpp::Time(_batch->header.stamp).nanoseconds(),
+        static_cast<const void *>(_batch.get()));
+      _pub->publish(std::move(_batch));
+      recordStage(ros2_ouster::PipelineStage::PUBLISH, start);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Name of the processor in statistics
+   */
+  const char * name() const override
+  {
+    return "packets";
+  }
+
+
+  /**
+   * @brief Whether the output of this processor is subscribed to
+   */
+  bool hasSubscribers() const override
+  {
+    return _pub->get_subscription_count() > 0;
+  }
+
+  /**
+   * @brief Drop the partially assembled batch
+   */
+  void reset() override
+  {
+    _batch.reset();
+    _azimuth_last = -1;
+  }
+
+  /**
+   * @brief Activating processor from lifecycle state transitions
+   */
+  void onActivate() override
+  {
+    _pub->on_activate();
+  }
+
+  /**
+   * @brief Deactivating processor from lifecycle state transitions
+   */
+  void onDeactivate() override
+  {
+    _pub->on_deactivate();
+    reset();
+  }
+
+private:
+  // bound on the packets of a batch when the sensor does not spin
+  static constexpr std::size_t MAX_BATCH = 4096;
+
+  void startBatch(uint64_t receive_time)
+  {
+    _batch = std::make_unique<ouster_msgs::msg::PacketBatch>();
+    _batch->header.frame_id = _frame;
+    _batch->header.stamp = rclcpp::Time(static_cast<int64_t>(receive_time));
+    _batch->packet_size = _packet_size;
+
+    // reserve as much as the previous batch to append without reallocating
+    _batch->data.reserve(_reserve * _packet_size);
+    _batch->receive_times.reserve(_reserve);
+  }
+
+  rclcpp_lifecycle::LifecyclePublisher<ouster_msgs::msg::PacketBatch>::SharedPtr _pub;
+  rclcpp_lifecycle::LifecycleNode::SharedPtr _node;
+  std::unique_ptr<ouster_msgs::msg::PacketBatch> _batch;
+  std::string _frame;
+  bool _is_3d;
+  uint32_t _packet_size;
+  std::size_t _batch_size;
+  std::size_t _reserve;
+  int32_t _azimuth_last;
+};
+
+}  // namespace OS1
+
+#endif  // ROS2_OUSTER__OS1__PROCESSORS__PACKET_PROCESSOR_HPP_
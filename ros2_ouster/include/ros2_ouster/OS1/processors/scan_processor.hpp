@@ -14,20 +14,22 @@
 #ifndef ROS2_OUSTER__OS1__PROCESSORS__SCAN_PROCESSOR_HPP_
 #define ROS2_OUSTER__OS1__PROCESSORS__SCAN_PROCESSOR_HPP_
 
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include "rclcpp/qos.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
 
 #include "ros2_ouster/conversions.hpp"
+#include "ros2_ouster/core/tracing.hpp"
 
 #include "sensor_msgs/msg/laser_scan.hpp"
 
+#include "ros2_ouster/core/lidar_frame.hpp"
 #include "ros2_ouster/interfaces/data_processor_interface.hpp"
-#include "ros2_ouster/OS1/OS1.hpp"
-#include "ros2_ouster/OS1/OS1_util.hpp"
 
 namespace OS1
 {
@@ -54,19 +56,12 @@ public:
     const ros2_ouster::Metadata & mdata,
     const std::string & frame,
     const rclcpp::QoS & qos)
-  : DataProcessorInterface(), _node(node), _frame(frame)
+  : DataProcessorInterface(), _node(node), _frame(frame), _mdata(mdata)
   {
     _pub = _node->create_publisher<sensor_msgs::msg::LaserScan>("scan", qos);
 
-    _sin_lut = OS1::make_sin_lut();
-    _cos_lut = OS1::make_cos_lut();
-    _id_frame = 0;
-    _id_col = 0;
-    _azimuth_last = -1;
-    _ts_last = -1;
     _height = mdata.num_lasers;
     _width = 2000;
-    _realwidth = 2000;
 
     _aggregated_scans.resize(_width * _height);
 
@@ -81,74 +76,7 @@ public:
     }
     */
     _ring = mdata.ring_scan;
-
-    if(mdata.lidar_vendor == std::string("OLE_3D_V2")){
-      _batch_and_publish =
-      OS1::batch_to_iter2<OSScanIt>(
-      _sin_lut,
-      _cos_lut,
-      mdata.x_offset_array,
-      mdata.y_offset_array,
-      mdata.ah_offset_array,
-      mdata.av_offset_array,
-      _id_frame,
-      _id_col,
-      _azimuth_last,
-      _ts_last,
-	  _realwidth,
-	  {},
-	  &scan_os::ScanOS::make,
-      [&](uint64_t scan_ts,uint32_t width) mutable
-      {
-        if (_pub->get_subscription_count() > 0 && _pub->is_activated()) {
-          auto msg_ptr =
-          std::make_unique<sensor_msgs::msg::LaserScan>(
-            std::move(
-              ros2_ouster::toMsg(
-                _aggregated_scans,
-				width,
-				std::chrono::nanoseconds(scan_ts),
-                _frame,
-				mdata,
-				_ring)));
-          _pub->publish(std::move(msg_ptr));
-        }
-      });  
-    }
-    else{
-      _batch_and_publish =
-      OS1::batch_to_iter3<OSScanIt>(
-      _sin_lut,
-      _cos_lut,
-      mdata.x_offset_array,
-      mdata.y_offset_array,
-      mdata.ah_offset_array,
-      mdata.av_offset_array,
-      _id_frame,
-      _id_col,
-      _azimuth_last,
-      _ts_last,
-	  _realwidth,
-	  {},
-	  &scan_os::ScanOS::make,
-      [&](uint64_t scan_ts,uint32_t width) mutable
-      {
-        if (_pub->get_subscription_count() > 0 && _pub->is_activated()) {
-          auto msg_ptr =
-          std::make_unique<sensor_msgs::msg::LaserScan>(
-            std::move(
-              ros2_ouster::toMsg(
-                _aggregated_scans,
-				width,
-				std::chrono::nanoseconds(_node->now().nanoseconds()),
-                _frame,
-				mdata,
-				_ring)));
-          _pub->publish(std::move(msg_ptr));
-        }
-      });    
-    }     
-    
+    _use_sensor_time = mdata.lidar_vendor == std::string("OLE_3D_V2");
   }
 
   /**
@@ -163,13 +91,85 @@ public:
    * @brief Process method to create scan
    * @param data the packet data
    */
-  bool process(uint8_t * data, uint64_t override_ts) override
+  bool process(uint8_t * /*data*/, uint64_t /*override_ts*/) override
   {
-    OSScanIt it = _aggregated_scans.begin();
-    _batch_and_publish(data, it, override_ts);
+    if (_pub->get_subscription_count() == 0 || !_pub->is_activated()) {
+      return true;
+    }
+
+    const ros2_ouster::LidarFrame * frame =
+      _products->get<ros2_ouster::LidarFrame>(ros2_ouster::DECODED_FRAME);
+    if (_load && !_load->publishFrame(frame->id)) {
+      return true;
+    }
+
+    if (isStale(frame->receive_time)) {
+      return true;
+    }
+
+    const auto start = startStage();
+    if (_aggregated_scans.size() < frame->points.size()) {
+      _aggregated_scans.resize(frame->points.size());
+    }
+
+    const std::size_t size = frame->size();
+    for (std::size_t i = 0; i < size; i++) {
+      const ros2_ouster::LidarPoint & pt = frame->points[i];
+      _aggregated_scans[i] = scan_os::ScanOS::make(
+        pt.x, pt.y, pt.z, pt.intensity, pt.t, pt.reflectivity,
+        pt.ring, frame->id, pt.noise, pt.range);
+    }
+
+    // the 2D lidar clock is not synchronized, stamp with the time received
+    const uint64_t scan_ts =
+      _use_sensor_time ? frame->timestamp : _node->now().nanoseconds();
+    uint32_t width = frame->width;
+    auto msg_ptr =
+      std::make_unique<sensor_msgs::msg::LaserScan>(
+      std::move(
+        ros2_ouster::toMsg(
+          _aggregated_scans,
+          width,
+          std::chrono::nanoseconds(scan_ts),
+          _frame,
+          _mdata,
+          _ring)));
+    recordStage(ros2_ouster::PipelineStage::CONVERSION, start);
+
+    const auto publish_start = startStage();
+    ROS2_OUSTER_TRACEPOINT(
+      publish, name(), frame->id, frame->packets, scan_ts,
+      static_cast<const void *>(msg_ptr.get()));
+    _pub->publish(std::move(msg_ptr));
+    recordStage(ros2_ouster::PipelineStage::PUBLISH, publish_start);
     return true;
   }
 
+  /**
+   * @brief Name of the processor in statistics
+   */
+  const char * name() const override
+  {
+    return "scan";
+  }
+
+
+  /**
+   * @brief Consumes the frames decoded from the packets
+   */
+  std::uint32_t consumes() const override
+  {
+    return ros2_ouster::DECODED_FRAME;
+  }
+
+  /**
+   * @brief Whether the output of this processor is subscribed to
+   */
+  bool hasSubscribers() const override
+  {
+    return _pub->get_subscription_count() > 0;
+  }
+
   /**
    * @brief Activating processor from lifecycle state transitions
    */
@@ -188,25 +188,15 @@ public:
 
 private:
   rclcpp_lifecycle::LifecyclePublisher<sensor_msgs::msg::LaserScan>::SharedPtr _pub;
-  std::function<void(const uint8_t *, OSScanIt, uint64_t)> _batch_and_publish;
-  std::shared_ptr<pcl::PointCloud<scan_os::ScanOS>> _cloud;
   rclcpp_lifecycle::LifecycleNode::SharedPtr _node;
 
-  std::vector<double> _xyz_lut;
   OSScan _aggregated_scans;
   std::string _frame;
+  ros2_ouster::Metadata _mdata;
   uint32_t _height;
   uint32_t _width;
   uint8_t _ring;
-
-  //added by zyl
-  std::vector<double> _cos_lut;
-  std::vector<double> _sin_lut;
-  uint64_t  _id_frame;          //serialNumber of frame
-  uint32_t  _id_col;            //index of column
-  int32_t   _azimuth_last;      //
-  int64_t   _ts_last;           //timestamp of the 1st packet of last frame,
-  uint32_t  _realwidth;
+  bool _use_sensor_time;
 };
 
 }  // namespace OS1
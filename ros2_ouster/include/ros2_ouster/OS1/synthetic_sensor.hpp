@@ -0,0 +1,108 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__OS1__SYNTHETIC_SENSOR_HPP_
+#define ROS2_OUSTER__OS1__SYNTHETIC_SENSOR_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ros2_ouster/core/packet_generator.hpp"
+#include "ros2_ouster/interfaces/sensor_interface.hpp"
+
+namespace OS1
+{
+
+/**
+ * @class OS1::SyntheticSensor
+ * @brief A sensor interface implementation generating the lidar packets
+ * of a synthetic scene, see ros2_ouster::PacketGenerator, in place of a
+ * live sensor. Exercises the whole pipeline without hardware.
+ *
+ * Packets are generated at the pace of the sensor, scaled by a rate, or
+ * as fast as they are read. No IMU packets are generated.
+ */
+class SyntheticSensor : public ros2_ouster::SensorInterface
+{
+public:
+  /**
+   * @brief A constructor for OS1::SyntheticSensor
+   * @param mdata metadata about the sensor, its format and lasers
+   * @param scene what the sensor sees
+   * @param rotation_rate revolutions per second of the sensor
+   * @param rate speed relative to the sensor, e.g. 2.0 for twice as
+   * fast, 0 to generate packets as fast as possible
+   */
+  SyntheticSensor(
+    const ros2_ouster::Metadata & mdata, const ros2_ouster::SyntheticScene & scene,
+    double rotation_rate = 10.0, double rate = 1.0);
+
+  /**
+   * @brief Restart from the first packet
+   * @param configuration file to use
+   */
+  void reset(const ros2_ouster::Configuration & config) override;
+
+  /**
+   * @brief Restart from the first packet
+   * @param configuration file to use
+   */
+  void configure(const ros2_ouster::Configuration & config) override;
+
+  /**
+   * @brief Wait until the next packet of the sensor is due
+   * @return the state enum value
+   */
+  ros2_ouster::ClientState get() override;
+
+  /**
+   * @brief Generate the packet due
+   * @param state of the sensor
+   * @return the packet of data, valid until the next one is read
+   */
+  uint8_t * readPacket(const ros2_ouster::ClientState & state) override;
+
+  /**
+   * @brief Skip the packets due while idle on resume
+   * @param idle true to enter idle mode
+   */
+  void setIdle(bool idle) override;
+
+  /**
+   * @brief Skip the packets already due, none when generating as fast
+   * as possible
+   * @return number of packets skipped
+   */
+  std::size_t drain() override;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Time the next packet is due
+   */
+  Clock::time_point due() const;
+
+  ros2_ouster::PacketGenerator _generator;
+  std::vector<uint8_t> _packet;
+  double _rate;
+  Clock::time_point _start;
+  bool _started;
+  bool _idle;
+};
+
+}  // namespace OS1
+
+#endif  // ROS2_OUSTER__OS1__SYNTHETIC_SENSOR_HPP_
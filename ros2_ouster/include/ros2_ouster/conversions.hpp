@@ -31,10 +31,17 @@
 #include "sensor_msgs/msg/laser_scan.hpp"
 #include "tf2/LinearMath/Transform.h"
 #include "tf2_geometry_msgs/tf2_geometry_msgs.h"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "ouster_msgs/msg/latency_histogram.hpp"
 #include "ouster_msgs/msg/metadata.hpp"
+#include "ouster_msgs/msg/resource_usage.hpp"
 
 #include "ros2_ouster/OS1/OS1.hpp"
 #include "ros2_ouster/OS1/OS1_packet.hpp"
+#include "ros2_ouster/core/health_monitor.hpp"
+#include "ros2_ouster/core/latency_histogram.hpp"
+#include "ros2_ouster/core/resource_usage.hpp"
+#include "ros2_ouster/thread_pool.hpp"
 
 namespace ros2_ouster
 {
@@ -84,6 +91,115 @@ inline ouster_msgs::msg::Metadata toMsg(const ros2_ouster::Metadata & mdata)
   msg.lidar_ip = mdata.lidar_ip;
   msg.imu_port = mdata.imu_port;
   msg.lidar_port = mdata.lidar_port;
+  msg.lidar_vendor = mdata.lidar_vendor;
+  msg.lidar_packet_size = mdata.lidar_packet_size;
+  msg.imu_packet_size = mdata.imu_packet_size;
+  msg.num_lasers = mdata.num_lasers;
+  msg.distance_resolution = mdata.distance_resolution;
+  msg.ring_scan = mdata.ring_scan;
+  msg.x_offset_array = mdata.x_offset_array;
+  msg.y_offset_array = mdata.y_offset_array;
+  msg.ah_offset_array = mdata.ah_offset_array;
+  msg.av_offset_array = mdata.av_offset_array;
+  msg.laser_id_array = mdata.laser_id_array;
+  msg.imu_to_sensor_transform = mdata.imu_to_sensor_transform;
+  msg.lidar_to_sensor_transform = mdata.lidar_to_sensor_transform;
+  return msg;
+}
+
+/**
+ * @brief Convert metadata from message format, e.g. to decode
+ * recorded packets
+ */
+inline ros2_ouster::Metadata fromMsg(const ouster_msgs::msg::Metadata & msg)
+{
+  ros2_ouster::Metadata mdata;
+  mdata.computer_ip = msg.computer_ip;
+  mdata.lidar_ip = msg.lidar_ip;
+  mdata.imu_port = msg.imu_port;
+  mdata.lidar_port = msg.lidar_port;
+  mdata.lidar_vendor = msg.lidar_vendor;
+  mdata.lidar_packet_size = msg.lidar_packet_size;
+  mdata.imu_packet_size = msg.imu_packet_size;
+  mdata.num_lasers = msg.num_lasers;
+  mdata.distance_resolution = msg.distance_resolution;
+  mdata.ring_scan = msg.ring_scan;
+  mdata.x_offset_array = msg.x_offset_array;
+  mdata.y_offset_array = msg.y_offset_array;
+  mdata.ah_offset_array = msg.ah_offset_array;
+  mdata.av_offset_array = msg.av_offset_array;
+  mdata.laser_id_array = msg.laser_id_array;
+  mdata.imu_to_sensor_transform = msg.imu_to_sensor_transform;
+  mdata.lidar_to_sensor_transform = msg.lidar_to_sensor_transform;
+  return mdata;
+}
+
+/**
+ * @brief Convert a latency histogram to message format, with the non
+ * empty buckets only
+ * @param histogram the counts of the histogram
+ * @param name name of the stage or processor
+ */
+inline ouster_msgs::msg::LatencyHistogram toMsg(
+  const ros2_ouster::LatencyHistogram::Snapshot & histogram, const std::string & name)
+{
+  ouster_msgs::msg::LatencyHistogram msg;
+  msg.name = name;
+  msg.count = histogram.count;
+  msg.mean = histogram.mean();
+  msg.max = histogram.max;
+  msg.p50 = histogram.percentile(0.5);
+  msg.p90 = histogram.percentile(0.9);
+  msg.p99 = histogram.percentile(0.99);
+  msg.p999 = histogram.percentile(0.999);
+  for (std::size_t i = 0; i < histogram.counts.size(); i++) {
+    if (histogram.counts[i] > 0) {
+      msg.bucket_lower_bounds.push_back(ros2_ouster::LatencyHistogram::lowest(i));
+      msg.bucket_counts.push_back(histogram.counts[i]);
+    }
+  }
+  return msg;
+}
+
+/**
+ * @brief Convert the resource usage of a stage or processor to message
+ * format
+ * @param usage the totals of the usage
+ * @param name name of the stage or processor
+ */
+inline ouster_msgs::msg::ResourceUsage toMsg(
+  const ros2_ouster::ResourceUsage::Totals & usage, const std::string & name)
+{
+  ouster_msgs::msg::ResourceUsage msg;
+  msg.name = name;
+  msg.calls = usage.calls;
+  msg.cpu_time = usage.cpu_time;
+  msg.allocations = usage.allocations;
+  msg.allocated_bytes = usage.allocated_bytes;
+  return msg;
+}
+
+/**
+ * @brief Convert a health report to a diagnostic status
+ * @param report the health of the driver over the last period
+ * @param name name of the status
+ * @param hardware_id identifier of the sensor
+ */
+inline diagnostic_msgs::msg::DiagnosticStatus toMsg(
+  const ros2_ouster::HealthReport & report, const std::string & name,
+  const std::string & hardware_id)
+{
+  diagnostic_msgs::msg::DiagnosticStatus msg;
+  msg.level = static_cast<uint8_t>(report.level);
+  msg.name = name;
+  msg.message = report.message;
+  msg.hardware_id = hardware_id;
+  for (const auto & value : report.values) {
+    diagnostic_msgs::msg::KeyValue key_value;
+    key_value.key = value.first;
+    key_value.value = value.second;
+    msg.values.push_back(key_value);
+  }
   return msg;
 }
 
@@ -183,6 +299,8 @@ inline sensor_msgs::msg::Imu toMsg(
  * @param[in] timestamp The timestamp to put on the ROS message header
  * @param[in] frame The TF coordinate frame identifier to put on the ROS
  *                  message header.
+ * @param[in] pool Optional thread pool to split the reordering over column
+ *                 ranges.
  *
  * @return A ROS `PointCloud2` message of LiDAR data whose memory buffer is
  *         row-major ordered consistent to the shape of the LiDAR array.
@@ -191,7 +309,8 @@ inline sensor_msgs::msg::PointCloud2 toMsg(
   const pcl::PointCloud<point_os::PointOS> & cloud,
   uint32_t & realwidth,
   std::chrono::nanoseconds timestamp,
-  const std::string & frame)
+  const std::string & frame,
+  ros2_ouster::ThreadPool * pool = nullptr)
 {
   std::size_t pt_size = sizeof(point_os::PointOS);
   std::size_t data_size = pt_size * cloud.points.size();
@@ -220,15 +339,21 @@ inline sensor_msgs::msg::PointCloud2 toMsg(
 
   if (data_size) {
     // column-major to row-major conversion
-    for (int i = 0; i < cloud2.width; ++i) {
-      for (int j = 0; j < cloud2.height; ++j) {
-    	std::memcpy(
-    	          &cloud2.data[(j * cloud2.width + i) * pt_size],
-    	          &cloud.points[i * cloud2.height + j],
-    	          pt_size);
-
-
-      }
+    auto reorder = [&cloud, &cloud2, pt_size](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          for (std::size_t j = 0; j < cloud2.height; ++j) {
+            std::memcpy(
+              &cloud2.data[(j * cloud2.width + i) * pt_size],
+              &cloud.points[i * cloud2.height + j],
+              pt_size);
+          }
+        }
+      };
+
+    if (pool) {
+      pool->parallelFor(0, cloud2.width, 0, reorder);
+    } else {
+      reorder(0, cloud2.width);
     }
   }
 
@@ -0,0 +1,91 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__COMPRESSED_READER_HPP_
+#define ROS2_OUSTER__CORE__COMPRESSED_READER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/core/packet_codec.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::CompressedReader
+ * @brief Reads a recording written by CompressedRecorder, see
+ * recording_format.hpp, including one cut short by a crash. The file is
+ * mapped and decompressed a block at a time, packets are handed out from
+ * the decompressed block.
+ */
+class CompressedReader
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::CompressedReader, opening the
+   * file. Throws OusterDriverException if it is not a valid recording.
+   * @param path path of the recording
+   */
+  explicit CompressedReader(const std::string & path);
+
+  /**
+   * @brief A destructor for ros2_ouster::CompressedReader
+   */
+  ~CompressedReader();
+
+  CompressedReader(const CompressedReader &) = delete;
+  CompressedReader & operator=(const CompressedReader &) = delete;
+
+  /**
+   * @brief Metadata about the sensor recorded
+   */
+  const Metadata & metadata() const
+  {
+    return _metadata;
+  }
+
+  /**
+   * @brief Read the next packet. Throws OusterDriverException if the
+   * recording is corrupted.
+   * @param packet set to the packet, its data stays valid until the
+   * next call
+   * @return false at the end of the recording
+   */
+  bool next(Packet & packet);
+
+private:
+  /**
+   * @brief Decompress the next block
+   * @return false at the end of the recording
+   */
+  bool nextBlock();
+
+  std::string _path;
+  uint8_t * _map;
+  std::size_t _map_size;
+  std::size_t _offset;         // offset of the next block in the file
+  Metadata _metadata;
+  std::unique_ptr<PacketCodec> _codec;
+  std::vector<uint8_t> _records;
+  std::size_t _record_offset;  // offset of the next record in the block
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__COMPRESSED_READER_HPP_
@@ -0,0 +1,171 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__COMPRESSED_RECORDER_HPP_
+#define ROS2_OUSTER__CORE__COMPRESSED_RECORDER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/core/packet_codec.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::CompressedRecorder
+ * @brief Records raw packets with their receive times to a compressed
+ * file, see recording_format.hpp, for logging over long durations.
+ *
+ * Recording a packet is a copy to the current block. Full blocks are
+ * compressed with PacketCodec and written by a background thread, so the
+ * thread receiving packets never waits for the compression or the disk.
+ * The buffers of the blocks are allocated up front. If the background
+ * thread falls behind, so that no buffer is free, or the file reaches its
+ * maximum size, whole blocks are dropped and their packets counted.
+ *
+ * Packets are written from a single thread.
+ */
+class CompressedRecorder
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::CompressedRecorder, creating
+   * the file. Throws OusterDriverException if it cannot be created.
+   * @param path path of the file, replaced if it exists
+   * @param mdata metadata about the sensor, stored in the file
+   * @param max_size maximum bytes of the file
+   */
+  CompressedRecorder(const std::string & path, const Metadata & mdata, std::size_t max_size);
+
+  /**
+   * @brief A destructor for ros2_ouster::CompressedRecorder, closing the file
+   */
+  ~CompressedRecorder();
+
+  CompressedRecorder(const CompressedRecorder &) = delete;
+  CompressedRecorder & operator=(const CompressedRecorder &) = delete;
+
+  /**
+   * @brief Record a packet. The packet is copied to the current block,
+   * compressing and writing it happen later, so this cannot tell whether
+   * the packet itself makes it to the file.
+   * @param packet the packet to record
+   * @return false if packets were dropped since the previous call, this
+   * one possibly among them, or if the recording is closed
+   */
+  bool write(const Packet & packet);
+
+  /**
+   * @brief Finish the recording: compress the last block and wait for
+   * the background thread to write everything
+   */
+  void close();
+
+  /**
+   * @brief Number of packets written to the file
+   */
+  uint64_t packets() const
+  {
+    return _packets.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Number of packets dropped
+   */
+  uint64_t dropped() const
+  {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Ratio of the size of the packets written, with their receive
+   * times, to the size of the compressed blocks
+   */
+  double ratio() const;
+
+  /**
+   * @brief Rate at which the background thread compresses and writes
+   * packets, in MB/s of packets
+   */
+  double throughput() const;
+
+  /**
+   * @brief Path of the file
+   */
+  const std::string & path() const
+  {
+    return _path;
+  }
+
+private:
+  // bytes of records in a block before it is compressed
+  static constexpr std::size_t BLOCK_SIZE = 1 << 20;
+  // buffers of blocks handed to the background thread, queued or being
+  // written, before blocks are dropped
+  static constexpr std::size_t MAX_QUEUED = 8;
+
+  /**
+   * @brief Hand the current block to the background thread
+   */
+  void submit();
+
+  void worker();
+
+  /**
+   * @brief Write bytes to the file, false on error
+   */
+  bool writeAll(const void * data, std::size_t size);
+
+  std::string _path;
+  int _fd;
+  std::size_t _max_size;
+  std::size_t _file_size;      // background thread only
+  PacketCodec _codec;          // background thread only
+
+  // current block, receiving thread only
+  std::vector<uint8_t> _block;
+  std::size_t _block_count;
+  uint64_t _dropped_reported;
+
+  struct Block
+  {
+    std::vector<uint8_t> records;
+    std::size_t count;
+  };
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::vector<Block> _queue;                   // oldest first, reserved up front
+  std::vector<std::vector<uint8_t>> _spare;    // free buffers, MAX_QUEUED in all
+  bool _stop;
+  std::thread _worker;
+
+  std::atomic<uint64_t> _packets;
+  std::atomic<uint64_t> _dropped;
+  std::atomic<uint64_t> _raw_bytes;
+  std::atomic<uint64_t> _compressed_bytes;
+  std::atomic<uint64_t> _busy_ns;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__COMPRESSED_RECORDER_HPP_
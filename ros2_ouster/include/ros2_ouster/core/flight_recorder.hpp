@@ -0,0 +1,174 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__FLIGHT_RECORDER_HPP_
+#define ROS2_OUSTER__CORE__FLIGHT_RECORDER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/core/packet_loss_estimator.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::FlightRecorder
+ * @brief Keeps the most recent raw packets in a ring, and dumps them to a
+ * recording in the PacketRecorder format on demand or when an anomaly is
+ * detected, so that intermittent problems can be replayed.
+ *
+ * The ring is a memory mapped file: packets survive a crash of the
+ * process, and a ring left behind by a crash is dumped when the next
+ * flight recorder opens it. Writing a packet is a copy into the ring
+ * guarded by a per-slot sequence number, without locks or system calls.
+ * Dumps are read concurrently, skipping slots overwritten meanwhile.
+ *
+ * Packets are written from a single thread, dumps can be requested from
+ * any thread.
+ */
+class FlightRecorder
+{
+public:
+  using DumpCallback = std::function<void (const std::string & path, const std::string & reason)>;
+
+  /**
+   * @brief A constructor for ros2_ouster::FlightRecorder, creating the
+   * ring file after dumping any ring left behind by a crash. Throws
+   * OusterDriverException if it cannot be created.
+   * @param path path of the ring file, dumps are written next to it
+   * @param mdata metadata about the sensor, stored with the packets
+   * @param span time span of the packets to keep
+   */
+  FlightRecorder(
+    const std::string & path, const Metadata & mdata, std::chrono::nanoseconds span);
+
+  /**
+   * @brief A destructor for ros2_ouster::FlightRecorder, removing the ring file
+   */
+  ~FlightRecorder();
+
+  FlightRecorder(const FlightRecorder &) = delete;
+  FlightRecorder & operator=(const FlightRecorder &) = delete;
+
+  /**
+   * @brief Keep a packet, lock free. Bursts of lost lidar packets, found
+   * from gaps in the azimuths, trigger a dump.
+   * @param packet the packet to keep
+   */
+  void write(const Packet & packet);
+
+  /**
+   * @brief Forget the last lidar packet, after packets were skipped on
+   * purpose, so that the gap is not taken for packet loss
+   */
+  void restart()
+  {
+    _loss.restart();
+  }
+
+  /**
+   * @brief Request a dump in the background, lock free. The dump is
+   * written shortly after, so that it also holds what followed the
+   * anomaly. Further triggers are ignored for the time span of the ring.
+   * @param reason short reason, part of the file name, must be a string
+   * literal or otherwise outlive the recorder
+   */
+  void trigger(const char * reason);
+
+  /**
+   * @brief Dump the packets in the ring now
+   * @param reason short reason, part of the file name
+   * @return path of the recording written
+   */
+  std::string dump(const std::string & reason);
+
+  /**
+   * @brief Set the function called from the background thread after
+   * a triggered dump
+   * @param callback the function to call
+   */
+  void setDumpCallback(DumpCallback callback);
+
+  /**
+   * @brief Path of the dump of a ring left behind by a crash, empty if none
+   */
+  const std::string & recovered() const
+  {
+    return _recovered;
+  }
+
+private:
+  struct RingHeader;
+  struct SlotHeader;
+
+  // rate of packets the ring is sized for, above any supported sensor
+  static constexpr double MAX_PACKET_RATE = 2000.0;
+  // estimated lost lidar packets in a single gap triggering a dump
+  static constexpr double LOSS_BURST = 10.0;
+  // delay of a triggered dump
+  static constexpr std::chrono::seconds DUMP_DELAY{1};
+
+  /**
+   * @brief Copy the consistent packets of a ring to a recording
+   */
+  static std::string dumpRing(
+    uint8_t * map, const std::string & metadata, const std::string & path);
+
+  /**
+   * @brief Dump a ring file left behind by a crash
+   * @return path of the recording, empty if there was no such ring
+   */
+  static std::string recover(const std::string & path);
+
+  /**
+   * @brief Name of a dump file for a reason
+   */
+  static std::string dumpPath(const std::string & path, const std::string & reason);
+
+  void worker();
+
+  std::string _path;
+  std::string _metadata;
+  std::string _recovered;
+  uint8_t * _map;
+  std::size_t _map_size;
+  RingHeader * _header;
+
+  std::chrono::nanoseconds _span;
+
+  // loss detection, writer thread only
+  PacketLossEstimator _loss;
+
+  std::mutex _dump_mutex;
+  std::atomic<const char *> _pending;
+  std::atomic<int64_t> _quiet_until;   // steady time before which triggers are ignored
+  DumpCallback _callback;
+  std::mutex _worker_mutex;
+  std::condition_variable _worker_cv;
+  bool _stop;
+  std::thread _worker;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__FLIGHT_RECORDER_HPP_
@@ -0,0 +1,118 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__FRAME_DEADLINE_HPP_
+#define ROS2_OUSTER__CORE__FRAME_DEADLINE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "ros2_ouster/core/lidar_frame.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::FrameDeadline
+ * @brief Decides whether a frame is still fresh enough to publish. A
+ * frame is stale once the time since its last packet was received,
+ * including the time it spent queued in the socket and in the driver,
+ * exceeds the maximum age. Stale frames are counted, the counters can be
+ * read from any thread.
+ */
+class FrameDeadline
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::FrameDeadline
+   * @param max_age maximum age of a frame at publication, 0 to never drop
+   */
+  explicit FrameDeadline(std::chrono::nanoseconds max_age = std::chrono::nanoseconds(0))
+  : _max_age(max_age.count()), _admitted(0), _dropped(0)
+  {
+  }
+
+  /**
+   * @brief Check a frame right before publishing it
+   * @param frame the frame to publish
+   * @return true if the frame should be published, false if it is stale
+   */
+  bool admit(const LidarFrame & frame)
+  {
+    return admit(frame.receive_time);
+  }
+
+  /**
+   * @brief Check data right before publishing it
+   * @param receive_time time the data was received in ns since epoch,
+   * 0 if unknown
+   * @return true if the data should be published, false if it is stale
+   */
+  bool admit(uint64_t receive_time)
+  {
+    if (_max_age > 0 && receive_time != 0 && age(receive_time) > _max_age) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    _admitted.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief Age of data received at a given time
+   * @param receive_time time the data was received in ns since epoch
+   * @return age in ns, 0 if received in the future of this clock
+   */
+  static int64_t age(uint64_t receive_time)
+  {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t age = now - static_cast<int64_t>(receive_time);
+    return age > 0 ? age : 0;
+  }
+
+  /**
+   * @brief Number of outputs published since construction
+   */
+  uint64_t admitted() const
+  {
+    return _admitted.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Number of outputs dropped as stale since construction
+   */
+  uint64_t dropped() const
+  {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Maximum age of a frame at publication in ns, 0 if disabled
+   */
+  int64_t maxAge() const
+  {
+    return _max_age;
+  }
+
+private:
+  int64_t _max_age;
+  std::atomic<uint64_t> _admitted;
+  std::atomic<uint64_t> _dropped;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__FRAME_DEADLINE_HPP_
@@ -0,0 +1,149 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__FRAME_DECODER_HPP_
+#define ROS2_OUSTER__CORE__FRAME_DECODER_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::FrameDecoder
+ * @brief Decodes lidar packets into points and assembles them into
+ * frames, one per revolution of the sensor. Supports the OLE_3D_V2 and
+ * OLE_2D_V2 packet formats.
+ *
+ * Completed frames are double buffered: a frame handed to the callback
+ * stays valid and unchanged until the next frame completes.
+ */
+class FrameDecoder
+{
+public:
+  using FrameCallback = std::function<void (const LidarFrame &)>;
+
+  /**
+   * @brief A constructor for ros2_ouster::FrameDecoder
+   * @param mdata metadata about the sensor
+   * @param max_width maximum number of columns in a frame, further
+   * columns of a frame are dropped
+   */
+  explicit FrameDecoder(const Metadata & mdata, uint32_t max_width = 2000);
+
+  /**
+   * @brief Set the function called with every completed frame
+   * @param callback the function to call
+   */
+  void setFrameCallback(FrameCallback callback);
+
+  /**
+   * @brief Decode a lidar packet, calling the frame callback if the
+   * packet completes a frame
+   * @param packet the packet data
+   * @param receive_time time the packet was received in ns since epoch,
+   * recorded as the completion time of the frame it completes
+   * @return true if the packet completed a frame
+   */
+  bool decode(const uint8_t * packet, uint64_t receive_time = 0);
+
+  /**
+   * @brief Check whether a packet wraps around to the next revolution of
+   * the sensor, reading only its azimuths. Meant for splitting the packet
+   * stream into frames without decoding it.
+   * @param packet the packet data
+   * @param is_3d true for the OLE_3D_V2 packet format, false for OLE_2D_V2
+   * @param azimuth_last azimuth of the last column of the previous packet,
+   * -1 initially, updated to the last column of this packet
+   * @return true if the packet wraps around
+   */
+  static bool wrapsAround(const uint8_t * packet, bool is_3d, int32_t & azimuth_last);
+
+  /**
+   * @brief Azimuth of the first column of a packet, without decoding it
+   * @param packet the packet data
+   * @param is_3d true for the OLE_3D_V2 packet format, false for OLE_2D_V2
+   * @return azimuth in 0.01 degrees, -1 if invalid
+   */
+  static int32_t firstAzimuth(const uint8_t * packet, bool is_3d);
+
+  /**
+   * @brief Keep only every n-th column of the frames, starting with the
+   * next frame
+   * @param decimation 1 to keep every column
+   */
+  void setColumnDecimation(uint32_t decimation)
+  {
+    _next_decimation = decimation > 0 ? decimation : 1;
+  }
+
+  /**
+   * @brief Drop the partially assembled frame, the next frame starts at
+   * the next revolution of the sensor
+   */
+  void reset();
+
+  /**
+   * @brief The most recently completed frame
+   */
+  const LidarFrame & lastFrame() const
+  {
+    return _frames[_completed];
+  }
+
+  /**
+   * @brief Number of rings of the frames of this decoder
+   */
+  uint32_t height() const
+  {
+    return _height;
+  }
+
+private:
+  bool decodeOLE3DV2(const uint8_t * packet);
+  bool decodeOLE2DV2(const uint8_t * packet);
+  void completeFrame(uint64_t timestamp);
+
+  bool _is_3d;
+  uint32_t _height;
+  uint32_t _max_width;
+
+  std::vector<double> _sin_lut;
+  std::vector<double> _cos_lut;
+  std::vector<double> _x_offset_array;
+  std::vector<double> _y_offset_array;
+  std::vector<uint32_t> _av_offset_lut;
+
+  LidarFrame _frames[2];
+  int _completed;
+  FrameCallback _callback;
+  uint64_t _receive_time;
+  uint32_t _decimation;       // column decimation of the frame being assembled
+  uint32_t _next_decimation;
+
+  uint64_t _id_frame;       // serial number of the frame being assembled
+  uint32_t _packets;        // packets decoded into it so far
+  uint32_t _id_col;         // index of the next column
+  int32_t _azimuth_last;    // azimuth of the previous column
+  int64_t _ts_last;         // timestamp of the 1st packet of the frame
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__FRAME_DECODER_HPP_
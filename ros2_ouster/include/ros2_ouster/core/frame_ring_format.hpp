@@ -0,0 +1,85 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__FRAME_RING_FORMAT_HPP_
+#define ROS2_OUSTER__CORE__FRAME_RING_FORMAT_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ros2_ouster
+{
+
+/**
+ * Layout of the shared memory frame ring, all integers in host byte order:
+ *
+ *   RingHeader, padded to 64 bytes
+ *   slot_count slots of slot_size bytes: SlotHeader padded to 64 bytes,
+ *   then max_points ros2_ouster::LidarPoint, column major as in LidarFrame
+ *
+ * Frames are numbered from 1 and frame n is written to slot
+ * (n - 1) % slot_count. A slot's sequence is 2n - 1 while frame n is
+ * written and 2n once it is complete, so that readers check the sequence
+ * before and after reading a slot to know whether it was overwritten
+ * meanwhile.
+ */
+namespace frame_ring
+{
+
+constexpr char MAGIC[8] = {'O', 'U', 'S', 'T', 'S', 'H', 'M', '1'};
+constexpr uint32_t VERSION = 1;
+constexpr std::size_t ALIGNMENT = 64;
+
+/**
+ * @brief Header at the start of the ring
+ */
+struct RingHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t slot_count;
+  uint64_t slot_size;               // bytes of a slot, header included
+  uint32_t max_points;              // points a slot holds
+  uint32_t point_size;              // bytes of a point, checked by readers
+  std::atomic<uint64_t> head;       // last frame written, 0 for none
+  std::atomic<uint32_t> readers;    // readers attached
+  std::atomic<uint32_t> closed;     // 1 once the writer is gone
+};
+
+/**
+ * @brief Header of a slot
+ */
+struct SlotHeader
+{
+  std::atomic<uint64_t> sequence;   // 2n - 1 while frame n is written, 2n once written
+  uint64_t id;                      // serial number of the frame
+  uint64_t timestamp;               // sensor time of the first packet in ns
+  uint64_t receive_time;            // time the last packet was received in ns since epoch
+  uint32_t width;                   // number of valid columns
+  uint32_t height;                  // number of rings
+};
+
+/**
+ * @brief Size rounded up to the alignment of the ring
+ */
+inline std::size_t align(std::size_t size)
+{
+  return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+}  // namespace frame_ring
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__FRAME_RING_FORMAT_HPP_
@@ -0,0 +1,149 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__FRAME_RING_READER_HPP_
+#define ROS2_OUSTER__CORE__FRAME_RING_READER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ros2_ouster/core/frame_ring_format.hpp"
+#include "ros2_ouster/core/lidar_frame.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @struct ros2_ouster::FrameView
+ * @brief A frame in the shared memory ring, read in place
+ */
+struct FrameView
+{
+  uint64_t sequence{0};       // number of the frame in the ring
+  uint64_t id{0};             // serial number of the frame
+  uint64_t timestamp{0};      // sensor time of the first packet in ns
+  uint64_t receive_time{0};   // time the last packet was received in ns since epoch
+  uint32_t width{0};          // number of valid columns
+  uint32_t height{0};         // number of rings
+  const LidarPoint * points{nullptr};   // column major, height points per column
+
+  /**
+   * @brief Number of valid points in the frame
+   */
+  std::size_t size() const
+  {
+    return static_cast<std::size_t>(width) * height;
+  }
+};
+
+/**
+ * @class ros2_ouster::FrameRingReader
+ * @brief Reads the frames a FrameRingWriter publishes in shared memory,
+ * from any process on the host, without ROS. Needs only this library and
+ * the headers of the core library.
+ *
+ * Frames are handed out in place: the points of a FrameView are those in
+ * the ring, without copies. The writer does not wait for readers, so a
+ * frame may be overwritten while it is read, once the writer has gone
+ * around the ring. Call valid() after using a view: if it returns false
+ * the points read may be inconsistent and must be discarded. read()
+ * copies a frame and does that check.
+ *
+ * A reader is used from a single thread.
+ */
+class FrameRingReader
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::FrameRingReader, attaching to
+   * the ring. Throws OusterDriverException if it does not exist yet or
+   * is not a frame ring.
+   * @param name name of the shared memory object, as given to the writer
+   */
+  explicit FrameRingReader(const std::string & name);
+
+  /**
+   * @brief A destructor for ros2_ouster::FrameRingReader, detaching
+   */
+  ~FrameRingReader();
+
+  FrameRingReader(const FrameRingReader &) = delete;
+  FrameRingReader & operator=(const FrameRingReader &) = delete;
+
+  /**
+   * @brief Get the oldest frame not read yet that is still in the ring
+   * @param view set to the frame
+   * @return false if there is no new frame
+   */
+  bool next(FrameView & view);
+
+  /**
+   * @brief Get the newest frame, skipping any older one not read yet
+   * @param view set to the frame
+   * @return false if there is no new frame
+   */
+  bool latest(FrameView & view);
+
+  /**
+   * @brief Whether a frame was not overwritten since it was handed out,
+   * so that what was read from its points is consistent
+   * @param view the frame
+   */
+  bool valid(const FrameView & view) const;
+
+  /**
+   * @brief Copy the oldest frame not read yet, skipping frames
+   * overwritten while copied
+   * @param frame set to the frame
+   * @return false if there is no new frame
+   */
+  bool read(LidarFrame & frame);
+
+  /**
+   * @brief Number of frames overwritten before they were read
+   */
+  uint64_t lost() const
+  {
+    return _lost;
+  }
+
+  /**
+   * @brief Whether the writer closed the ring or replaced it with a new
+   * one, in which case no more frames will come: a new reader must be
+   * attached to the ring of the same name.
+   */
+  bool closed() const;
+
+private:
+  /**
+   * @brief Hand out a frame
+   * @return false if it was already overwritten
+   */
+  bool get(uint64_t sequence, FrameView & view) const;
+
+  const frame_ring::SlotHeader * slot(uint64_t sequence) const;
+
+  std::string _name;
+  uint8_t * _map;
+  std::size_t _map_size;
+  frame_ring::RingHeader * _header;
+  uint8_t * _slots;
+  uint64_t _inode;
+  uint64_t _last;             // last frame handed out
+  uint64_t _lost;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__FRAME_RING_READER_HPP_
@@ -0,0 +1,104 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__FRAME_RING_WRITER_HPP_
+#define ROS2_OUSTER__CORE__FRAME_RING_WRITER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ros2_ouster/core/frame_ring_format.hpp"
+#include "ros2_ouster/core/lidar_frame.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @struct ros2_ouster::FrameRingOptions
+ * @brief Name and size of the shared memory frame ring
+ */
+struct FrameRingOptions
+{
+  std::string name{"/ouster_frames"};  // shared memory object, in /dev/shm
+  std::size_t slots{4};                // frames kept
+};
+
+/**
+ * @class ros2_ouster::FrameRingWriter
+ * @brief Publishes frames in a POSIX shared memory ring, see
+ * frame_ring_format.hpp, for processes on the same host that do not use
+ * ROS. Readers, see FrameRingReader, map the ring and read the points in
+ * place. Writing a frame is a copy of its points to the next slot,
+ * overwriting the oldest frame, without locks or system calls: the
+ * writer never waits for readers.
+ *
+ * Frames are written from a single thread.
+ */
+class FrameRingWriter
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::FrameRingWriter, creating the
+   * ring. A ring of the same name is replaced, its readers see it closed.
+   * Throws OusterDriverException if it cannot be created.
+   * @param name name of the shared memory object, starting with a slash
+   * @param slot_count number of frames kept
+   * @param max_points points a slot holds, columns of larger frames are
+   * cut
+   */
+  FrameRingWriter(const std::string & name, std::size_t slot_count, std::size_t max_points);
+
+  /**
+   * @brief A destructor for ros2_ouster::FrameRingWriter, marking the ring
+   * closed and removing its name
+   */
+  ~FrameRingWriter();
+
+  FrameRingWriter(const FrameRingWriter &) = delete;
+  FrameRingWriter & operator=(const FrameRingWriter &) = delete;
+
+  /**
+   * @brief Write a frame to the next slot
+   * @param frame the frame to write
+   */
+  void write(const LidarFrame & frame);
+
+  /**
+   * @brief Number of readers attached to the ring
+   */
+  uint32_t readers() const
+  {
+    return _header->readers.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Number of frames written
+   */
+  uint64_t written() const
+  {
+    return _written;
+  }
+
+private:
+  std::string _name;
+  uint8_t * _map;
+  std::size_t _map_size;
+  frame_ring::RingHeader * _header;
+  uint8_t * _slots;
+  uint64_t _written;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__FRAME_RING_WRITER_HPP_
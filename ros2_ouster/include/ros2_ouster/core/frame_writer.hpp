@@ -0,0 +1,180 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__FRAME_WRITER_HPP_
+#define ROS2_OUSTER__CORE__FRAME_WRITER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ros2_ouster/core/lidar_frame.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @brief File formats of ros2_ouster::FrameWriter
+ */
+enum class FrameFileFormat
+{
+  PCD,
+  PLY
+};
+
+/**
+ * @brief Parse a file format name, pcd or ply. Throws
+ * OusterDriverException if it is unknown.
+ */
+FrameFileFormat toFrameFileFormat(const std::string & name);
+
+/**
+ * @struct ros2_ouster::FrameWriterOptions
+ * @brief Where and how frames are written to files
+ */
+struct FrameWriterOptions
+{
+  std::string directory;                       // created if missing
+  FrameFileFormat format{FrameFileFormat::PCD};
+  std::size_t every{1};                        // write every Nth frame
+  bool direct_io{false};                       // bypass the page cache
+};
+
+/**
+ * @class ros2_ouster::FrameWriter
+ * @brief Writes frames to binary PCD or PLY files, one file per frame
+ * named after the frame timestamp and id, on a background thread.
+ *
+ * Frames are double buffered: writing a frame copies its points to the
+ * pending buffer, while the background thread writes the previous frame
+ * from its own buffer. A frame arriving while the pending buffer is still
+ * full is skipped and counted, so the caller never waits for the disk.
+ * Points are written ring by ring, as an organized cloud.
+ *
+ * With direct I/O, files are written past the page cache so that long
+ * collections do not evict everything else from memory. File systems not
+ * supporting it fall back to buffered writes.
+ */
+class FrameWriter
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::FrameWriter, creating the
+   * directory. Throws OusterDriverException if it cannot be created.
+   * @param directory directory of the files
+   * @param format format of the files
+   * @param direct_io whether to bypass the page cache
+   */
+  FrameWriter(const std::string & directory, FrameFileFormat format, bool direct_io);
+
+  /**
+   * @brief A destructor for ros2_ouster::FrameWriter, writing the pending
+   * frame before returning
+   */
+  ~FrameWriter();
+
+  FrameWriter(const FrameWriter &) = delete;
+  FrameWriter & operator=(const FrameWriter &) = delete;
+
+  /**
+   * @brief Queue a frame for writing
+   * @param frame the frame to write
+   * @return false if it was skipped, the previous frame still pending
+   */
+  bool write(const LidarFrame & frame);
+
+  /**
+   * @brief Number of files written
+   */
+  uint64_t written() const
+  {
+    return _written.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Number of frames skipped while the disk was busy
+   */
+  uint64_t skipped() const
+  {
+    return _skipped.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Number of files that failed to be written
+   */
+  uint64_t failed() const
+  {
+    return _failed.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Name of a frame's file, without the directory
+   * @param frame the frame
+   * @param format format of the file
+   */
+  static std::string fileName(const LidarFrame & frame, FrameFileFormat format);
+
+private:
+  // alignment of the buffer and of the sizes written with direct I/O
+  static constexpr std::size_t ALIGNMENT = 4096;
+
+  void worker();
+
+  /**
+   * @brief Serialize a frame to the buffer
+   * @return bytes of the file, 0 if the buffer could not be allocated
+   */
+  std::size_t serialize(const LidarFrame & frame);
+
+  /**
+   * @brief Write the buffer to a file, through a temporary file renamed
+   * once complete so that readers never see a partial file
+   */
+  bool writeFile(const std::string & path, std::size_t size);
+
+  /**
+   * @brief Grow the aligned buffer to hold a number of bytes
+   * @return false if it could not be allocated
+   */
+  bool reserve(std::size_t size);
+
+  std::string _directory;
+  FrameFileFormat _format;
+  bool _direct_io;
+
+  // buffer filled by write, handed to the background thread
+  LidarFrame _pending;
+  bool _has_pending;
+
+  // buffers of the background thread
+  LidarFrame _writing;
+  uint8_t * _buffer;
+  std::size_t _buffer_size;
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _stop;
+  std::thread _worker;
+
+  std::atomic<uint64_t> _written;
+  std::atomic<uint64_t> _skipped;
+  std::atomic<uint64_t> _failed;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__FRAME_WRITER_HPP_
@@ -0,0 +1,131 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__HEALTH_MONITOR_HPP_
+#define ROS2_OUSTER__CORE__HEALTH_MONITOR_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros2_ouster/core/latency_histogram.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @struct ros2_ouster::HealthThresholds
+ * @brief Limits beyond which the driver is reported unhealthy, checks with
+ * a limit of 0 are disabled but for the drop rates
+ */
+struct HealthThresholds
+{
+  double min_packet_rate{0.0};        // lidar packets per s
+  double min_frame_rate{0.0};         // frames per s
+  double min_completeness{0.95};      // ratio of the packets of the frames received
+  double max_kernel_drop_rate{0.0};   // packets per s dropped by the kernel
+  double max_user_drop_rate{0.0};     // outputs per s dropped as stale
+  double max_decode_time{0.001};      // 99th percentile decoding a packet, in s
+  double max_publish_time{0.02};      // 99th percentile publishing a message, in s
+};
+
+/**
+ * @struct ros2_ouster::HealthSample
+ * @brief The counters of the driver at some point
+ */
+struct HealthSample
+{
+  std::chrono::steady_clock::time_point time;
+  bool idle{false};
+  uint64_t lidar_packets{0};
+  uint64_t imu_packets{0};
+  uint64_t decoded_packets{0};
+  uint64_t frames{0};
+  uint64_t frame_packets{0};
+  uint64_t missing_packets{0};
+  uint64_t kernel_drops{0};
+  uint64_t user_drops{0};
+  LatencyHistogram::Snapshot decode;
+  LatencyHistogram::Snapshot publish;
+
+  /**
+   * @brief Take a sample of the statistics of the driver
+   * @param statistics the statistics the pipeline records to
+   * @param kernel_drops packets dropped by the kernel so far
+   * @param user_drops outputs dropped as stale so far
+   * @param idle whether the driver idles without subscribers
+   */
+  static HealthSample take(
+    const PipelineStatistics & statistics, uint64_t kernel_drops, uint64_t user_drops,
+    bool idle);
+};
+
+/**
+ * @brief Health levels, as those of diagnostic_msgs/DiagnosticStatus
+ */
+enum class HealthLevel : uint8_t
+{
+  OK = 0,
+  WARN = 1,
+  ERROR = 2,
+  STALE = 3
+};
+
+/**
+ * @struct ros2_ouster::HealthReport
+ * @brief Health of the driver over a period, with the rates and times
+ * measured as key values
+ */
+struct HealthReport
+{
+  HealthLevel level{HealthLevel::OK};
+  std::string message;
+  std::vector<std::pair<std::string, std::string>> values;
+};
+
+/**
+ * @class ros2_ouster::HealthMonitor
+ * @brief Checks the rates, frame completeness, drops and processing times
+ * of the driver against thresholds, over the period between samples
+ */
+class HealthMonitor
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::HealthMonitor
+   * @param thresholds limits beyond which a warning is reported
+   */
+  explicit HealthMonitor(const HealthThresholds & thresholds);
+
+  /**
+   * @brief Start a new period without reporting, e.g. on activation
+   * @param sample the counters at the start of the period
+   */
+  void restart(const HealthSample & sample);
+
+  /**
+   * @brief Report the health over the period since the previous sample
+   * @param sample the counters at the end of the period
+   */
+  HealthReport update(const HealthSample & sample);
+
+private:
+  HealthThresholds _thresholds;
+  HealthSample _last;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__HEALTH_MONITOR_HPP_
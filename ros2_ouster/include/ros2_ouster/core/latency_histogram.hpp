@@ -0,0 +1,299 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__LATENCY_HISTOGRAM_HPP_
+#define ROS2_OUSTER__CORE__LATENCY_HISTOGRAM_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros2_ouster/core/pipeline_counters.hpp"
+#include "ros2_ouster/core/resource_usage.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::LatencyHistogram
+ * @brief A histogram of durations in ns with buckets of constant relative
+ * width, as HdrHistogram: values below 64 ns have a bucket each, above
+ * each power of two is split in 64 buckets, so values are known within
+ * 1.6%. Values from 2^36 ns, about 69 s, fall in the last bucket.
+ *
+ * Recording is lock free, wait free but for the maximum, and can be done
+ * from any thread.
+ */
+class LatencyHistogram
+{
+public:
+  static constexpr unsigned SUB_BUCKET_BITS = 6;
+  static constexpr unsigned MAX_VALUE_BITS = 36;
+  static constexpr std::size_t SUB_BUCKETS = std::size_t(1) << SUB_BUCKET_BITS;
+  static constexpr std::size_t BUCKETS =
+    (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  /**
+   * @struct ros2_ouster::LatencyHistogram::Snapshot
+   * @brief The counts of a histogram at some point
+   */
+  struct Snapshot
+  {
+    std::vector<uint64_t> counts;
+    uint64_t count{0};
+    uint64_t sum{0};    // ns
+    uint64_t max{0};    // ns
+
+    /**
+     * @brief Mean in ns, 0 without values
+     */
+    double mean() const;
+
+    /**
+     * @brief Value below which a ratio of the values are, in ns: the
+     * middle of its bucket, at most the maximum. 0 without values.
+     * @param ratio in [0, 1], e.g. 0.99
+     */
+    uint64_t percentile(double ratio) const;
+
+    /**
+     * @brief The values recorded since an earlier snapshot. The maximum
+     * is the upper bound of the highest bucket, within the overall maximum.
+     * @param earlier snapshot of the same histogram taken before
+     */
+    Snapshot since(const Snapshot & earlier) const;
+  };
+
+  LatencyHistogram();
+
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram & operator=(const LatencyHistogram &) = delete;
+
+  /**
+   * @brief Record a duration, thread safe
+   * @param ns duration in ns
+   */
+  void record(uint64_t ns)
+  {
+    _counts[index(ns)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while (ns > max && !_max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  /**
+   * @brief Record the time elapsed since a start, thread safe
+   * @param start steady clock time the duration started
+   */
+  void record(std::chrono::steady_clock::time_point start)
+  {
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      elapsed).count()));
+  }
+
+  /**
+   * @brief Copy the counts. Values recorded meanwhile may be partly
+   * counted, e.g. in the count but not yet in a bucket.
+   */
+  Snapshot snapshot() const;
+
+  /**
+   * @brief Forget the values recorded. Values recorded meanwhile may be
+   * partly forgotten.
+   */
+  void reset();
+
+  /**
+   * @brief Bucket of a value
+   */
+  static std::size_t index(uint64_t ns)
+  {
+    if (ns < SUB_BUCKETS) {
+      return static_cast<std::size_t>(ns);
+    }
+    const unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(ns));
+    if (msb >= MAX_VALUE_BITS) {
+      return BUCKETS - 1;
+    }
+    // the value shifted to keep its top SUB_BUCKET_BITS + 1 bits
+    const unsigned shift = msb - SUB_BUCKET_BITS;
+    return shift * SUB_BUCKETS + static_cast<std::size_t>(ns >> shift);
+  }
+
+  /**
+   * @brief Lowest value of a bucket, in ns
+   */
+  static uint64_t lowest(std::size_t index);
+
+  /**
+   * @brief Highest value of a bucket, in ns
+   */
+  static uint64_t highest(std::size_t index);
+
+private:
+  std::unique_ptr<std::atomic<uint64_t>[]> _counts;
+  std::atomic<uint64_t> _count;
+  std::atomic<uint64_t> _sum;
+  std::atomic<uint64_t> _max;
+};
+
+/**
+ * @brief Stages a packet goes through from the socket to the published
+ * messages
+ */
+enum class PipelineStage : std::size_t
+{
+  RECEIVE = 0,      // from the kernel receiving the packet to the driver reading it
+  DECODE = 1,       // decoding a packet into the frame
+  ASSEMBLY = 2,     // from the kernel receiving the packet completing a frame
+                    // to the frame handed to the processors
+  CONVERSION = 3,   // filling a message from a frame or packet
+  PUBLISH = 4,      // publishing a message
+  COUNT = 5
+};
+
+/**
+ * @brief Name of a stage, lower case
+ */
+const char * toString(PipelineStage stage);
+
+/**
+ * @class ros2_ouster::PipelineStatistics
+ * @brief Latency histograms and CPU time and allocation totals of each
+ * stage of the pipeline and of each processor, and event counters,
+ * recorded to from any thread. Processors are registered before
+ * processing starts.
+ */
+class PipelineStatistics
+{
+public:
+  /**
+   * @brief Histogram of a stage
+   */
+  LatencyHistogram & stage(PipelineStage stage)
+  {
+    return _stages[static_cast<std::size_t>(stage)];
+  }
+
+  /**
+   * @brief Histogram of a stage
+   */
+  const LatencyHistogram & stage(PipelineStage stage) const
+  {
+    return _stages[static_cast<std::size_t>(stage)];
+  }
+
+  /**
+   * @brief Resource usage of a stage
+   */
+  ResourceUsage & stageUsage(PipelineStage stage)
+  {
+    return _stage_usage[static_cast<std::size_t>(stage)];
+  }
+
+  /**
+   * @brief Resource usage of a stage
+   */
+  const ResourceUsage & stageUsage(PipelineStage stage) const
+  {
+    return _stage_usage[static_cast<std::size_t>(stage)];
+  }
+
+  /**
+   * @brief Event counters, never reset
+   */
+  PipelineCounters & counters()
+  {
+    return _counters;
+  }
+
+  /**
+   * @brief Event counters, never reset
+   */
+  const PipelineCounters & counters() const
+  {
+    return _counters;
+  }
+
+  /**
+   * @brief Histogram of a processor, registered on the first call. Not
+   * thread safe, the histogram returned is.
+   * @param name name of the processor, processors of the same name share
+   * a histogram
+   */
+  LatencyHistogram & processor(const std::string & name);
+
+  /**
+   * @brief Resource usage of a processor, registered on the first call.
+   * Not thread safe, the usage returned is.
+   * @param name name of the processor, processors of the same name share
+   * their usage
+   */
+  ResourceUsage & processorUsage(const std::string & name);
+
+  /**
+   * @brief Names of the processors, in the order registered
+   */
+  std::vector<std::string> processors() const;
+
+  /**
+   * @brief Histogram of a processor registered, by its index in
+   * processors()
+   */
+  const LatencyHistogram & processorAt(std::size_t index) const
+  {
+    return *_processors[index].histogram;
+  }
+
+  /**
+   * @brief Resource usage of a processor registered, by its index in
+   * processors()
+   */
+  const ResourceUsage & processorUsageAt(std::size_t index) const
+  {
+    return *_processors[index].usage;
+  }
+
+  /**
+   * @brief Forget the values recorded by all histograms and usages,
+   * counters are kept
+   */
+  void reset();
+
+private:
+  struct Processor
+  {
+    std::string name;
+    std::unique_ptr<LatencyHistogram> histogram;
+    std::unique_ptr<ResourceUsage> usage;
+  };
+
+  Processor & find(const std::string & name);
+
+  LatencyHistogram _stages[static_cast<std::size_t>(PipelineStage::COUNT)];
+  ResourceUsage _stage_usage[static_cast<std::size_t>(PipelineStage::COUNT)];
+  std::vector<Processor> _processors;
+  PipelineCounters _counters;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__LATENCY_HISTOGRAM_HPP_
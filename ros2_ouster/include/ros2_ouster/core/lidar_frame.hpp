@@ -0,0 +1,81 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__LIDAR_FRAME_HPP_
+#define ROS2_OUSTER__CORE__LIDAR_FRAME_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @struct ros2_ouster::Packet
+ * @brief A packet read from the sensor
+ */
+struct Packet
+{
+  ClientState state;
+  uint8_t * data;
+  std::size_t size;
+  uint64_t receive_time;  // time received in ns since epoch, 0 if unknown
+};
+
+/**
+ * @struct ros2_ouster::LidarPoint
+ * @brief A single decoded return of the lidar
+ */
+struct LidarPoint
+{
+  float x;                // position in m
+  float y;                // position in m
+  float z;                // position in m
+  float intensity;        // intensity value from reading
+  uint32_t t;             // time in ns since the start of the frame
+  uint16_t reflectivity;  // reflectivity value from reading
+  uint8_t ring;           // ring ID the measurement came from
+  uint16_t noise;         // noise value from reading
+  uint32_t range;         // range in mm
+};
+
+/**
+ * @struct ros2_ouster::LidarFrame
+ * @brief One revolution of the lidar. Points are stored column major,
+ * height points per column, and only the first width columns are valid.
+ */
+struct LidarFrame
+{
+  uint64_t id{0};          // serial number of the frame
+  uint64_t timestamp{0};   // sensor time of the first packet in ns
+  uint64_t receive_time{0};  // time the last packet was received in ns since epoch
+  uint32_t width{0};       // number of valid columns
+  uint32_t height{0};      // number of rings
+  uint32_t packets{0};     // number of packets starting in the frame, each counted once
+  std::vector<LidarPoint> points;
+
+  /**
+   * @brief Number of valid points in the frame
+   */
+  std::size_t size() const
+  {
+    return static_cast<std::size_t>(width) * height;
+  }
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__LIDAR_FRAME_HPP_
@@ -0,0 +1,152 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__LOAD_CONTROLLER_HPP_
+#define ROS2_OUSTER__CORE__LOAD_CONTROLLER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::LoadController
+ * @brief Keeps the time spent decoding and processing frames within a CPU
+ * budget by shedding load in steps, and restores the outputs once the
+ * load dropped again. In order, the steps disable optional outputs such
+ * as images, keep every 2nd then every 4th column of a frame, and publish
+ * every 2nd frame only.
+ *
+ * Busy time is reported from any thread, the load is evaluated once per
+ * window. Load is shed one step per window while over budget, and restored
+ * one step after several consecutive windows well below budget, so the
+ * level does not oscillate around the budget.
+ */
+class LoadController
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief A constructor for ros2_ouster::LoadController
+   * @param budget CPU budget as a fraction of one core, e.g. 0.5
+   * @param window time over which the load is evaluated
+   */
+  explicit LoadController(
+    double budget,
+    std::chrono::nanoseconds window = std::chrono::seconds(1));
+
+  /**
+   * @brief Add time spent decoding or processing, thread safe
+   * @param busy time spent
+   */
+  void addBusyTime(std::chrono::nanoseconds busy)
+  {
+    _busy_ns.fetch_add(busy.count(), std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Count a completed frame, thread safe
+   */
+  void addFrame()
+  {
+    _frames.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Evaluate the load once the current window elapsed and change
+   * the level of load shedding if needed
+   * @param now current time
+   * @return true if the level changed, see describe()
+   */
+  bool update(Clock::time_point now = Clock::now());
+
+  /**
+   * @brief Whether optional outputs, such as images, are enabled
+   */
+  bool optionalOutputs() const
+  {
+    return level() < SHED_OPTIONAL;
+  }
+
+  /**
+   * @brief Keep only every n-th column of a frame
+   */
+  uint32_t columnDecimation() const
+  {
+    const unsigned l = level();
+    return l >= DECIMATE_4 ? 4 : (l >= DECIMATE_2 ? 2 : 1);
+  }
+
+  /**
+   * @brief Whether a frame is published at the current level
+   * @param frame_id serial number of the frame
+   */
+  bool publishFrame(uint64_t frame_id) const
+  {
+    return level() < HALF_RATE || frame_id % 2 == 0;
+  }
+
+  /**
+   * @brief Current level of load shedding, 0 when not shedding any load
+   */
+  unsigned level() const
+  {
+    return _level.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Load of the last evaluated window as a fraction of one core
+   */
+  double load() const
+  {
+    return _load;
+  }
+
+  /**
+   * @brief Describe the last evaluated window and the current level
+   */
+  std::string describe() const;
+
+private:
+  enum Level : unsigned
+  {
+    FULL = 0,
+    SHED_OPTIONAL = 1,
+    DECIMATE_2 = 2,
+    DECIMATE_4 = 3,
+    HALF_RATE = 4
+  };
+
+  // consecutive windows below the restore threshold before restoring
+  static constexpr unsigned CALM_WINDOWS = 3;
+  // fraction of the budget the load must drop below to restore
+  static constexpr double RESTORE_RATIO = 0.7;
+
+  double _budget;
+  std::chrono::nanoseconds _window;
+  Clock::time_point _window_start;
+  std::atomic<int64_t> _busy_ns;
+  std::atomic<uint64_t> _frames;
+  std::atomic<unsigned> _level;
+  unsigned _calm_windows;
+  double _load;
+  double _busy_per_frame_ms;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__LOAD_CONTROLLER_HPP_
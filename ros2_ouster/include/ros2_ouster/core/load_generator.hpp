@@ -0,0 +1,222 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__LOAD_GENERATOR_HPP_
+#define ROS2_OUSTER__CORE__LOAD_GENERATOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ros2_ouster/core/packet_generator.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::PacketSource
+ * @brief The lidar packets of one emulated sensor, with the times the
+ * sensor sends them
+ */
+class PacketSource
+{
+public:
+  virtual ~PacketSource() = default;
+
+  /**
+   * @brief Get the next packet
+   * @param size set to the size of the packet
+   * @param time set to the time the packet is sent, in ns of sensor time
+   * from the first packet
+   * @return the packet, valid until the next call
+   */
+  virtual const uint8_t * next(std::size_t & size, uint64_t & time) = 0;
+};
+
+/**
+ * @class ros2_ouster::SyntheticPacketSource
+ * @brief Packets of a synthetic sensor, see PacketGenerator
+ */
+class SyntheticPacketSource : public PacketSource
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::SyntheticPacketSource
+   * @param mdata metadata about the sensor
+   * @param scene what the sensor sees
+   * @param rotation_rate revolutions per second
+   * @param seed seed of the noise and dropouts of the scene
+   */
+  SyntheticPacketSource(
+    const Metadata & mdata, const SyntheticScene & scene, double rotation_rate, uint32_t seed);
+
+  const uint8_t * next(std::size_t & size, uint64_t & time) override;
+
+private:
+  PacketGenerator _generator;
+  std::vector<uint8_t> _packet;
+};
+
+/**
+ * @struct ros2_ouster::RecordedPackets
+ * @brief The lidar packets of a recording, loaded in memory to be shared
+ * by the sources replaying them
+ */
+struct RecordedPackets
+{
+  Metadata metadata;
+  std::vector<uint8_t> data;
+  std::vector<std::size_t> offsets;   // start of each packet in data, and end
+  std::vector<uint64_t> times;        // receive time from the first packet in ns
+  uint64_t period{0};                 // time from the first packet to the replay looping
+
+  /**
+   * @brief Load the lidar packets of a recording, plain or compressed.
+   * Throws OusterDriverException if it cannot be read or holds no lidar
+   * packets.
+   * @param path path of the recording
+   */
+  static std::shared_ptr<const RecordedPackets> load(const std::string & path);
+};
+
+/**
+ * @class ros2_ouster::RecordedPacketSource
+ * @brief Packets of a recording, replayed in a loop at the pace they were
+ * received
+ */
+class RecordedPacketSource : public PacketSource
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::RecordedPacketSource
+   * @param packets the packets to replay
+   */
+  explicit RecordedPacketSource(std::shared_ptr<const RecordedPackets> packets);
+
+  const uint8_t * next(std::size_t & size, uint64_t & time) override;
+
+private:
+  std::shared_ptr<const RecordedPackets> _packets;
+  std::size_t _index;
+  uint64_t _loop_time;        // time the current loop of the replay started
+};
+
+/**
+ * @struct ros2_ouster::LoadGeneratorOptions
+ * @brief Where and how packets are sent
+ */
+struct LoadGeneratorOptions
+{
+  std::string host{"127.0.0.1"};
+  int port{2368};             // destination port of the first sensor
+  int port_stride{1};         // added to the port for each further sensor
+  double rate{1.0};           // speed relative to the sensors
+  double jitter{0.0};         // standard deviation of the send times in s
+  double loss{0.0};           // ratio of packets not sent
+  double reorder{0.0};        // ratio of packets sent after the next one
+  uint32_t seed{0};
+};
+
+/**
+ * @struct ros2_ouster::LoadStatistics
+ * @brief Counters of the packets of a load generator
+ */
+struct LoadStatistics
+{
+  uint64_t sent{0};
+  uint64_t lost{0};           // not sent on purpose
+  uint64_t reordered{0};      // sent after the next one on purpose
+  uint64_t late{0};           // sent more than 1 ms after they were due
+  uint64_t errors{0};         // failed to send
+};
+
+/**
+ * @class ros2_ouster::LoadGenerator
+ * @brief Sends the lidar packets of several emulated sensors over UDP,
+ * each sensor to its own port, from a background thread.
+ *
+ * Packets are scheduled at absolute times from the start, so the packet
+ * rates are exact on average: a packet sent late, by the timer slack of
+ * the OS or a busy machine, does not delay the following ones. The
+ * sensors start evenly spread over a millisecond rather than all at
+ * once. Jitter, loss and reordering are drawn for each packet, reordering
+ * swaps a packet with the next of the same sensor.
+ */
+class LoadGenerator
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::LoadGenerator, opening a socket
+   * per sensor. Throws OusterDriverException if one cannot be opened or
+   * the host is not an IPv4 address.
+   * @param options where and how to send
+   * @param sources packets of each sensor
+   */
+  LoadGenerator(
+    const LoadGeneratorOptions & options, std::vector<std::unique_ptr<PacketSource>> sources);
+
+  /**
+   * @brief A destructor for ros2_ouster::LoadGenerator, stopping it
+   */
+  ~LoadGenerator();
+
+  LoadGenerator(const LoadGenerator &) = delete;
+  LoadGenerator & operator=(const LoadGenerator &) = delete;
+
+  /**
+   * @brief Start sending
+   */
+  void start();
+
+  /**
+   * @brief Stop sending, packets held for reordering are dropped
+   */
+  void stop();
+
+  /**
+   * @brief Counters so far, summed over the sensors
+   */
+  LoadStatistics statistics() const;
+
+  /**
+   * @brief Lidar packets sent per second over all sensors, on average
+   */
+  double packetRate() const;
+
+private:
+  struct Sensor;
+
+  void run();
+
+  LoadGeneratorOptions _options;
+  std::vector<std::unique_ptr<Sensor>> _sensors;
+  std::thread _thread;
+  std::atomic<bool> _running;
+
+  std::atomic<uint64_t> _sent;
+  std::atomic<uint64_t> _lost;
+  std::atomic<uint64_t> _reordered;
+  std::atomic<uint64_t> _late;
+  std::atomic<uint64_t> _errors;
+  std::chrono::steady_clock::time_point _started;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__LOAD_GENERATOR_HPP_
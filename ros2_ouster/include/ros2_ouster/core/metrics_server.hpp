@@ -0,0 +1,114 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__METRICS_SERVER_HPP_
+#define ROS2_OUSTER__CORE__METRICS_SERVER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ros2_ouster/core/latency_histogram.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::MetricsServer
+ * @brief Serves the counters and latency histograms of the driver over
+ * HTTP on localhost, in the Prometheus text exposition format, from a
+ * thread of its own.
+ *
+ * Scrapes only read the atomic counters and histograms the pipeline
+ * records to, the pipeline does no more work for being scraped. Requests
+ * are served one at a time, for a scraper rather than for many clients.
+ */
+class MetricsServer
+{
+public:
+  using CounterCallback = std::function<uint64_t()>;
+
+  /**
+   * @brief A constructor for ros2_ouster::MetricsServer, listening on
+   * 127.0.0.1. Throws OusterDriverException if the port cannot be bound.
+   * @param statistics statistics of the driver, must outlive the server
+   * @param port TCP port to listen on
+   */
+  MetricsServer(const PipelineStatistics & statistics, int port);
+
+  /**
+   * @brief A destructor for ros2_ouster::MetricsServer, stopping it
+   */
+  ~MetricsServer();
+
+  MetricsServer(const MetricsServer &) = delete;
+  MetricsServer & operator=(const MetricsServer &) = delete;
+
+  /**
+   * @brief Serve a further counter, before starting
+   * @param name name of the metric, without the ouster_ prefix and
+   * _total suffix
+   * @param help description of the metric
+   * @param read returns the counter, called from the server thread so
+   * it must be thread safe, e.g. read an atomic
+   */
+  void addCounter(const std::string & name, const std::string & help, CounterCallback read);
+
+  /**
+   * @brief Start serving
+   */
+  void start();
+
+  /**
+   * @brief Stop serving, within a fraction of a second
+   */
+  void stop();
+
+  /**
+   * @brief The metrics in the Prometheus text exposition format
+   */
+  std::string render() const;
+
+  /**
+   * @brief Port listened on
+   */
+  int port() const
+  {
+    return _port;
+  }
+
+private:
+  struct Counter
+  {
+    std::string name;
+    std::string help;
+    CounterCallback read;
+  };
+
+  void run();
+  void serve(int fd);
+
+  const PipelineStatistics & _statistics;
+  std::vector<Counter> _counters;
+  int _port;
+  int _fd;
+  std::atomic<bool> _running;
+  std::thread _thread;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__METRICS_SERVER_HPP_
@@ -0,0 +1,137 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__OUSTER_CORE_HPP_
+#define ROS2_OUSTER__CORE__OUSTER_CORE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "ros2_ouster/core/frame_decoder.hpp"
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/interfaces/configuration.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+#include "ros2_ouster/interfaces/sensor_interface.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::OusterCore
+ * @brief Receives packets from a sensor and assembles them into frames,
+ * without any dependency on ROS. Meant to be embedded in the process
+ * consuming the data: packets and frames are handed to callbacks on the
+ * thread calling poll(), nothing is copied or serialized.
+ *
+ * Data handed to a callback is only valid for the duration of the call,
+ * except for frames which stay valid until the next frame completes.
+ */
+class OusterCore
+{
+public:
+  using PacketCallback = std::function<void (const Packet &)>;
+  using FrameCallback = FrameDecoder::FrameCallback;
+
+  /**
+   * @brief A constructor for ros2_ouster::OusterCore
+   * @param sensor the sensor to receive packets from
+   */
+  explicit OusterCore(std::unique_ptr<SensorInterface> sensor);
+
+  /**
+   * @brief A destructor for ros2_ouster::OusterCore
+   */
+  ~OusterCore();
+
+  OusterCore(const OusterCore &) = delete;
+  OusterCore & operator=(const OusterCore &) = delete;
+
+  /**
+   * @brief Connect to the sensor and prepare decoding of its packets
+   * @param config configuration of the connection to the sensor
+   * @param mdata metadata about the sensor
+   */
+  void configure(const Configuration & config, const Metadata & mdata);
+
+  /**
+   * @brief Reconnect to the sensor, dropping the partially assembled frame
+   * @param config configuration of the connection to the sensor
+   */
+  void reset(const Configuration & config);
+
+  /**
+   * @brief Set the function called with every packet received,
+   * lidar and IMU alike
+   * @param callback the function to call
+   */
+  void setPacketCallback(PacketCallback callback);
+
+  /**
+   * @brief Set the function called with every completed frame. Lidar
+   * packets are only decoded while a frame callback is set.
+   * @param callback the function to call
+   */
+  void setFrameCallback(FrameCallback callback);
+
+  /**
+   * @brief Switch in or out of idle mode. While idle poll() must not be
+   * called, packets are discarded by the sensor connection as cheaply as
+   * possible. On resume stale packets and the partially assembled frame
+   * are dropped.
+   * @param idle true to enter idle mode
+   */
+  void setIdle(bool idle);
+
+  /**
+   * @brief Discard all packets queued, without reading them
+   * @return number of packets discarded
+   */
+  std::size_t drain();
+
+  /**
+   * @brief Packets dropped by the kernel for lack of buffer space, but for
+   * drops while idle, thread safe
+   * @return total since construction, 0 if the sensor does not report them
+   */
+  uint64_t kernelDrops() const;
+
+  /**
+   * @brief Wait for the next packet from the sensor and dispatch it
+   * to the callbacks. Throws OusterDriverException on sensor errors.
+   * @return the state of the sensor, TIMEOUT if no packet was read
+   */
+  ClientState poll();
+
+  /**
+   * @brief The frame decoder, valid once configured
+   */
+  FrameDecoder * decoder()
+  {
+    return _decoder.get();
+  }
+
+private:
+  std::unique_ptr<SensorInterface> _sensor;
+  std::unique_ptr<FrameDecoder> _decoder;
+  PacketCallback _packet_callback;
+  FrameCallback _frame_callback;
+  std::size_t _lidar_packet_size;
+  std::size_t _imu_packet_size;
+  uint64_t _packets;    // packets read so far
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__OUSTER_CORE_HPP_
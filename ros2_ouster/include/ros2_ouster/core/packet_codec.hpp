@@ -0,0 +1,101 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__PACKET_CODEC_HPP_
+#define ROS2_OUSTER__CORE__PACKET_CODEC_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::PacketCodec
+ * @brief Lossless compression of blocks of raw packets for
+ * CompressedRecorder and CompressedReader.
+ *
+ * A block is given as records: a recording::RecordHeader followed by the
+ * packet, without padding. Before zlib runs at its fastest level, the
+ * block is rearranged into planes: the headers field by field, then every
+ * field of the lidar packets across the packets of the block, azimuths,
+ * timestamps and distances as deltas to the previous value of the same
+ * laser, and multi-byte values split into a plane per byte. Slowly
+ * changing bytes end up next to each other, which a general purpose
+ * coder compresses far better than the interleaved packets. Other
+ * packets, such as IMU packets, are kept as they are.
+ */
+class PacketCodec
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::PacketCodec
+   * @param mdata metadata about the sensor, giving the packet layout
+   */
+  explicit PacketCodec(const Metadata & mdata);
+
+  /**
+   * @brief Compress a block of records
+   * @param records the records of the block
+   * @param size bytes of records
+   * @param count number of records
+   * @param compressed set to the zlib stream
+   * @return bytes of planes, needed to decompress the block
+   */
+  std::size_t compress(
+    const uint8_t * records, std::size_t size, std::size_t count,
+    std::vector<uint8_t> & compressed);
+
+  /**
+   * @brief Decompress a block of records
+   * @param compressed the zlib stream
+   * @param size bytes of the zlib stream
+   * @param count number of records
+   * @param encoded_size bytes of planes, as returned by compress
+   * @param records set to the records of the block
+   * @return false if the block is corrupted
+   */
+  bool decompress(
+    const uint8_t * compressed, std::size_t size, std::size_t count,
+    std::size_t encoded_size, std::vector<uint8_t> & records);
+
+private:
+  /**
+   * @brief Move the records to or from planes
+   */
+  template<bool Encode>
+  bool transcode(uint8_t * records, std::size_t count, uint8_t * planes, std::size_t size);
+
+  template<bool Encode>
+  void transcodeOLE3DV2(uint8_t * packet, uint8_t * planes, std::size_t index, std::size_t count);
+
+  template<bool Encode>
+  void transcodeOLE2DV2(uint8_t * packet, uint8_t * planes, std::size_t index, std::size_t count);
+
+  bool _is_3d;
+  std::size_t _lidar_size;     // size of the lidar packets rearranged, 0 for none
+  std::vector<uint8_t> _planes;
+
+  // previous values within the block
+  uint16_t _azimuth_last;
+  uint16_t _distance_last[16];
+  uint16_t _intensity_last;
+  uint32_t _ts_last;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__PACKET_CODEC_HPP_
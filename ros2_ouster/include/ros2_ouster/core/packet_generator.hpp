@@ -0,0 +1,184 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__PACKET_GENERATOR_HPP_
+#define ROS2_OUSTER__CORE__PACKET_GENERATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @struct ros2_ouster::SyntheticPlane
+ * @brief An infinite plane, the points p with normal . p = offset, in m
+ */
+struct SyntheticPlane
+{
+  double normal[3];
+  double offset;
+  float intensity;
+};
+
+/**
+ * @struct ros2_ouster::SyntheticBox
+ * @brief An axis aligned box, in m
+ */
+struct SyntheticBox
+{
+  double min[3];
+  double max[3];
+  float intensity;
+};
+
+/**
+ * @struct ros2_ouster::SyntheticScene
+ * @brief Surfaces seen by a synthetic sensor, in the frame of the sensor,
+ * and the imperfections of its returns
+ */
+struct SyntheticScene
+{
+  std::vector<SyntheticPlane> planes;
+  std::vector<SyntheticBox> boxes;
+  double range_noise{0.0};    // standard deviation of the ranges in m
+  double dropout{0.0};        // ratio of returns missing
+  double max_range{100.0};    // surfaces further away return nothing, in m
+
+  /**
+   * @brief A room of 20 by 16 m with the sensor 1 m above the floor, a
+   * ceiling 3 m above and a few boxes around
+   */
+  static SyntheticScene room();
+};
+
+/**
+ * @brief Metadata of a typical sensor of a format, for a synthetic sensor
+ * when no calibration is at hand: lasers 2 degrees apart from -15 degrees
+ * up, without offsets
+ * @param lidar_vendor the format, OLE_3D_V2 or OLE_2D_V2
+ */
+Metadata syntheticMetadata(const std::string & lidar_vendor);
+
+/**
+ * @class ros2_ouster::PacketGenerator
+ * @brief Generates valid lidar packets of a synthetic sensor looking at a
+ * synthetic scene, for tests, benchmarks and a fake sensor. Supports the
+ * OLE_3D_V2 and OLE_2D_V2 packet formats.
+ *
+ * The sensor spins at a constant rotation rate, starting at azimuth 0 and
+ * sensor time 0. Azimuths and timestamps progress as with a real sensor,
+ * and the returns are cast with the geometry FrameDecoder uses, so that
+ * decoded points lie on the surfaces of the scene up to the range
+ * resolution and the noise.
+ */
+class PacketGenerator
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::PacketGenerator
+   * @param mdata metadata about the sensor: format and vertical angles
+   * and offsets of the lasers
+   * @param scene what the sensor sees
+   * @param rotation_rate revolutions per second
+   * @param columns columns of a revolution, 0 for the default of the
+   * format: 2000 for OLE_3D_V2, a multiple of 2, and 1600 for OLE_2D_V2
+   * @param seed seed of the noise and the dropouts
+   */
+  PacketGenerator(
+    const Metadata & mdata, const SyntheticScene & scene, double rotation_rate = 10.0,
+    uint32_t columns = 0, uint32_t seed = 0);
+
+  /**
+   * @brief Size of the packets generated
+   */
+  std::size_t packetSize() const;
+
+  /**
+   * @brief Packets generated per second of sensor time
+   */
+  double packetRate() const;
+
+  /**
+   * @brief Packets per revolution, rounded up
+   */
+  std::size_t packetsPerRevolution() const;
+
+  /**
+   * @brief Sensor time of the next packet in ns, from the first packet
+   */
+  uint64_t time() const;
+
+  /**
+   * @brief Generate the next packet
+   * @param packet buffer of packetSize() bytes to write it to
+   */
+  void next(uint8_t * packet);
+
+  /**
+   * @brief Skip packets, without generating them
+   * @param count number of packets to skip
+   */
+  void skip(std::size_t count = 1);
+
+  /**
+   * @brief Restart from azimuth 0 and sensor time 0
+   */
+  void reset();
+
+private:
+  /**
+   * @brief Range to the nearest surface along a ray
+   * @param origin start of the ray
+   * @param direction unit direction of the ray
+   * @param intensity set to the intensity of the surface hit
+   * @return range in m, or a negative value if nothing was hit or the
+   * return dropped out
+   */
+  double cast(const double origin[3], const double direction[3], float & intensity);
+
+  void next3D(uint8_t * packet);
+  void next2D(uint8_t * packet);
+
+  /**
+   * @brief Azimuth of a block or return, in 0.01 degrees
+   * @param index index of the block or return since the start
+   */
+  uint16_t azimuth(uint64_t index) const;
+
+  bool _is_3d;
+  SyntheticScene _scene;
+  double _rotation_rate;
+  uint32_t _units;            // blocks (OLE_3D_V2) or returns (OLE_2D_V2) per revolution
+  uint32_t _units_per_packet;
+
+  std::vector<double> _sin_av;
+  std::vector<double> _cos_av;
+  std::vector<double> _x_offset;
+  std::vector<double> _y_offset;
+
+  uint32_t _seed;
+  std::mt19937 _random;
+  std::normal_distribution<double> _noise;
+  std::uniform_real_distribution<double> _uniform;
+  uint64_t _packet;               // index of the next packet
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__PACKET_GENERATOR_HPP_
@@ -0,0 +1,80 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__PACKET_LOSS_ESTIMATOR_HPP_
+#define ROS2_OUSTER__CORE__PACKET_LOSS_ESTIMATOR_HPP_
+
+#include <cstdint>
+
+#include "ros2_ouster/core/frame_decoder.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::PacketLossEstimator
+ * @brief Estimates lidar packets lost from gaps in the azimuths: consecutive
+ * packets advance by a steady azimuth step, learnt from the packets, a
+ * much larger advance means packets were lost in between.
+ */
+class PacketLossEstimator
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::PacketLossEstimator
+   * @param is_3d true for the OLE_3D_V2 packet format, false for OLE_2D_V2
+   */
+  explicit PacketLossEstimator(bool is_3d)
+  : _is_3d(is_3d), _azimuth_last(-1), _azimuth_step(0.0)
+  {
+  }
+
+  /**
+   * @brief Account for the next lidar packet
+   * @param packet the packet data
+   * @return estimated number of packets lost right before this one
+   */
+  double update(const uint8_t * packet)
+  {
+    double lost = 0.0;
+    const int32_t azimuth = FrameDecoder::firstAzimuth(packet, _is_3d);
+    if (azimuth >= 0 && _azimuth_last >= 0) {
+      const double advance = (azimuth - _azimuth_last + 36000) % 36000;
+      if (_azimuth_step > 0.0 && advance > 1.5 * _azimuth_step) {
+        lost = advance / _azimuth_step - 1.0;
+      } else if (advance > 0.0) {
+        _azimuth_step = _azimuth_step == 0.0 ? advance : 0.9 * _azimuth_step + 0.1 * advance;
+      }
+    }
+    _azimuth_last = azimuth;
+    return lost;
+  }
+
+  /**
+   * @brief Forget the last packet, after packets were skipped on purpose,
+   * so that the gap is not taken for packet loss
+   */
+  void restart()
+  {
+    _azimuth_last = -1;
+  }
+
+private:
+  bool _is_3d;
+  int32_t _azimuth_last;    // azimuth of the first column of the last packet
+  double _azimuth_step;     // running mean of the advance between packets
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__PACKET_LOSS_ESTIMATOR_HPP_
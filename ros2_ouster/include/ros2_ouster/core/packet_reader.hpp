@@ -0,0 +1,147 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__PACKET_READER_HPP_
+#define ROS2_OUSTER__CORE__PACKET_READER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/core/recording_format.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::PacketReader
+ * @brief Reads a recording written by PacketRecorder, see
+ * recording_format.hpp, including one cut short by a crash. The file is
+ * mapped, packets are handed out from the mapping without copies. Seeking
+ * to a time is a binary search in the frame index.
+ */
+class PacketReader
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::PacketReader, opening the file.
+   * Throws OusterDriverException if it is not a valid recording.
+   * @param path path of the recording
+   */
+  explicit PacketReader(const std::string & path);
+
+  /**
+   * @brief A destructor for ros2_ouster::PacketReader
+   */
+  ~PacketReader();
+
+  PacketReader(const PacketReader &) = delete;
+  PacketReader & operator=(const PacketReader &) = delete;
+
+  /**
+   * @brief Metadata about the sensor recorded
+   */
+  const Metadata & metadata() const
+  {
+    return _metadata;
+  }
+
+  /**
+   * @brief Read the next packet
+   * @param packet set to the packet, its data stays valid as long as
+   * the reader
+   * @return false at the end of the recording
+   */
+  bool next(Packet & packet);
+
+  /**
+   * @brief Position the reader at the start of the frame received at a
+   * given time, the first frame if earlier than the recording
+   * @param time receive time in ns since epoch
+   * @return index of the frame
+   */
+  std::size_t seek(uint64_t time);
+
+  /**
+   * @brief Position the reader at the start of a frame
+   * @param frame index of the frame, the end of the recording if past
+   * the last frame
+   */
+  void seekFrame(std::size_t frame);
+
+  /**
+   * @brief Number of frames in the recording
+   */
+  std::size_t frames() const
+  {
+    return _frames;
+  }
+
+  /**
+   * @brief Number of packets in the recording
+   */
+  uint64_t packets() const
+  {
+    return _header->packet_count;
+  }
+
+  /**
+   * @brief Receive time of the start of a frame in ns since epoch
+   * @param frame index of the frame
+   */
+  uint64_t frameTime(std::size_t frame) const
+  {
+    return _index[frame].time;
+  }
+
+  /**
+   * @brief Receive time of the first packet in ns since epoch
+   */
+  uint64_t startTime() const
+  {
+    return _header->first_time;
+  }
+
+  /**
+   * @brief Receive time of the last packet in ns since epoch
+   */
+  uint64_t endTime() const
+  {
+    return _header->last_time;
+  }
+
+  /**
+   * @brief Whether the recording was closed, rather than cut short
+   */
+  bool complete() const
+  {
+    return _header->complete != 0;
+  }
+
+private:
+  uint8_t * _map;
+  std::size_t _map_size;
+  const recording::RecordingHeader * _header;
+  uint8_t * _data;
+  std::size_t _data_size;
+  const recording::FrameIndexEntry * _index;
+  std::size_t _frames;
+  std::size_t _offset;      // offset of the next record from the data offset
+  Metadata _metadata;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__PACKET_READER_HPP_
@@ -0,0 +1,122 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__PACKET_RECORDER_HPP_
+#define ROS2_OUSTER__CORE__PACKET_RECORDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/core/recording_format.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::PacketRecorder
+ * @brief Records raw packets with their receive times to a file, see
+ * recording_format.hpp. The file is preallocated to its full size and
+ * mapped, so recording a packet is a copy to memory, without any system
+ * call: the kernel writes the pages back in the background. Once the file
+ * is full further packets are dropped and counted.
+ *
+ * Not thread safe, meant to be called from the thread receiving packets.
+ */
+class PacketRecorder
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::PacketRecorder, creating the
+   * file. Throws OusterDriverException if it cannot be created.
+   * @param path path of the file, replaced if it exists
+   * @param mdata metadata about the sensor, stored in the file
+   * @param capacity bytes available for packets
+   */
+  PacketRecorder(const std::string & path, const Metadata & mdata, std::size_t capacity);
+
+  /**
+   * @brief A destructor for ros2_ouster::PacketRecorder, closing the file
+   */
+  ~PacketRecorder();
+
+  PacketRecorder(const PacketRecorder &) = delete;
+  PacketRecorder & operator=(const PacketRecorder &) = delete;
+
+  /**
+   * @brief Record a packet
+   * @param packet the packet to record
+   * @return false if it was dropped because the file is full
+   */
+  bool write(const Packet & packet);
+
+  /**
+   * @brief Finish the recording: move the frame index after the last
+   * packet and shrink the file to what was recorded
+   */
+  void close();
+
+  /**
+   * @brief Number of packets recorded
+   */
+  uint64_t packets() const
+  {
+    return _header ? _header->packet_count : _packets;
+  }
+
+  /**
+   * @brief Number of frames recorded
+   */
+  uint64_t frames() const
+  {
+    return _header ? _header->frame_count : _frames;
+  }
+
+  /**
+   * @brief Number of packets dropped because the file is full
+   */
+  uint64_t dropped() const
+  {
+    return _dropped;
+  }
+
+  /**
+   * @brief Path of the file
+   */
+  const std::string & path() const
+  {
+    return _path;
+  }
+
+private:
+  std::string _path;
+  int _fd;
+  uint8_t * _map;
+  std::size_t _map_size;
+  recording::RecordingHeader * _header;
+  uint8_t * _data;
+  recording::FrameIndexEntry * _index;
+
+  bool _is_3d;
+  int32_t _azimuth_last;
+  bool _frame_start;        // the next lidar packet starts a frame
+  uint64_t _packets;
+  uint64_t _frames;
+  uint64_t _dropped;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__PACKET_RECORDER_HPP_
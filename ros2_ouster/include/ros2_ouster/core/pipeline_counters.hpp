@@ -0,0 +1,95 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__PIPELINE_COUNTERS_HPP_
+#define ROS2_OUSTER__CORE__PIPELINE_COUNTERS_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ros2_ouster
+{
+
+/**
+ * @brief Events counted along the pipeline
+ */
+enum class PipelineCounter : std::size_t
+{
+  LIDAR_PACKETS = 0,    // lidar packets read from the sensor
+  IMU_PACKETS = 1,      // IMU packets read from the sensor
+  DECODED_PACKETS = 2,  // lidar packets decoded into frames
+  FRAMES = 3,           // frames completed
+  FRAME_PACKETS = 4,    // lidar packets of the frames completed
+  MISSING_PACKETS = 5,  // lidar packets estimated missing from the frames completed
+  COUNT = 6
+};
+
+/**
+ * @brief Name of a counter, lower case
+ */
+const char * toString(PipelineCounter counter);
+
+/**
+ * @class ros2_ouster::PipelineCounters
+ * @brief Monotonic event counters, incremented from any thread without
+ * contention: each thread adds to a slot of its own, on a cache line of
+ * its own, and readers sum the slots. Counters are never reset, readers
+ * take differences.
+ */
+class PipelineCounters
+{
+public:
+  // threads beyond this share slots, still correctly but contended
+  static constexpr std::size_t SLOTS = 16;
+
+  PipelineCounters();
+
+  PipelineCounters(const PipelineCounters &) = delete;
+  PipelineCounters & operator=(const PipelineCounters &) = delete;
+
+  /**
+   * @brief Add to a counter, lock free and thread safe
+   * @param counter the counter to add to
+   * @param count the amount to add
+   */
+  void add(PipelineCounter counter, uint64_t count = 1)
+  {
+    slot().values[static_cast<std::size_t>(counter)].fetch_add(
+      count, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Total of a counter over all threads
+   */
+  uint64_t total(PipelineCounter counter) const;
+
+private:
+  struct alignas(64) Slot
+  {
+    std::atomic<uint64_t> values[static_cast<std::size_t>(PipelineCounter::COUNT)];
+  };
+
+  /**
+   * @brief Slot of the calling thread, assigned on its first call
+   */
+  Slot & slot();
+
+  Slot _slots[SLOTS];
+  std::atomic<std::size_t> _next_slot;
+  uint64_t _id;   // unique among instances, as addresses can be reused
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__PIPELINE_COUNTERS_HPP_
@@ -0,0 +1,143 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__RECORDING_FORMAT_HPP_
+#define ROS2_OUSTER__CORE__RECORDING_FORMAT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ros2_ouster/interfaces/metadata.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * Layout of a packet recording file, all integers in host byte order:
+ *
+ *   RecordingHeader
+ *   metadata of the sensor as JSON, padded to 8 bytes
+ *   records: RecordHeader followed by the packet, padded to 8 bytes
+ *   frame index: one FrameIndexEntry per frame, by increasing time
+ *
+ * The file is preallocated and written through a shared mapping, the
+ * header counters are updated after every packet so that a recording cut
+ * short by a crash stays readable up to its last packet.
+ */
+namespace recording
+{
+
+constexpr char MAGIC[8] = {'O', 'U', 'S', 'T', 'R', 'E', 'C', '1'};
+constexpr uint32_t VERSION = 1;
+
+/**
+ * @brief Header at the start of a recording
+ */
+struct RecordingHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t metadata_size;     // bytes of JSON metadata, excluding padding
+  uint64_t data_offset;       // offset of the first record
+  uint64_t data_capacity;     // bytes available for records
+  uint64_t data_size;         // bytes of records written
+  uint64_t index_offset;      // offset of the frame index
+  uint64_t index_capacity;    // entries available in the frame index
+  uint64_t frame_count;       // entries written in the frame index
+  uint64_t packet_count;      // records written
+  uint64_t first_time;        // receive time of the first packet in ns
+  uint64_t last_time;         // receive time of the last packet in ns
+  uint32_t complete;          // 1 once the recording was closed
+  uint32_t reserved;
+};
+
+/**
+ * @brief Header of a recorded packet
+ */
+struct RecordHeader
+{
+  uint64_t receive_time;      // ns since epoch
+  uint32_t size;              // bytes of the packet following
+  uint32_t state;             // ClientState of the packet
+};
+
+/**
+ * @brief Start of a frame in the records
+ */
+struct FrameIndexEntry
+{
+  uint64_t time;              // receive time of the first packet of the frame
+  uint64_t offset;            // offset of its record from the data offset
+};
+
+/**
+ * Layout of a compressed packet recording file, written as a stream:
+ *
+ *   CompressedHeader
+ *   metadata of the sensor as JSON
+ *   blocks: BlockHeader followed by a zlib stream
+ *
+ * Each block is a run of packets, stored as planes of like bytes and
+ * deltas so that zlib finds long matches, see PacketCodec. Blocks are
+ * independent: a recording cut short by a crash stays readable up to its
+ * last complete block.
+ */
+constexpr char COMPRESSED_MAGIC[8] = {'O', 'U', 'S', 'T', 'R', 'E', 'C', 'Z'};
+constexpr uint32_t COMPRESSED_VERSION = 1;
+
+/**
+ * @brief Header at the start of a compressed recording
+ */
+struct CompressedHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t metadata_size;     // bytes of JSON metadata
+};
+
+/**
+ * @brief Header of a block of a compressed recording
+ */
+struct BlockHeader
+{
+  uint32_t packet_count;      // packets in the block
+  uint32_t encoded_size;      // bytes of the planes once decompressed
+  uint32_t compressed_size;   // bytes of the zlib stream following
+  uint32_t reserved;
+};
+
+/**
+ * @brief Size of a record holding a packet of a given size
+ */
+inline std::size_t recordSize(std::size_t packet_size)
+{
+  return (sizeof(RecordHeader) + packet_size + 7) & ~static_cast<std::size_t>(7);
+}
+
+/**
+ * @brief Serialize sensor metadata to JSON
+ */
+std::string metadataToJson(const Metadata & mdata);
+
+/**
+ * @brief Parse sensor metadata from JSON. Throws OusterDriverException
+ * if it is malformed.
+ */
+Metadata metadataFromJson(const std::string & json);
+
+}  // namespace recording
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__RECORDING_FORMAT_HPP_
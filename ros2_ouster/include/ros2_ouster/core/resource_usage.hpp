@@ -0,0 +1,114 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__RESOURCE_USAGE_HPP_
+#define ROS2_OUSTER__CORE__RESOURCE_USAGE_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+namespace ros2_ouster
+{
+
+/**
+ * @struct ros2_ouster::ResourceSample
+ * @brief CPU time and heap allocations of the calling thread so far, the
+ * difference of two samples on a thread being those of the work between
+ */
+struct ResourceSample
+{
+  uint64_t cpu_time{0};         // ns, CLOCK_THREAD_CPUTIME_ID
+  uint64_t allocations{0};      // calls to operator new
+  uint64_t allocated_bytes{0};  // bytes requested from operator new
+
+  /**
+   * @brief Sample the calling thread. Allocations stay 0 unless built
+   * with ROS2_OUSTER_ALLOCATION_COUNTING.
+   */
+  static ResourceSample now();
+};
+
+/**
+ * @brief Whether heap allocations are counted, i.e. the driver was built
+ * with the ROS2_OUSTER_ALLOCATION_COUNTING CMake option and the process
+ * uses the operator new of the core library rather than libstdc++'s
+ */
+bool allocationsCounted();
+
+/**
+ * @class ros2_ouster::ResourceUsage
+ * @brief Totals of the CPU time and heap allocations of a stage or
+ * processor, recorded to from any thread
+ */
+class ResourceUsage
+{
+public:
+  /**
+   * @struct ros2_ouster::ResourceUsage::Totals
+   * @brief The totals of a usage at some point
+   */
+  struct Totals
+  {
+    uint64_t calls{0};
+    uint64_t cpu_time{0};         // ns
+    uint64_t allocations{0};
+    uint64_t allocated_bytes{0};
+
+    /**
+     * @brief The usage recorded since earlier totals
+     * @param earlier totals of the same usage taken before
+     */
+    Totals since(const Totals & earlier) const;
+  };
+
+  ResourceUsage();
+
+  ResourceUsage(const ResourceUsage &) = delete;
+  ResourceUsage & operator=(const ResourceUsage &) = delete;
+
+  /**
+   * @brief Record the usage of the calling thread since a sample, thread
+   * safe
+   * @param start sample taken on the calling thread when the work started
+   * @param calls calls the work counts as, 0 to add to those recorded
+   */
+  void record(const ResourceSample & start, uint64_t calls = 1)
+  {
+    const ResourceSample end = ResourceSample::now();
+    _calls.fetch_add(calls, std::memory_order_relaxed);
+    _cpu_time.fetch_add(end.cpu_time - start.cpu_time, std::memory_order_relaxed);
+    _allocations.fetch_add(end.allocations - start.allocations, std::memory_order_relaxed);
+    _allocated_bytes.fetch_add(
+      end.allocated_bytes - start.allocated_bytes, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Read the totals
+   */
+  Totals totals() const;
+
+  /**
+   * @brief Forget the usage recorded
+   */
+  void reset();
+
+private:
+  std::atomic<uint64_t> _calls;
+  std::atomic<uint64_t> _cpu_time;
+  std::atomic<uint64_t> _allocations;
+  std::atomic<uint64_t> _allocated_bytes;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__CORE__RESOURCE_USAGE_HPP_
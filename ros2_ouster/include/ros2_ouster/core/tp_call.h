@@ -0,0 +1,123 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// LTTng-UST tracepoint provider of the driver, as those of ros2_tracing.
+// Only included when built with ROS2_OUSTER_TRACING, use the macros of
+// ros2_ouster/core/tracing.hpp rather than this header.
+
+#undef TRACEPOINT_PROVIDER
+#define TRACEPOINT_PROVIDER ros2_ouster
+
+#undef TRACEPOINT_INCLUDE
+#define TRACEPOINT_INCLUDE "ros2_ouster/core/tp_call.h"
+
+#if !defined(ROS2_OUSTER__CORE__TP_CALL_H_) || defined(TRACEPOINT_HEADER_MULTI_READ)
+#define ROS2_OUSTER__CORE__TP_CALL_H_
+
+#include <lttng/tracepoint.h>
+
+#include <stdint.h>
+
+// a packet read from the sensor
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  packet_receive,
+  TP_ARGS(
+    int, state_arg,
+    uint64_t, packet_count_arg,
+    uint32_t, size_arg,
+    uint64_t, receive_time_arg
+  ),
+  TP_FIELDS(
+    ctf_integer(int, state, state_arg)
+    ctf_integer(uint64_t, packet_count, packet_count_arg)
+    ctf_integer(uint32_t, size, size_arg)
+    ctf_integer(uint64_t, receive_time, receive_time_arg)
+  )
+)
+
+// decoding a lidar packet, with the frame being assembled and its packets
+// so far, counting this one. At the end, those after the packet: once it
+// completed a frame, the next one with no packet yet.
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  decode_start,
+  TP_ARGS(
+    uint64_t, frame_id_arg,
+    uint32_t, packet_count_arg
+  ),
+  TP_FIELDS(
+    ctf_integer(uint64_t, frame_id, frame_id_arg)
+    ctf_integer(uint32_t, packet_count, packet_count_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  decode_end,
+  TP_ARGS(
+    uint64_t, frame_id_arg,
+    uint32_t, packet_count_arg,
+    int, completed_arg
+  ),
+  TP_FIELDS(
+    ctf_integer(uint64_t, frame_id, frame_id_arg)
+    ctf_integer(uint32_t, packet_count, packet_count_arg)
+    ctf_integer(int, completed, completed_arg)
+  )
+)
+
+// a frame completed by the packet wrapping around
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  frame_complete,
+  TP_ARGS(
+    uint64_t, frame_id_arg,
+    uint32_t, packet_count_arg,
+    uint32_t, width_arg,
+    uint64_t, timestamp_arg,
+    uint64_t, receive_time_arg
+  ),
+  TP_FIELDS(
+    ctf_integer(uint64_t, frame_id, frame_id_arg)
+    ctf_integer(uint32_t, packet_count, packet_count_arg)
+    ctf_integer(uint32_t, width, width_arg)
+    ctf_integer(uint64_t, timestamp, timestamp_arg)
+    ctf_integer(uint64_t, receive_time, receive_time_arg)
+  )
+)
+
+// a message published, the address and stamp of the message correlate it
+// with the rclcpp_publish and callback events of ros2_tracing
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  publish,
+  TP_ARGS(
+    const char *, processor_arg,
+    uint64_t, frame_id_arg,
+    uint32_t, packet_count_arg,
+    uint64_t, stamp_arg,
+    const void *, message_arg
+  ),
+  TP_FIELDS(
+    ctf_string(processor, processor_arg)
+    ctf_integer(uint64_t, frame_id, frame_id_arg)
+    ctf_integer(uint32_t, packet_count, packet_count_arg)
+    ctf_integer(uint64_t, stamp, stamp_arg)
+    ctf_integer_hex(const void *, message, message_arg)
+  )
+)
+
+#endif  // ROS2_OUSTER__CORE__TP_CALL_H_
+
+#include <lttng/tracepoint-event.h>
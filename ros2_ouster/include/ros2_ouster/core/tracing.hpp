@@ -0,0 +1,39 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__CORE__TRACING_HPP_
+#define ROS2_OUSTER__CORE__TRACING_HPP_
+
+/**
+ * @brief Trace an event of the ros2_ouster LTTng provider, see
+ * ros2_ouster/core/tp_call.h for the events and their arguments.
+ *
+ * Tracepoints are compiled in with the ROS2_OUSTER_TRACING CMake option,
+ * and then cost a branch while no tracing session enables them. Otherwise
+ * they compile to nothing, their arguments are not evaluated.
+ */
+#ifdef ROS2_OUSTER_TRACING_ENABLED
+
+#include "ros2_ouster/core/tp_call.h"
+
+#define ROS2_OUSTER_TRACEPOINT(event, ...) \
+  tracepoint(ros2_ouster, event, __VA_ARGS__)
+
+#else
+
+#define ROS2_OUSTER_TRACEPOINT(event, ...) \
+  do {} while (0)
+
+#endif
+
+#endif  // ROS2_OUSTER__CORE__TRACING_HPP_
@@ -14,12 +14,18 @@
 #ifndef ROS2_OUSTER__INTERFACES__DATA_PROCESSOR_INTERFACE_HPP_
 #define ROS2_OUSTER__INTERFACES__DATA_PROCESSOR_INTERFACE_HPP_
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 
+#include "ros2_ouster/core/frame_deadline.hpp"
+#include "ros2_ouster/core/latency_histogram.hpp"
+#include "ros2_ouster/core/load_controller.hpp"
 #include "ros2_ouster/interfaces/metadata.hpp"
 #include "ros2_ouster/interfaces/configuration.hpp"
-#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "ros2_ouster/interfaces/data_products.hpp"
+#include "ros2_ouster/thread_pool.hpp"
 
 namespace ros2_ouster
 {
@@ -36,7 +42,9 @@ public:
   /**
    * @brief Constructor of the data processor interface
    */
-  DataProcessorInterface() {}
+  DataProcessorInterface()
+  : _products(nullptr), _pool(nullptr), _deadline(nullptr), _load(nullptr),
+    _statistics(nullptr), _histogram(nullptr), _usage(nullptr) {}
 
   /**
    * @brief Destructor of the data processor interface
@@ -60,6 +68,173 @@ public:
    * @brief Deactivating processor from lifecycle state transitions
    */
   virtual void onDeactivate() = 0;
+
+  /**
+   * @brief Name of the processor in statistics
+   */
+  virtual const char * name() const
+  {
+    return "processor";
+  }
+
+  /**
+   * @brief Whether anyone consumes the output of this processor. The
+   * driver idles while no processor has subscribers.
+   */
+  virtual bool hasSubscribers() const
+  {
+    return true;
+  }
+
+  /**
+   * @brief Drop state accumulated from earlier packets, called when the
+   * stream of packets was interrupted
+   */
+  virtual void reset()
+  {
+  }
+
+  /**
+   * @brief Data this processor needs before it can run. Processors
+   * consuming anything other than the raw packet are scheduled after
+   * the processors producing it, and only run when it was produced.
+   * @return bitmask of DataType values
+   */
+  virtual std::uint32_t consumes() const
+  {
+    return RAW_PACKET;
+  }
+
+  /**
+   * @brief Data this processor makes available to other processors
+   * @return bitmask of DataType values
+   */
+  virtual std::uint32_t produces() const
+  {
+    return 0;
+  }
+
+  /**
+   * @brief Set the products shared between processors of a pipeline
+   * @param products products of the pipeline running this processor
+   */
+  void setProducts(DataProducts * products)
+  {
+    _products = products;
+  }
+
+  /**
+   * @brief Set the thread pool processors can split their work on
+   * @param pool pool of the pipeline, or nullptr to run single threaded
+   */
+  void setThreadPool(ThreadPool * pool)
+  {
+    _pool = pool;
+  }
+
+  /**
+   * @brief Set the deadline outputs are checked against before publishing
+   * @param deadline deadline of the driver, or nullptr to never drop
+   */
+  void setFrameDeadline(FrameDeadline * deadline)
+  {
+    _deadline = deadline;
+  }
+
+  /**
+   * @brief Set the controller deciding which load to shed
+   * @param load controller of the driver, or nullptr to never shed load
+   */
+  void setLoadController(LoadController * load)
+  {
+    _load = load;
+  }
+
+  /**
+   * @brief Set the latency histograms and resource usages stages are
+   * recorded to, registering those of this processor
+   * @param statistics statistics of the driver, or nullptr to record none
+   */
+  void setStatistics(PipelineStatistics * statistics)
+  {
+    _statistics = statistics;
+    _histogram = statistics ? &statistics->processor(name()) : nullptr;
+    _usage = statistics ? &statistics->processorUsage(name()) : nullptr;
+  }
+
+  /**
+   * @brief Histogram of the time spent processing, nullptr if statistics
+   * are not kept
+   */
+  LatencyHistogram * histogram() const
+  {
+    return _histogram;
+  }
+
+  /**
+   * @brief CPU time and allocations spent processing, nullptr if
+   * statistics are not kept
+   */
+  ResourceUsage * usage() const
+  {
+    return _usage;
+  }
+
+protected:
+  /**
+   * @struct ros2_ouster::DataProcessorInterface::StageStart
+   * @brief When a stage started, in time and in resources of the thread
+   */
+  struct StageStart
+  {
+    std::chrono::steady_clock::time_point time;
+    ResourceSample usage;
+  };
+
+  /**
+   * @brief Whether data received at a given time is too old to publish,
+   * counting it as dropped if so
+   * @param receive_time time the data was received in ns since epoch
+   */
+  bool isStale(uint64_t receive_time)
+  {
+    return _deadline && !_deadline->admit(receive_time);
+  }
+
+  /**
+   * @brief Start a stage, sampling the thread only if statistics are kept
+   */
+  StageStart startStage() const
+  {
+    StageStart start;
+    start.time = std::chrono::steady_clock::now();
+    if (_statistics) {
+      start.usage = ResourceSample::now();
+    }
+    return start;
+  }
+
+  /**
+   * @brief Record the time, CPU time and allocations of a stage since it
+   * started on this thread, if statistics are kept
+   * @param stage the stage
+   * @param start as returned by startStage()
+   */
+  void recordStage(PipelineStage stage, const StageStart & start)
+  {
+    if (_statistics) {
+      _statistics->stage(stage).record(start.time);
+      _statistics->stageUsage(stage).record(start.usage);
+    }
+  }
+
+  DataProducts * _products;
+  ThreadPool * _pool;
+  FrameDeadline * _deadline;
+  LoadController * _load;
+  PipelineStatistics * _statistics;
+  LatencyHistogram * _histogram;
+  ResourceUsage * _usage;
 };
 
 }  // namespace ros2_ouster
@@ -0,0 +1,136 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__INTERFACES__DATA_PRODUCTS_HPP_
+#define ROS2_OUSTER__INTERFACES__DATA_PRODUCTS_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace ros2_ouster
+{
+
+/**
+ * @brief Kinds of data a processor can consume or produce in the
+ * processing pipeline. Values are bit flags so that a processor can
+ * declare several of them at once.
+ */
+enum DataType : std::uint32_t
+{
+  RAW_PACKET = (1 << 0),
+  DECODED_FRAME = (1 << 1),
+  RANGE_IMAGE = (1 << 2),
+  GROUND_LABELS = (1 << 3)
+};
+
+constexpr std::size_t DATA_TYPE_COUNT = 4;
+
+/**
+ * @brief Convert DataType to string
+ */
+inline std::string toString(const DataType & type)
+{
+  switch (type) {
+    case RAW_PACKET:
+      return std::string("raw packet");
+    case DECODED_FRAME:
+      return std::string("decoded frame");
+    case RANGE_IMAGE:
+      return std::string("range image");
+    case GROUND_LABELS:
+      return std::string("ground labels");
+    default:
+      return std::string("unknown");
+  }
+}
+
+/**
+ * @class ros2_ouster::DataProducts
+ * @brief Products handed from one processor to the processors depending
+ * on it during a single run of the processing pipeline. Products are
+ * owned by their producer and are only valid until the run completes.
+ */
+class DataProducts
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::DataProducts
+   */
+  DataProducts()
+  {
+    clear();
+  }
+
+  /**
+   * @brief Drop all products, leaving only the raw packet available
+   */
+  void clear()
+  {
+    for (auto & product : _products) {
+      product.store(nullptr, std::memory_order_relaxed);
+    }
+    _available.store(RAW_PACKET, std::memory_order_release);
+  }
+
+  /**
+   * @brief Make a product available to downstream processors
+   * @param type the kind of data being produced
+   * @param product pointer to the product, owned by the caller
+   */
+  template<typename T>
+  void set(const DataType & type, const T * product)
+  {
+    _products[index(type)].store(product, std::memory_order_release);
+    _available.fetch_or(type, std::memory_order_acq_rel);
+  }
+
+  /**
+   * @brief Get a product produced earlier in this run
+   * @param type the kind of data requested
+   * @return pointer to the product, or nullptr if not produced
+   */
+  template<typename T>
+  const T * get(const DataType & type) const
+  {
+    return static_cast<const T *>(
+      _products[index(type)].load(std::memory_order_acquire));
+  }
+
+  /**
+   * @brief Get the mask of data types available in this run
+   * @return bitmask of DataType values
+   */
+  std::uint32_t available() const
+  {
+    return _available.load(std::memory_order_acquire);
+  }
+
+private:
+  static std::size_t index(const DataType & type)
+  {
+    std::size_t i = 0;
+    while (i + 1 < DATA_TYPE_COUNT && (static_cast<std::uint32_t>(type) >> i) != 1u) {
+      i++;
+    }
+    return i;
+  }
+
+  std::array<std::atomic<const void *>, DATA_TYPE_COUNT> _products;
+  std::atomic<std::uint32_t> _available;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__INTERFACES__DATA_PRODUCTS_HPP_
@@ -14,6 +14,7 @@
 #ifndef ROS2_OUSTER__INTERFACES__METADATA_HPP_
 #define ROS2_OUSTER__INTERFACES__METADATA_HPP_
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
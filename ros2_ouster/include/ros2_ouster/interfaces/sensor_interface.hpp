@@ -14,6 +14,8 @@
 #ifndef ROS2_OUSTER__INTERFACES__SENSOR_INTERFACE_HPP_
 #define ROS2_OUSTER__INTERFACES__SENSOR_INTERFACE_HPP_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 #include "ros2_ouster/interfaces/metadata.hpp"
@@ -75,6 +77,44 @@ public:
    */
   virtual uint8_t * readPacket(const ros2_ouster::ClientState & state) = 0;
 
+  /**
+   * @brief Time the packet last read was received
+   * @return time in ns since epoch, 0 if the sensor does not provide it
+   */
+  virtual uint64_t receiveTime() const
+  {
+    return 0;
+  }
+
+  /**
+   * @brief Packets dropped by the kernel for lack of buffer space, thread
+   * safe. Drops while idle are on purpose and not counted.
+   * @return total since construction, 0 if the sensor does not provide it
+   */
+  virtual uint64_t kernelDrops() const
+  {
+    return 0;
+  }
+
+  /**
+   * @brief Switch the sensor connection in or out of idle mode. While
+   * idle, packets are not read and should be discarded as cheaply as
+   * possible, when leaving idle mode packets queued so far are discarded.
+   * @param idle true to enter idle mode
+   */
+  virtual void setIdle(bool /*idle*/)
+  {
+  }
+
+  /**
+   * @brief Discard all packets queued, without reading them
+   * @return number of packets discarded
+   */
+  virtual std::size_t drain()
+  {
+    return 0;
+  }
+
   /**
    * @brief Get lidar sensor's metadata
    * @return sensor metadata struct
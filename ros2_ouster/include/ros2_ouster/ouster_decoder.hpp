@@ -0,0 +1,133 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__OUSTER_DECODER_HPP_
+#define ROS2_OUSTER__OUSTER_DECODER_HPP_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "ouster_msgs/msg/metadata.hpp"
+#include "ouster_msgs/msg/packet_batch.hpp"
+
+#include "ros2_ouster/core/frame_ring_writer.hpp"
+#include "ros2_ouster/core/frame_writer.hpp"
+#include "ros2_ouster/interfaces/data_processor_interface.hpp"
+#include "ros2_ouster/interfaces/lifecycle_interface.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+#include "ros2_ouster/processor_scheduler.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::OusterDecoder
+ * @brief A lifecycle interface implementation decoding the raw packets
+ * published by the RAW processor of a driver, live or from a recording,
+ * with the same processors as the driver. Packets are processed as soon
+ * as they are received, so recordings are decoded as fast as they are
+ * played back.
+ */
+class OusterDecoder : public lifecycle_interface::LifecycleInterface
+{
+public:
+  using DataProcessorMap = std::multimap<ClientState, DataProcessorInterface *>;
+  using DataProcessorMapIt = DataProcessorMap::iterator;
+
+  /**
+   * @brief A constructor for ros2_ouster::OusterDecoder
+   * @param options Node options for lifecycle node interfaces
+   */
+  explicit OusterDecoder(const rclcpp::NodeOptions & options);
+
+  /**
+   * @brief A destructor for ros2_ouster::OusterDecoder
+   */
+  ~OusterDecoder();
+
+  /**
+   * @brief lifecycle node's implementation of configure step
+   * which will subscribe to the metadata and packets
+   */
+  void onConfigure() override;
+
+  /**
+   * @brief lifecycle node's implementation of activate step
+   * which will activate ROS interfaces and start decoding packets
+   */
+  void onActivate() override;
+
+  /**
+   * @brief lifecycle node's implementation of deactivate step
+   * which will deactivate ROS interfaces and stop decoding packets
+   */
+  void onDeactivate() override;
+
+  /**
+   * @brief lifecycle node's implementation of error step
+   * which will handle errors in the lifecycle node system
+   */
+  void onError() override;
+
+  /**
+   * @brief lifecycle node's implementation of shutdown step
+   * which will shut down the lifecycle node
+   */
+  void onShutdown() override;
+
+  /**
+   * @brief lifecycle node's implementation of cleanup step
+   * which will deallocate resources
+   */
+  void onCleanup() override;
+
+private:
+  /**
+   * @brief Subscription callback creating the processors for the sensor
+   * described, replacing those of a previous sensor
+   * @param msg metadata of the sensor
+   */
+  void metadataCallback(const ouster_msgs::msg::Metadata::SharedPtr msg);
+
+  /**
+   * @brief Subscription callback running the packets of a batch
+   * through the processors
+   * @param msg batch of packets
+   */
+  void packetsCallback(std::unique_ptr<ouster_msgs::msg::PacketBatch> msg);
+
+  /**
+   * @brief Destroy the processors
+   */
+  void destroyProcessors();
+
+  rclcpp::Subscription<ouster_msgs::msg::Metadata>::SharedPtr _metadata_sub;
+  rclcpp::Subscription<ouster_msgs::msg::PacketBatch>::SharedPtr _packets_sub;
+
+  DataProcessorMap _data_processors;
+  std::unique_ptr<ProcessorScheduler> _scheduler;
+  std::unique_ptr<ouster_msgs::msg::Metadata> _metadata;
+
+  std::string _laser_data_frame, _imu_data_frame;
+  bool _use_system_default_qos;
+  std::uint32_t _os1_proc_mask;
+  ros2_ouster::FrameWriterOptions _frame_files;
+  ros2_ouster::FrameRingOptions _frame_ring;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__OUSTER_DECODER_HPP_
@@ -14,9 +14,11 @@
 #ifndef ROS2_OUSTER__OUSTER_DRIVER_HPP_
 #define ROS2_OUSTER__OUSTER_DRIVER_HPP_
 
+#include <chrono>
 #include <memory>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "ros2_ouster/conversions.hpp"
 
@@ -26,12 +28,27 @@
 #include "sensor_msgs/msg/point_cloud2.hpp"
 #include "sensor_msgs/msg/imu.hpp"
 #include "std_srvs/srv/empty.hpp"
+#include "std_srvs/srv/trigger.hpp"
+#include "ouster_msgs/msg/metadata.hpp"
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "ouster_msgs/msg/pipeline_statistics.hpp"
 #include "ouster_msgs/srv/get_metadata.hpp"
+#include "ouster_msgs/srv/get_statistics.hpp"
 
 #include "tf2_ros/static_transform_broadcaster.h"
 
+#include "ros2_ouster/core/compressed_recorder.hpp"
+#include "ros2_ouster/core/flight_recorder.hpp"
+#include "ros2_ouster/core/frame_deadline.hpp"
+#include "ros2_ouster/core/health_monitor.hpp"
+#include "ros2_ouster/core/latency_histogram.hpp"
+#include "ros2_ouster/core/load_controller.hpp"
+#include "ros2_ouster/core/metrics_server.hpp"
+#include "ros2_ouster/core/ouster_core.hpp"
+#include "ros2_ouster/core/packet_recorder.hpp"
 #include "ros2_ouster/interfaces/configuration.hpp"
 #include "ros2_ouster/interfaces/data_processor_interface.hpp"
+#include "ros2_ouster/processor_scheduler.hpp"
 
 namespace ros2_ouster
 {
@@ -104,6 +121,75 @@ private:
   */
   void processData();
 
+  /**
+  * @brief Timer callback switching in and out of idle mode depending on
+  * whether any output has subscribers or a recorder is open
+  */
+  void checkSubscribers();
+
+  /**
+  * @brief Whether a packet, compressed or flight recorder is open
+  */
+  bool isRecording() const;
+
+  /**
+  * @brief Enter or leave idle mode
+  * @param idle true to stop processing packets
+  */
+  void setIdle(bool idle);
+
+  /**
+  * @brief Finish the compressed recording, if any, and report how well
+  * it compressed
+  */
+  void closeCompressedRecording();
+
+  /**
+  * @brief Destroy the processors, joining their threads, before the
+  * scheduler and its thread pool they may still be using
+  */
+  void destroyProcessors();
+
+  /**
+  * @brief Timer callback publishing the latency histograms of the last
+  * period
+  */
+  void publishStatistics();
+
+  /**
+  * @brief Timer callback publishing the health of the driver over the
+  * last period as diagnostics
+  */
+  void publishDiagnostics();
+
+  /**
+  * @brief Sample the counters the health of the driver is checked on
+  */
+  HealthSample healthSample() const;
+
+  /**
+  * @brief Snapshots of the latency histograms, of the stages then of the
+  * processors
+  */
+  std::vector<LatencyHistogram::Snapshot> snapshotStatistics() const;
+
+  /**
+  * @brief Totals of the resource usages, of the stages then of the
+  * processors
+  */
+  std::vector<ResourceUsage::Totals> snapshotUsage() const;
+
+  /**
+  * @brief Convert snapshots of the latency histograms and resource usages
+  * to message format
+  * @param snapshots snapshots as taken by snapshotStatistics()
+  * @param usage totals as taken by snapshotUsage()
+  * @param period time covered in s
+  */
+  ouster_msgs::msg::PipelineStatistics toStatisticsMsg(
+    const std::vector<LatencyHistogram::Snapshot> & snapshots,
+    const std::vector<ResourceUsage::Totals> & usage, double period);
+
   /**
    * @brief Create TF2 frames for the lidar sensor
    */
@@ -131,18 +217,67 @@ private:
     const std::shared_ptr<ouster_msgs::srv::GetMetadata::Request> request,
     std::shared_ptr<ouster_msgs::srv::GetMetadata::Response> response);
 
+  /**
+  * @brief service callback to get the latency histograms since the driver
+  * was configured or they were last reset
+  * @param request_header Header of rmw request
+  * @param request Shared ptr of the GetStatistics request
+  * @param response Shared ptr of the GetStatistics response
+  */
+  void getStatistics(
+    const std::shared_ptr<rmw_request_id_t>/*request_header*/,
+    const std::shared_ptr<ouster_msgs::srv::GetStatistics::Request> request,
+    std::shared_ptr<ouster_msgs::srv::GetStatistics::Response> response);
+
+  /**
+  * @brief service callback to dump the packets of the flight recorder
+  * @param request_header Header of rmw request
+  * @param request Shared ptr of the Trigger request
+  * @param response Shared ptr of the Trigger response, with the path of
+  * the dump as message
+  */
+  void dumpFlightRecorder(
+    const std::shared_ptr<rmw_request_id_t>/*request_header*/,
+    const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
+    std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+
   rclcpp::Service<std_srvs::srv::Empty>::SharedPtr _reset_srv;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr _flight_recorder_srv;
   rclcpp::Service<ouster_msgs::srv::GetMetadata>::SharedPtr _metadata_srv;
+  rclcpp::Service<ouster_msgs::srv::GetStatistics>::SharedPtr _statistics_srv;
+  rclcpp_lifecycle::LifecyclePublisher<ouster_msgs::msg::Metadata>::SharedPtr _metadata_pub;
+  rclcpp_lifecycle::LifecyclePublisher<ouster_msgs::msg::PipelineStatistics>::SharedPtr
+    _statistics_pub;
+  rclcpp_lifecycle::LifecyclePublisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr
+    _diagnostics_pub;
 
-  std::unique_ptr<SensorInterface> _sensor;
+  std::unique_ptr<OusterCore> _core;
   std::multimap<ClientState, DataProcessorInterface *> _data_processors;
+  std::unique_ptr<ProcessorScheduler> _scheduler;
+  std::unique_ptr<FrameDeadline> _deadline;
+  uint64_t _reported_drops;
+  std::unique_ptr<LoadController> _load;
+  std::unique_ptr<PacketRecorder> _recorder;
+  std::unique_ptr<CompressedRecorder> _compressed_recorder;
+  std::unique_ptr<FlightRecorder> _flight_recorder;
+  std::unique_ptr<PipelineStatistics> _statistics;
+  std::vector<LatencyHistogram::Snapshot> _published_statistics;
+  std::vector<ResourceUsage::Totals> _published_usage;
+  std::chrono::steady_clock::time_point _statistics_published;
+  std::chrono::steady_clock::time_point _statistics_start;
+  std::unique_ptr<HealthMonitor> _health;
+  std::unique_ptr<MetricsServer> _metrics;
   rclcpp::TimerBase::SharedPtr _process_timer;
+  rclcpp::TimerBase::SharedPtr _idle_timer;
+  rclcpp::TimerBase::SharedPtr _statistics_timer;
+  rclcpp::TimerBase::SharedPtr _diagnostics_timer;
 
   std::string _laser_sensor_frame, _laser_data_frame, _imu_data_frame;
   std::unique_ptr<tf2_ros::StaticTransformBroadcaster> _tf_b;
 
   bool _use_system_default_qos;
   bool _use_ros_time;
+  bool _idle;
 
   std::uint32_t _os1_proc_mask;
   ros2_ouster::Metadata mdata;
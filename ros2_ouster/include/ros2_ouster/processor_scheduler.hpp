@@ -0,0 +1,94 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__PROCESSOR_SCHEDULER_HPP_
+#define ROS2_OUSTER__PROCESSOR_SCHEDULER_HPP_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "ros2_ouster/core/lidar_frame.hpp"
+#include "ros2_ouster/interfaces/data_processor_interface.hpp"
+#include "ros2_ouster/interfaces/data_products.hpp"
+#include "ros2_ouster/interfaces/metadata.hpp"
+#include "ros2_ouster/thread_pool.hpp"
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::ProcessorScheduler
+ * @brief Executes the data processors of the driver as a dependency
+ * graph. Processors are ordered into levels from what they consume and
+ * produce, processors within a level run concurrently on a thread pool
+ * and levels run one after another.
+ */
+class ProcessorScheduler
+{
+public:
+  using DataProcessorMap = std::multimap<ClientState, DataProcessorInterface *>;
+
+  /**
+   * @brief A constructor for ros2_ouster::ProcessorScheduler
+   * @param threads number of threads to run processors on. A value of
+   * 1 runs every processor on the thread calling process().
+   * @param affinity cores to pin the worker threads to, empty for none
+   */
+  explicit ProcessorScheduler(
+    std::size_t threads = 1,
+    const std::vector<int> & affinity = std::vector<int>());
+
+  /**
+   * @brief Build the dependency graphs of the processors, one per
+   * sensor state. Throws OusterDriverException if a consumed data type
+   * has no or several producers, or if the dependencies form a cycle.
+   * @param processors processors keyed by the sensor state they handle
+   */
+  void configure(const DataProcessorMap & processors);
+
+  /**
+   * @brief Run the processors registered for the state of a packet on
+   * it and block until all of them completed. The packet is available to
+   * the processors as the RAW_PACKET product.
+   * @param packet packet input
+   * @param override_ts Timestamp in nanos to use to override the ts in the
+   *                    packet data. To use the packet data, pass as 0.
+   */
+  void process(const Packet & packet, uint64_t override_ts = 0);
+
+  /**
+   * @brief Remove all processors from the scheduler
+   */
+  void clear();
+
+private:
+  using Level = std::vector<DataProcessorInterface *>;
+
+  void runLevel(const Level & level, uint8_t * data, uint64_t override_ts);
+
+  /**
+   * @brief Run a processor, timing it if its statistics are kept
+   */
+  static void run(DataProcessorInterface * processor, uint8_t * data, uint64_t override_ts);
+
+  std::map<ClientState, std::vector<Level>> _graphs;
+  std::vector<DataProcessorInterface *> _ready;
+  DataProducts _products;
+  std::unique_ptr<ThreadPool> _pool;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__PROCESSOR_SCHEDULER_HPP_
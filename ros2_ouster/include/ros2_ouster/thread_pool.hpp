@@ -0,0 +1,182 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__THREAD_POOL_HPP_
+#define ROS2_OUSTER__THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::ThreadPool
+ * @brief A small work-stealing pool of threads for per-frame work of the
+ * driver. Every thread owns a task queue, works on its newest tasks first
+ * and steals the oldest tasks of other threads when it runs out, so work
+ * split into many chunks balances even when chunks have uneven cost.
+ * Threads waiting on their work help executing pending tasks, which makes
+ * nested use from inside a task safe.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::ThreadPool
+   * @param threads number of threads executing tasks, including the
+   * thread waiting on the work. A value of 0 or 1 spawns no workers.
+   * @param affinity cores to pin the worker threads to, assigned in order
+   * and wrapping around. Empty leaves scheduling to the OS.
+   */
+  explicit ThreadPool(
+    std::size_t threads,
+    const std::vector<int> & affinity = std::vector<int>());
+
+  /**
+   * @brief A destructor joining the worker threads
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief Number of threads executing tasks, including the caller
+   */
+  std::size_t size() const
+  {
+    return _workers.size() + 1;
+  }
+
+  /**
+   * @brief Split the range [begin, end) into chunks and execute fn on
+   * every chunk, blocking until all chunks completed. Rethrows the first
+   * exception thrown by fn.
+   * @param begin first index of the range
+   * @param end one past the last index of the range
+   * @param grain number of indices per chunk. A value of 0 picks a chunk
+   * size giving several chunks per thread.
+   * @param fn callable invoked as fn(chunk_begin, chunk_end)
+   */
+  template<typename F>
+  void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, F && fn)
+  {
+    if (end <= begin) {
+      return;
+    }
+
+    const std::size_t count = end - begin;
+    if (grain == 0) {
+      grain = std::max<std::size_t>(1, count / (size() * 4));
+    }
+
+    // splitting only adds overhead without a second core to run on
+    if (_serial || count <= grain) {
+      fn(begin, end);
+      return;
+    }
+
+    // all chunks but the first are queued at once, the caller runs the first
+    TaskGroup group;
+    const std::size_t chunks = (count - 1) / grain;
+    group.pending.store(chunks, std::memory_order_relaxed);
+    _queued.fetch_add(chunks, std::memory_order_release);
+    {
+      Queue & queue = *_queues[localQueue()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      for (std::size_t chunk = begin + grain; chunk < end; chunk += grain) {
+        const std::size_t chunk_end = std::min(chunk + grain, end);
+        queue.tasks.push_back(Task{[&fn, chunk, chunk_end]() {fn(chunk, chunk_end);}, &group});
+      }
+    }
+    wake(chunks);
+
+    try {
+      fn(begin, std::min(begin + grain, end));
+    } catch (...) {
+      group.fail(std::current_exception());
+    }
+    wait(group);
+  }
+
+  /**
+   * @brief Execute every task concurrently and block until all completed
+   * @param tasks the tasks to execute
+   */
+  void run(const std::vector<std::function<void()>> & tasks);
+
+private:
+  /**
+   * @brief Completion tracking for the tasks of one call into the pool
+   */
+  struct TaskGroup
+  {
+    TaskGroup()
+    : pending(0) {}
+
+    void fail(std::exception_ptr e)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error) {
+        error = e;
+      }
+    }
+
+    std::atomic<std::size_t> pending;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable done_cv;
+  };
+
+  struct Task
+  {
+    std::function<void()> fn;
+    TaskGroup * group;
+  };
+
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void wake(std::size_t tasks);
+  bool tryRunOne();
+  void execute(Task & task);
+  void wait(TaskGroup & group);
+  void workerLoop(std::size_t index, int core);
+  std::size_t localQueue() const;
+
+  // queue 0 is shared by threads outside of the pool
+  std::vector<std::unique_ptr<Queue>> _queues;
+  std::vector<std::thread> _workers;
+  std::atomic<std::size_t> _queued;  // counted before tasks are visible, never below zero
+  bool _serial;  // no workers, or a single core to run them on
+  std::mutex _sleep_mutex;
+  std::condition_variable _sleep_cv;
+  bool _stop;
+};
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__THREAD_POOL_HPP_
@@ -0,0 +1,120 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_OUSTER__TRIPLE_BUFFER_HPP_
+#define ROS2_OUSTER__TRIPLE_BUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace ros2_ouster
+{
+
+/**
+ * @class ros2_ouster::TripleBuffer
+ * @brief Lock-free handoff of the latest value from one producer thread
+ * to one consumer thread. The producer fills the write buffer and
+ * publishes it without ever blocking, the consumer picks up the most
+ * recently published buffer and never sees values it skipped over.
+ *
+ * The three buffers rotate between the producer, the consumer and a
+ * middle slot exchanged atomically together with a fresh flag.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+  /**
+   * @brief A constructor for ros2_ouster::TripleBuffer
+   * @param init value every buffer starts with, e.g. to preallocate
+   */
+  explicit TripleBuffer(const T & init = T())
+  : _buffers{{init, init, init}}, _middle(1), _write(0), _read(2)
+  {
+  }
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer & operator=(const TripleBuffer &) = delete;
+
+  /**
+   * @brief Buffer owned by the producer, to fill before publish()
+   * @return reference to the write buffer
+   */
+  T & writeBuffer()
+  {
+    return _buffers[_write];
+  }
+
+  /**
+   * @brief Make the write buffer the latest value and take over a free
+   * buffer to write the next value into. Never blocks.
+   */
+  void publish()
+  {
+    const std::uint8_t previous =
+      _middle.exchange(static_cast<std::uint8_t>(_write | FRESH), std::memory_order_acq_rel);
+    _write = previous & INDEX;
+  }
+
+  /**
+   * @brief Whether a value was published since the consumer last updated
+   */
+  bool hasNew() const
+  {
+    return (_middle.load(std::memory_order_acquire) & FRESH) != 0;
+  }
+
+  /**
+   * @brief Take over the latest published value if there is a new one
+   * @return true if the read buffer now holds a new value
+   */
+  bool update()
+  {
+    if (!hasNew()) {
+      return false;
+    }
+
+    const std::uint8_t previous = _middle.exchange(_read, std::memory_order_acq_rel);
+    _read = previous & INDEX;
+    return true;
+  }
+
+  /**
+   * @brief Buffer owned by the consumer, valid until the next update()
+   * @return reference to the read buffer
+   */
+  T & readBuffer()
+  {
+    return _buffers[_read];
+  }
+
+private:
+  static constexpr std::uint8_t INDEX = 0x3;
+  static constexpr std::uint8_t FRESH = 0x4;
+
+  std::array<T, 3> _buffers;
+  std::atomic<std::uint8_t> _middle;
+  std::uint8_t _write;
+  std::uint8_t _read;
+};
+
+template<typename T>
+constexpr std::uint8_t TripleBuffer<T>::INDEX;
+
+template<typename T>
+constexpr std::uint8_t TripleBuffer<T>::FRESH;
+
+}  // namespace ros2_ouster
+
+#endif  // ROS2_OUSTER__TRIPLE_BUFFER_HPP_
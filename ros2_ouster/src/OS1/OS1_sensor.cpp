@@ -13,7 +13,6 @@
 
 #include <string>
 
-#include "ros2_ouster/conversions.hpp"
 #include "ros2_ouster/OS1/OS1_sensor.hpp"
 #include "ros2_ouster/exception.hpp"
 #include "ros2_ouster/interfaces/metadata.hpp"
@@ -29,6 +28,15 @@ OS1Sensor::OS1Sensor()
   _lidar_vendor = std::string("OLE_3D_V2");
   _lidar_packet_size = 1206;
   _imu_packet_size = 842;
+  _receive_time = 0;
+  _idle = false;
+  _lidar_receive_buffer = -1;
+  _imu_receive_buffer = -1;
+  _lidar_drops = 0;
+  _imu_drops = 0;
+  _lidar_resync = false;
+  _imu_resync = false;
+  _kernel_drops = 0;
 
   _lidar_packet.resize(_lidar_packet_size + 1);
   _imu_packet.resize(_imu_packet_size + 1);
@@ -59,6 +67,12 @@ void OS1Sensor::configure(const ros2_ouster::Configuration & config)
   _imu_packet.resize(_imu_packet_size + 1);
 
   _ouster_client = OS1::init_client(config.lidar_port, config.imu_port);
+  _idle = false;
+  // new sockets count from 0
+  _lidar_drops = 0;
+  _imu_drops = 0;
+  _lidar_resync = false;
+  _imu_resync = false;
 
   if (!_ouster_client) {
     throw ros2_ouster::OusterDriverException(
@@ -89,20 +103,86 @@ uint8_t * OS1Sensor::readPacket(const ros2_ouster::ClientState & state)
 {
   switch (state) {
     case ros2_ouster::ClientState::LIDAR_DATA:
-      if (read_lidar_packet(*_ouster_client, _lidar_packet.data(),_lidar_packet_size)) {
+      {
+        uint32_t drops = _lidar_drops;
+        const bool read = read_lidar_packet(
+          *_ouster_client, _lidar_packet.data(), _lidar_packet_size, &_receive_time, &drops);
+        if (!read) {
+          return nullptr;
+        }
+        countDrops(drops, _lidar_drops, _lidar_resync);
         return _lidar_packet.data();
-      } else {
-        return nullptr;
       }
     case ros2_ouster::ClientState::IMU_DATA:
-      if (read_imu_packet(*_ouster_client, _imu_packet.data(), _imu_packet_size)) {
+      {
+        uint32_t drops = _imu_drops;
+        const bool read = read_imu_packet(
+          *_ouster_client, _imu_packet.data(), _imu_packet_size, &_receive_time, &drops);
+        if (!read) {
+          return nullptr;
+        }
+        countDrops(drops, _imu_drops, _imu_resync);
         return _imu_packet.data();
-      } else {
-        return nullptr;
       }
     default:
       return nullptr;
   }
 }
 
+uint64_t OS1Sensor::receiveTime() const
+{
+  return _receive_time;
+}
+
+uint64_t OS1Sensor::kernelDrops() const
+{
+  return _kernel_drops.load(std::memory_order_relaxed);
+}
+
+void OS1Sensor::countDrops(uint32_t reported, uint32_t & last, bool & resync)
+{
+  // the counts wrap around, the difference of unsigned values does too
+  if (!resync) {
+    _kernel_drops.fetch_add(reported - last, std::memory_order_relaxed);
+  }
+  last = reported;
+  resync = false;
+}
+
+void OS1Sensor::setIdle(bool idle)
+{
+  if (!_ouster_client || idle == _idle) {
+    return;
+  }
+
+  if (idle) {
+    _lidar_receive_buffer = get_receive_buffer(_ouster_client->lidar_fd);
+    _imu_receive_buffer = get_receive_buffer(_ouster_client->imu_fd);
+    set_receive_buffer(_ouster_client->lidar_fd, 0);
+    set_receive_buffer(_ouster_client->imu_fd, 0);
+  } else {
+    if (_lidar_receive_buffer > 0) {
+      set_receive_buffer(_ouster_client->lidar_fd, _lidar_receive_buffer);
+    }
+    if (_imu_receive_buffer > 0) {
+      set_receive_buffer(_ouster_client->imu_fd, _imu_receive_buffer);
+    }
+    drain();
+    // drops while idle are on purpose, they are not counted
+    _lidar_resync = true;
+    _imu_resync = true;
+  }
+
+  _idle = idle;
+}
+
+std::size_t OS1Sensor::drain()
+{
+  if (!_ouster_client) {
+    return 0;
+  }
+
+  return drain_socket(_ouster_client->lidar_fd) + drain_socket(_ouster_client->imu_fd);
+}
+
 }  // namespace OS1
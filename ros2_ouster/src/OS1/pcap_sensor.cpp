@@ -0,0 +1,357 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "ros2_ouster/OS1/pcap_sensor.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace OS1
+{
+
+namespace
+{
+
+// pcap link types
+constexpr uint32_t LINKTYPE_NULL = 0;
+constexpr uint32_t LINKTYPE_ETHERNET = 1;
+constexpr uint32_t LINKTYPE_RAW_OPENBSD = 12;
+constexpr uint32_t LINKTYPE_RAW = 101;
+constexpr uint32_t LINKTYPE_LINUX_SLL = 113;
+constexpr uint32_t LINKTYPE_IPV4 = 228;
+constexpr uint32_t LINKTYPE_LINUX_SLL2 = 276;
+
+constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+constexpr uint16_t ETHERTYPE_VLAN = 0x8100;
+constexpr uint16_t ETHERTYPE_QINQ = 0x88a8;
+
+constexpr std::size_t GLOBAL_HEADER_SIZE = 24;
+constexpr std::size_t RECORD_HEADER_SIZE = 16;
+
+inline uint16_t be16(const uint8_t * p)
+{
+  return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t read32(const uint8_t * p, bool swapped)
+{
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return swapped ? __builtin_bswap32(v) : v;
+}
+
+}  // namespace
+
+PcapSensor::PcapSensor(const std::string & path, double rate)
+: SensorInterface(),
+  _path(path),
+  _rate(rate > 0.0 ? rate : 0.0),
+  _map(nullptr),
+  _map_size(0),
+  _swapped(false),
+  _nanoseconds(false),
+  _link_type(LINKTYPE_ETHERNET),
+  _lidar_port(0),
+  _imu_port(0),
+  _lidar_packet_size(0),
+  _imu_packet_size(0),
+  _offset(GLOBAL_HEADER_SIZE),
+  _next(nullptr),
+  _next_state(ros2_ouster::ClientState::TIMEOUT),
+  _next_ts(0),
+  _first_ts(0),
+  _started(false),
+  _finished(false),
+  _idle(false)
+{
+}
+
+PcapSensor::~PcapSensor()
+{
+  unmap();
+}
+
+void PcapSensor::unmap()
+{
+  if (_map) {
+    munmap(_map, _map_size);
+    _map = nullptr;
+    _map_size = 0;
+  }
+}
+
+void PcapSensor::reset(const ros2_ouster::Configuration & config)
+{
+  configure(config);
+}
+
+void PcapSensor::configure(const ros2_ouster::Configuration & config)
+{
+  unmap();
+
+  const int fd = open(_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw ros2_ouster::OusterDriverException(
+            "Failed to open pcap file " + _path + ": " + std::strerror(errno));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(GLOBAL_HEADER_SIZE)) {
+    close(fd);
+    throw ros2_ouster::OusterDriverException(
+            "Pcap file " + _path + " is too short.");
+  }
+
+  // private writable mapping: processors get mutable packets without
+  // copies, any write stays local to this process
+  _map_size = static_cast<std::size_t>(st.st_size);
+  void * map = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    _map_size = 0;
+    throw ros2_ouster::OusterDriverException(
+            "Failed to map pcap file " + _path + ": " + std::strerror(errno));
+  }
+  _map = static_cast<uint8_t *>(map);
+  madvise(_map, _map_size, MADV_SEQUENTIAL);
+
+  uint32_t magic;
+  std::memcpy(&magic, _map, sizeof(magic));
+  switch (magic) {
+    case 0xa1b2c3d4:
+      _swapped = false;
+      _nanoseconds = false;
+      break;
+    case 0xd4c3b2a1:
+      _swapped = true;
+      _nanoseconds = false;
+      break;
+    case 0xa1b23c4d:
+      _swapped = false;
+      _nanoseconds = true;
+      break;
+    case 0x4d3cb2a1:
+      _swapped = true;
+      _nanoseconds = true;
+      break;
+    case 0x0a0d0d0a:
+      unmap();
+      throw ros2_ouster::OusterDriverException(
+              "Pcap file " + _path + " is in pcapng format, convert it "
+              "with `editcap -F pcap`.");
+    default:
+      unmap();
+      throw ros2_ouster::OusterDriverException(
+              "File " + _path + " is not a pcap file.");
+  }
+
+  _link_type = read32(_map + 20, _swapped) & 0x0fffffff;
+  switch (_link_type) {
+    case LINKTYPE_NULL:
+    case LINKTYPE_ETHERNET:
+    case LINKTYPE_RAW_OPENBSD:
+    case LINKTYPE_RAW:
+    case LINKTYPE_LINUX_SLL:
+    case LINKTYPE_IPV4:
+    case LINKTYPE_LINUX_SLL2:
+      break;
+    default:
+      unmap();
+      throw ros2_ouster::OusterDriverException(
+              "Unsupported link type " + std::to_string(_link_type) +
+              " in pcap file " + _path + ".");
+  }
+
+  _lidar_port = config.lidar_port;
+  _imu_port = config.imu_port;
+  _lidar_packet_size = static_cast<std::size_t>(config.lidar_packet_size);
+  _imu_packet_size = static_cast<std::size_t>(config.imu_packet_size);
+
+  _offset = GLOBAL_HEADER_SIZE;
+  _next = nullptr;
+  _started = false;
+  _finished = false;
+  _idle = false;
+}
+
+bool PcapSensor::findNext()
+{
+  while (_offset + RECORD_HEADER_SIZE <= _map_size) {
+    const uint8_t * header = _map + _offset;
+    const uint32_t ts_sec = read32(header, _swapped);
+    const uint32_t ts_frac = read32(header + 4, _swapped);
+    const std::size_t len = read32(header + 8, _swapped);
+    uint8_t * record = _map + _offset + RECORD_HEADER_SIZE;
+    if (_offset + RECORD_HEADER_SIZE + len > _map_size) {
+      // truncated capture
+      break;
+    }
+    _offset += RECORD_HEADER_SIZE + len;
+
+    // link layer, down to an IPv4 packet
+    std::size_t ip_offset = 0;
+    uint16_t ethertype = ETHERTYPE_IPV4;
+    switch (_link_type) {
+      case LINKTYPE_ETHERNET:
+        if (len < 14) {
+          continue;
+        }
+        ethertype = be16(record + 12);
+        ip_offset = 14;
+        while ((ethertype == ETHERTYPE_VLAN || ethertype == ETHERTYPE_QINQ) &&
+          len >= ip_offset + 4)
+        {
+          ethertype = be16(record + ip_offset + 2);
+          ip_offset += 4;
+        }
+        break;
+      case LINKTYPE_LINUX_SLL:
+        if (len < 16) {
+          continue;
+        }
+        ethertype = be16(record + 14);
+        ip_offset = 16;
+        break;
+      case LINKTYPE_LINUX_SLL2:
+        if (len < 20) {
+          continue;
+        }
+        ethertype = be16(record);
+        ip_offset = 20;
+        break;
+      case LINKTYPE_NULL:
+        // address family in the byte order of the capturing host
+        ip_offset = 4;
+        break;
+      default:
+        break;
+    }
+    if (ethertype != ETHERTYPE_IPV4 || len < ip_offset + 20) {
+      continue;
+    }
+
+    // IPv4, unfragmented UDP only: sensor packets fit in a frame
+    const uint8_t * ip = record + ip_offset;
+    const std::size_t ihl = (ip[0] & 0x0f) * 4u;
+    if ((ip[0] >> 4) != 4 || ip[9] != 17 || (be16(ip + 6) & 0x3fff) != 0 ||
+      len < ip_offset + ihl + 8)
+    {
+      continue;
+    }
+
+    uint8_t * udp = record + ip_offset + ihl;
+    const int port = be16(udp + 2);
+    const std::size_t payload_size = be16(udp + 4) >= 8 ? be16(udp + 4) - 8u : 0u;
+    if (len < ip_offset + ihl + 8 + payload_size) {
+      continue;
+    }
+
+    if (port == _lidar_port && payload_size == _lidar_packet_size) {
+      _next_state = ros2_ouster::ClientState::LIDAR_DATA;
+    } else if (port == _imu_port && payload_size == _imu_packet_size) {
+      _next_state = ros2_ouster::ClientState::IMU_DATA;
+    } else {
+      continue;
+    }
+
+    _next = udp + 8;
+    _next_ts = static_cast<uint64_t>(ts_sec) * 1000000000ull +
+      static_cast<uint64_t>(ts_frac) * (_nanoseconds ? 1ull : 1000ull);
+    return true;
+  }
+
+  _finished = true;
+  return false;
+}
+
+PcapSensor::Clock::time_point PcapSensor::due() const
+{
+  const double elapsed_ns =
+    static_cast<double>(static_cast<int64_t>(_next_ts - _first_ts)) / _rate;
+  return _start + std::chrono::nanoseconds(static_cast<int64_t>(elapsed_ns));
+}
+
+ros2_ouster::ClientState PcapSensor::get()
+{
+  if (!_map) {
+    throw ros2_ouster::OusterDriverException(
+            std::string("Pcap sensor used before being configured."));
+  }
+
+  if (!_next && !findNext()) {
+    return ros2_ouster::ClientState::TIMEOUT;
+  }
+
+  if (_rate > 0.0) {
+    if (!_started) {
+      _start = Clock::now();
+      _first_ts = _next_ts;
+      _started = true;
+    }
+
+    // blocks at most as long as waiting for a live sensor
+    const Clock::time_point due_time = due();
+    const Clock::time_point limit = Clock::now() + std::chrono::seconds(1);
+    if (due_time > limit) {
+      std::this_thread::sleep_until(limit);
+      return ros2_ouster::ClientState::TIMEOUT;
+    }
+    std::this_thread::sleep_until(due_time);
+  }
+
+  return _next_state;
+}
+
+uint8_t * PcapSensor::readPacket(const ros2_ouster::ClientState & state)
+{
+  if (!_next || state != _next_state) {
+    return nullptr;
+  }
+
+  uint8_t * data = _next;
+  _next = nullptr;
+  return data;
+}
+
+void PcapSensor::setIdle(bool idle)
+{
+  if (!idle && _idle) {
+    drain();
+  }
+  _idle = idle;
+}
+
+std::size_t PcapSensor::drain()
+{
+  if (!_map || _rate <= 0.0 || !_started) {
+    return 0;
+  }
+
+  std::size_t drained = 0;
+  const Clock::time_point now = Clock::now();
+  while ((_next || findNext()) && due() <= now) {
+    _next = nullptr;
+    drained++;
+  }
+  return drained;
+}
+
+}  // namespace OS1
@@ -0,0 +1,105 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <thread>
+
+#include "ros2_ouster/OS1/synthetic_sensor.hpp"
+
+namespace OS1
+{
+
+SyntheticSensor::SyntheticSensor(
+  const ros2_ouster::Metadata & mdata, const ros2_ouster::SyntheticScene & scene,
+  double rotation_rate, double rate)
+: SensorInterface(),
+  _generator(mdata, scene, rotation_rate),
+  _packet(_generator.packetSize()),
+  _rate(rate > 0.0 ? rate : 0.0),
+  _started(false),
+  _idle(false)
+{
+}
+
+void SyntheticSensor::reset(const ros2_ouster::Configuration & config)
+{
+  configure(config);
+}
+
+void SyntheticSensor::configure(const ros2_ouster::Configuration & /*config*/)
+{
+  _generator.reset();
+  _started = false;
+  _idle = false;
+}
+
+SyntheticSensor::Clock::time_point SyntheticSensor::due() const
+{
+  const double elapsed_ns = static_cast<double>(_generator.time()) / _rate;
+  return _start + std::chrono::nanoseconds(static_cast<int64_t>(elapsed_ns));
+}
+
+ros2_ouster::ClientState SyntheticSensor::get()
+{
+  if (_rate > 0.0) {
+    if (!_started) {
+      _start = Clock::now();
+      _started = true;
+    }
+
+    // blocks at most as long as waiting for a live sensor
+    const Clock::time_point due_time = due();
+    const Clock::time_point limit = Clock::now() + std::chrono::seconds(1);
+    if (due_time > limit) {
+      std::this_thread::sleep_until(limit);
+      return ros2_ouster::ClientState::TIMEOUT;
+    }
+    std::this_thread::sleep_until(due_time);
+  }
+
+  return ros2_ouster::ClientState::LIDAR_DATA;
+}
+
+uint8_t * SyntheticSensor::readPacket(const ros2_ouster::ClientState & state)
+{
+  if (state != ros2_ouster::ClientState::LIDAR_DATA) {
+    return nullptr;
+  }
+
+  _generator.next(_packet.data());
+  return _packet.data();
+}
+
+void SyntheticSensor::setIdle(bool idle)
+{
+  if (!idle && _idle) {
+    drain();
+  }
+  _idle = idle;
+}
+
+std::size_t SyntheticSensor::drain()
+{
+  if (_rate <= 0.0 || !_started) {
+    return 0;
+  }
+
+  std::size_t drained = 0;
+  const Clock::time_point now = Clock::now();
+  while (due() <= now) {
+    _generator.skip();
+    drained++;
+  }
+  return drained;
+}
+
+}  // namespace OS1
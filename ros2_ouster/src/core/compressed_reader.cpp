@@ -0,0 +1,138 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "ros2_ouster/core/compressed_reader.hpp"
+#include "ros2_ouster/core/recording_format.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+using recording::BlockHeader;
+using recording::CompressedHeader;
+using recording::RecordHeader;
+
+CompressedReader::CompressedReader(const std::string & path)
+: _path(path),
+  _map(nullptr),
+  _map_size(0),
+  _offset(0),
+  _record_offset(0)
+{
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw OusterDriverException(
+            "Failed to open recording " + path + ": " + std::strerror(errno));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CompressedHeader))) {
+    ::close(fd);
+    throw OusterDriverException("Recording " + path + " is too short.");
+  }
+
+  _map_size = static_cast<std::size_t>(st.st_size);
+  void * map = mmap(nullptr, _map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    throw OusterDriverException(
+            "Failed to map recording " + path + ": " + std::strerror(errno));
+  }
+  _map = static_cast<uint8_t *>(map);
+
+  CompressedHeader header;
+  std::memcpy(&header, _map, sizeof(header));
+  if (std::memcmp(header.magic, recording::COMPRESSED_MAGIC, sizeof(header.magic)) != 0 ||
+    header.version != recording::COMPRESSED_VERSION)
+  {
+    munmap(_map, _map_size);
+    throw OusterDriverException("File " + path + " is not a compressed packet recording.");
+  }
+
+  if (header.metadata_size > _map_size - sizeof(header)) {
+    munmap(_map, _map_size);
+    throw OusterDriverException("Recording " + path + " is truncated.");
+  }
+
+  try {
+    _metadata = recording::metadataFromJson(
+      std::string(reinterpret_cast<const char *>(_map + sizeof(header)), header.metadata_size));
+  } catch (const OusterDriverException &) {
+    munmap(_map, _map_size);
+    throw;
+  }
+
+  _codec = std::make_unique<PacketCodec>(_metadata);
+  _offset = sizeof(header) + header.metadata_size;
+  madvise(_map, _map_size, MADV_SEQUENTIAL);
+}
+
+CompressedReader::~CompressedReader()
+{
+  munmap(_map, _map_size);
+}
+
+bool CompressedReader::next(Packet & packet)
+{
+  if (_record_offset >= _records.size() && !nextBlock()) {
+    return false;
+  }
+
+  // blocks were checked while decompressing
+  RecordHeader record;
+  std::memcpy(&record, _records.data() + _record_offset, sizeof(record));
+  packet.state = static_cast<ClientState>(record.state);
+  packet.data = _records.data() + _record_offset + sizeof(RecordHeader);
+  packet.size = record.size;
+  packet.receive_time = record.receive_time;
+  _record_offset += sizeof(RecordHeader) + record.size;
+  return true;
+}
+
+bool CompressedReader::nextBlock()
+{
+  do {
+    // a block cut short by a crash ends the recording
+    if (_offset + sizeof(BlockHeader) > _map_size) {
+      return false;
+    }
+    BlockHeader header;
+    std::memcpy(&header, _map + _offset, sizeof(header));
+    if (header.compressed_size > _map_size - _offset - sizeof(header)) {
+      return false;
+    }
+
+    if (!_codec->decompress(
+        _map + _offset + sizeof(header), header.compressed_size, header.packet_count,
+        header.encoded_size, _records))
+    {
+      throw OusterDriverException(
+              "Recording " + _path + " is corrupted at offset " + std::to_string(_offset) + ".");
+    }
+    _offset += sizeof(header) + header.compressed_size;
+    _record_offset = 0;
+  } while (_records.empty());
+  return true;
+}
+
+}  // namespace ros2_ouster
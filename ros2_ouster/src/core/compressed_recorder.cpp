@@ -0,0 +1,273 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros2_ouster/core/compressed_recorder.hpp"
+#include "ros2_ouster/core/recording_format.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+using recording::BlockHeader;
+using recording::CompressedHeader;
+using recording::RecordHeader;
+
+namespace
+{
+
+// largest UDP payload, so that a block never grows while filling
+constexpr std::size_t MAX_PACKET_SIZE = 65536;
+
+}  // namespace
+
+constexpr std::size_t CompressedRecorder::BLOCK_SIZE;
+constexpr std::size_t CompressedRecorder::MAX_QUEUED;
+
+CompressedRecorder::CompressedRecorder(
+  const std::string & path, const Metadata & mdata, std::size_t max_size)
+: _path(path),
+  _fd(-1),
+  _max_size(max_size),
+  _file_size(0),
+  _codec(mdata),
+  _block_count(0),
+  _dropped_reported(0),
+  _stop(false),
+  _packets(0),
+  _dropped(0),
+  _raw_bytes(0),
+  _compressed_bytes(0),
+  _busy_ns(0)
+{
+  _fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (_fd < 0) {
+    throw OusterDriverException(
+            "Failed to create recording " + path + ": " + std::strerror(errno));
+  }
+
+  const std::string metadata = recording::metadataToJson(mdata);
+  CompressedHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, recording::COMPRESSED_MAGIC, sizeof(header.magic));
+  header.version = recording::COMPRESSED_VERSION;
+  header.metadata_size = static_cast<uint32_t>(metadata.size());
+  if (!writeAll(&header, sizeof(header)) || !writeAll(metadata.data(), metadata.size())) {
+    const int err = errno;
+    ::close(_fd);
+    throw OusterDriverException(
+            "Failed to write recording " + path + ": " + std::strerror(err));
+  }
+  _file_size = sizeof(header) + metadata.size();
+
+  // every buffer is allocated here, never on the thread receiving packets
+  const std::size_t capacity = BLOCK_SIZE + sizeof(RecordHeader) + MAX_PACKET_SIZE;
+  _block.reserve(capacity);
+  _queue.reserve(MAX_QUEUED + 1);
+  _spare.resize(MAX_QUEUED);
+  for (auto & buffer : _spare) {
+    buffer.reserve(capacity);
+  }
+  _worker = std::thread(&CompressedRecorder::worker, this);
+}
+
+CompressedRecorder::~CompressedRecorder()
+{
+  close();
+}
+
+bool CompressedRecorder::write(const Packet & packet)
+{
+  if (_fd < 0) {
+    return false;
+  }
+
+  RecordHeader record;
+  record.receive_time = packet.receive_time;
+  record.size = static_cast<uint32_t>(packet.size);
+  record.state = static_cast<uint32_t>(packet.state);
+
+  const std::size_t offset = _block.size();
+  _block.resize(offset + sizeof(record) + packet.size);
+  std::memcpy(_block.data() + offset, &record, sizeof(record));
+  std::memcpy(_block.data() + offset + sizeof(record), packet.data, packet.size);
+  _block_count++;
+
+  if (_block.size() >= BLOCK_SIZE) {
+    submit();
+  }
+
+  const uint64_t dropped = _dropped.load(std::memory_order_relaxed);
+  const bool kept = dropped == _dropped_reported;
+  _dropped_reported = dropped;
+  return kept;
+}
+
+void CompressedRecorder::submit()
+{
+  bool queued = false;
+  {
+    // the block is handed over only in exchange for a free buffer
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_spare.empty()) {
+      _queue.push_back(Block{std::move(_block), _block_count});
+      _block = std::move(_spare.back());
+      _spare.pop_back();
+      queued = true;
+    }
+  }
+
+  if (queued) {
+    _cv.notify_one();
+  } else {
+    // the background thread fell behind, the block is dropped and its
+    // buffer reused
+    _dropped.fetch_add(_block_count, std::memory_order_relaxed);
+  }
+
+  _block.clear();
+  _block_count = 0;
+}
+
+void CompressedRecorder::close()
+{
+  if (_fd < 0) {
+    return;
+  }
+
+  // the last block is waited for rather than dropped
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_block_count > 0) {
+      _queue.push_back(Block{std::move(_block), _block_count});
+    }
+    _stop = true;
+  }
+  _cv.notify_one();
+  _worker.join();
+  _block = std::vector<uint8_t>();
+  _block_count = 0;
+
+  ::close(_fd);
+  _fd = -1;
+}
+
+double CompressedRecorder::ratio() const
+{
+  const uint64_t compressed = _compressed_bytes.load(std::memory_order_relaxed);
+  if (compressed == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(_raw_bytes.load(std::memory_order_relaxed)) / compressed;
+}
+
+double CompressedRecorder::throughput() const
+{
+  const uint64_t busy_ns = _busy_ns.load(std::memory_order_relaxed);
+  if (busy_ns == 0) {
+    return 0.0;
+  }
+  // bytes per ns to MB/s
+  return static_cast<double>(_raw_bytes.load(std::memory_order_relaxed)) * 1e3 / busy_ns;
+}
+
+bool CompressedRecorder::writeAll(const void * data, std::size_t size)
+{
+  const uint8_t * bytes = static_cast<const uint8_t *>(data);
+  while (size > 0) {
+    const ssize_t written = ::write(_fd, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    bytes += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+void CompressedRecorder::worker()
+{
+  std::vector<uint8_t> compressed;
+  bool failed = false;
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _cv.wait(lock, [this] {return _stop || !_queue.empty();});
+    if (_queue.empty()) {
+      break;
+    }
+    Block block = std::move(_queue.front());
+    _queue.erase(_queue.begin());
+    lock.unlock();
+
+    const auto start = std::chrono::steady_clock::now();
+    bool written = false;
+    BlockHeader header;
+    std::memset(&header, 0, sizeof(header));
+    if (!failed) {
+      try {
+        header.encoded_size = static_cast<uint32_t>(
+          _codec.compress(block.records.data(), block.records.size(), block.count, compressed));
+        header.packet_count = static_cast<uint32_t>(block.count);
+        header.compressed_size = static_cast<uint32_t>(compressed.size());
+      } catch (const OusterDriverException &) {
+        compressed.clear();
+      }
+
+      const std::size_t size = sizeof(header) + compressed.size();
+      if (!compressed.empty() && _file_size + size <= _max_size) {
+        written = writeAll(&header, sizeof(header)) &&
+          writeAll(compressed.data(), compressed.size());
+        if (written) {
+          _file_size += size;
+        } else {
+          // cut a partial block, the recording stays readable
+          const int truncated = ftruncate(_fd, static_cast<off_t>(_file_size));
+          (void)truncated;
+          failed = true;
+        }
+      }
+    }
+    const auto busy = std::chrono::steady_clock::now() - start;
+
+    if (written) {
+      _packets.fetch_add(block.count, std::memory_order_relaxed);
+      _raw_bytes.fetch_add(block.records.size(), std::memory_order_relaxed);
+      _compressed_bytes.fetch_add(
+        sizeof(header) + compressed.size(), std::memory_order_relaxed);
+      _busy_ns.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(),
+        std::memory_order_relaxed);
+    } else {
+      _dropped.fetch_add(block.count, std::memory_order_relaxed);
+    }
+
+    lock.lock();
+    block.records.clear();
+    _spare.push_back(std::move(block.records));
+  }
+}
+
+}  // namespace ros2_ouster
@@ -0,0 +1,370 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros2_ouster/core/flight_recorder.hpp"
+#include "ros2_ouster/core/packet_recorder.hpp"
+#include "ros2_ouster/core/recording_format.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+constexpr double FlightRecorder::MAX_PACKET_RATE;
+constexpr double FlightRecorder::LOSS_BURST;
+constexpr std::chrono::seconds FlightRecorder::DUMP_DELAY;
+
+namespace
+{
+
+constexpr char RING_MAGIC[8] = {'O', 'U', 'S', 'T', 'R', 'I', 'N', 'G'};
+constexpr uint32_t RING_VERSION = 1;
+
+inline std::size_t align8(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+int64_t steadyNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+/**
+ * Ring file: RingHeader, metadata as JSON padded to 8 bytes, then
+ * slot_count slots of slot_size bytes. Packet n is in slot n % slot_count,
+ * whose sequence is 2n + 1 while it is written and 2n + 2 once complete.
+ */
+struct FlightRecorder::RingHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t metadata_size;
+  uint64_t slot_count;
+  uint64_t slot_size;
+  uint64_t slots_offset;
+  uint64_t span_ns;
+  std::atomic<uint64_t> head;       // packets written
+  std::atomic<uint32_t> active;     // 1 while a recorder owns the ring
+  uint32_t reserved;
+};
+
+struct FlightRecorder::SlotHeader
+{
+  std::atomic<uint64_t> sequence;
+  uint64_t receive_time;
+  uint32_t size;
+  uint32_t state;
+};
+
+FlightRecorder::FlightRecorder(
+  const std::string & path, const Metadata & mdata, std::chrono::nanoseconds span)
+: _path(path),
+  _metadata(recording::metadataToJson(mdata)),
+  _map(nullptr),
+  _map_size(0),
+  _header(nullptr),
+  _span(span),
+  _loss(mdata.lidar_vendor == std::string("OLE_3D_V2")),
+  _pending(nullptr),
+  _quiet_until(0),
+  _stop(false)
+{
+  _recovered = recover(path);
+
+  const std::size_t packet_size = static_cast<std::size_t>(
+    std::max(std::max(mdata.lidar_packet_size, mdata.imu_packet_size), 1));
+  const std::size_t slot_size = align8(sizeof(SlotHeader) + packet_size);
+  const std::size_t slot_count = std::max<std::size_t>(
+    static_cast<std::size_t>(std::ceil(
+      std::chrono::duration<double>(span).count() * MAX_PACKET_RATE)), 16);
+  const std::size_t slots_offset = align8(sizeof(RingHeader) + _metadata.size());
+  _map_size = slots_offset + slot_count * slot_size;
+
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw OusterDriverException(
+            "Failed to create flight recorder " + path + ": " + std::strerror(errno));
+  }
+
+  const int err = posix_fallocate(fd, 0, static_cast<off_t>(_map_size));
+  if (err != 0) {
+    ::close(fd);
+    throw OusterDriverException(
+            "Failed to allocate " + std::to_string(_map_size) + " bytes for flight recorder " +
+            path + ": " + std::strerror(err));
+  }
+
+  void * map = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    throw OusterDriverException(
+            "Failed to map flight recorder " + path + ": " + std::strerror(errno));
+  }
+  _map = static_cast<uint8_t *>(map);
+
+  _header = new (_map) RingHeader;
+  std::memcpy(_header->magic, RING_MAGIC, sizeof(_header->magic));
+  _header->version = RING_VERSION;
+  _header->metadata_size = static_cast<uint32_t>(_metadata.size());
+  _header->slot_count = slot_count;
+  _header->slot_size = slot_size;
+  _header->slots_offset = slots_offset;
+  _header->span_ns = static_cast<uint64_t>(span.count());
+  _header->head.store(0, std::memory_order_relaxed);
+  std::memcpy(_map + sizeof(RingHeader), _metadata.data(), _metadata.size());
+
+  // constructing the slots also faults in every page of the ring now,
+  // rather than on the receive path
+  for (std::size_t i = 0; i < slot_count; i++) {
+    SlotHeader * slot = new (_map + slots_offset + i * slot_size) SlotHeader;
+    slot->sequence.store(0, std::memory_order_relaxed);
+  }
+  _header->active.store(1, std::memory_order_release);
+
+  _worker = std::thread(&FlightRecorder::worker, this);
+}
+
+FlightRecorder::~FlightRecorder()
+{
+  {
+    std::lock_guard<std::mutex> lock(_worker_mutex);
+    _stop = true;
+  }
+  _worker_cv.notify_one();
+  _worker.join();
+
+  // a clean shutdown leaves nothing to recover
+  _header->active.store(0, std::memory_order_release);
+  munmap(_map, _map_size);
+  unlink(_path.c_str());
+}
+
+void FlightRecorder::write(const Packet & packet)
+{
+  const std::size_t payload_size = _header->slot_size - sizeof(SlotHeader);
+  if (packet.size > payload_size) {
+    return;
+  }
+
+  const uint64_t n = _header->head.load(std::memory_order_relaxed);
+  SlotHeader * slot = reinterpret_cast<SlotHeader *>(
+    _map + _header->slots_offset + (n % _header->slot_count) * _header->slot_size);
+
+  slot->sequence.store(2 * n + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->receive_time = packet.receive_time;
+  slot->size = static_cast<uint32_t>(packet.size);
+  slot->state = static_cast<uint32_t>(packet.state);
+  std::memcpy(reinterpret_cast<uint8_t *>(slot) + sizeof(SlotHeader), packet.data, packet.size);
+  slot->sequence.store(2 * n + 2, std::memory_order_release);
+  _header->head.store(n + 1, std::memory_order_release);
+
+  if (packet.state != ClientState::LIDAR_DATA) {
+    return;
+  }
+
+  if (_loss.update(packet.data) > LOSS_BURST) {
+    trigger("packet_loss");
+  }
+}
+
+void FlightRecorder::trigger(const char * reason)
+{
+  if (steadyNow() < _quiet_until.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  const char * expected = nullptr;
+  _pending.compare_exchange_strong(expected, reason, std::memory_order_release);
+}
+
+std::string FlightRecorder::dump(const std::string & reason)
+{
+  std::lock_guard<std::mutex> lock(_dump_mutex);
+  return dumpRing(_map, _metadata, dumpPath(_path, reason));
+}
+
+void FlightRecorder::setDumpCallback(DumpCallback callback)
+{
+  std::lock_guard<std::mutex> lock(_worker_mutex);
+  _callback = std::move(callback);
+}
+
+void FlightRecorder::worker()
+{
+  std::unique_lock<std::mutex> lock(_worker_mutex);
+  while (!_stop) {
+    // triggers are lock free, they are polled
+    _worker_cv.wait_for(lock, std::chrono::milliseconds(100));
+    const char * reason = _pending.load(std::memory_order_acquire);
+    if (!reason) {
+      continue;
+    }
+
+    // keep what follows the anomaly too, unless shutting down
+    _worker_cv.wait_for(lock, DUMP_DELAY, [this]() {return _stop;});
+    DumpCallback callback = _callback;
+    lock.unlock();
+
+    std::string path;
+    try {
+      path = dump(reason);
+    } catch (const OusterDriverException &) {
+      path.clear();
+    }
+    _quiet_until.store(
+      steadyNow() + _span.count(), std::memory_order_relaxed);
+    _pending.store(nullptr, std::memory_order_release);
+    if (callback) {
+      callback(path, reason);
+    }
+
+    lock.lock();
+  }
+}
+
+std::string FlightRecorder::dumpPath(const std::string & path, const std::string & reason)
+{
+  std::string base = path;
+  const std::string extension = ".ring";
+  if (base.size() > extension.size() &&
+    base.compare(base.size() - extension.size(), extension.size(), extension) == 0)
+  {
+    base.resize(base.size() - extension.size());
+  }
+
+  const auto now = std::chrono::system_clock::now();
+  const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+  const int millis = static_cast<int>(
+    std::chrono::duration_cast<std::chrono::milliseconds>(
+      now.time_since_epoch()).count() % 1000);
+  std::tm tm;
+  localtime_r(&seconds, &tm);
+  char stamp[32];
+  std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &tm);
+  char suffix[48];
+  std::snprintf(suffix, sizeof(suffix), "_%s_%03d_", stamp, millis);
+  return base + suffix + reason + ".rec";
+}
+
+std::string FlightRecorder::dumpRing(
+  uint8_t * map, const std::string & metadata, const std::string & path)
+{
+  const RingHeader * header = reinterpret_cast<const RingHeader *>(map);
+  const uint8_t * slots = map + header->slots_offset;
+  const uint64_t count = header->slot_count;
+  const uint64_t slot_size = header->slot_size;
+  const uint64_t head = header->head.load(std::memory_order_acquire);
+  const uint64_t first = head > count ? head - count : 0;
+
+  // copies a packet out of its slot, false if it was overwritten meanwhile
+  std::vector<uint8_t> data(slot_size);
+  auto read = [&](uint64_t n, Packet & packet) {
+      const SlotHeader * slot =
+        reinterpret_cast<const SlotHeader *>(slots + (n % count) * slot_size);
+      const uint64_t expected = 2 * n + 2;
+      if (slot->sequence.load(std::memory_order_acquire) != expected) {
+        return false;
+      }
+      packet.receive_time = slot->receive_time;
+      packet.size = std::min<std::size_t>(slot->size, slot_size - sizeof(SlotHeader));
+      packet.state = static_cast<ClientState>(slot->state);
+      std::memcpy(data.data(), reinterpret_cast<const uint8_t *>(slot) + sizeof(SlotHeader),
+        packet.size);
+      packet.data = data.data();
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return slot->sequence.load(std::memory_order_relaxed) == expected;
+    };
+
+  // only the packets within the span of the newest one
+  Packet packet;
+  uint64_t oldest = 0;
+  if (head > 0 && read(head - 1, packet) && packet.receive_time > header->span_ns) {
+    oldest = packet.receive_time - header->span_ns;
+  }
+
+  PacketRecorder recorder(
+    path, recording::metadataFromJson(metadata), static_cast<std::size_t>(count * slot_size));
+  for (uint64_t n = first; n < head; n++) {
+    if (read(n, packet) && packet.receive_time >= oldest) {
+      recorder.write(packet);
+    }
+  }
+  recorder.close();
+  return path;
+}
+
+std::string FlightRecorder::recover(const std::string & path)
+{
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return std::string();
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(RingHeader))) {
+    ::close(fd);
+    return std::string();
+  }
+
+  const std::size_t size = static_cast<std::size_t>(st.st_size);
+  void * map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return std::string();
+  }
+
+  uint8_t * ring = static_cast<uint8_t *>(map);
+  const RingHeader * header = reinterpret_cast<const RingHeader *>(ring);
+  std::string dumped;
+  if (std::memcmp(header->magic, RING_MAGIC, sizeof(header->magic)) == 0 &&
+    header->version == RING_VERSION &&
+    header->active.load(std::memory_order_acquire) == 1 &&
+    header->head.load(std::memory_order_acquire) > 0 &&
+    header->slot_size > sizeof(SlotHeader) &&
+    sizeof(RingHeader) + header->metadata_size <= header->slots_offset &&
+    header->slots_offset + header->slot_count * header->slot_size <= size)
+  {
+    const std::string metadata(
+      reinterpret_cast<const char *>(ring + sizeof(RingHeader)), header->metadata_size);
+    try {
+      dumped = dumpRing(ring, metadata, dumpPath(path, "crash"));
+    } catch (const OusterDriverException &) {
+      dumped.clear();
+    }
+  }
+
+  munmap(map, size);
+  return dumped;
+}
+
+}  // namespace ros2_ouster
@@ -0,0 +1,279 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "ros2_ouster/core/frame_decoder.hpp"
+#include "ros2_ouster/core/tracing.hpp"
+#include "ros2_ouster/OS1/OS1_util.hpp"
+
+namespace ros2_ouster
+{
+
+FrameDecoder::FrameDecoder(const Metadata & mdata, uint32_t max_width)
+: _is_3d(mdata.lidar_vendor == std::string("OLE_3D_V2")),
+  _height(_is_3d ? 16 : 1),
+  _max_width(max_width),
+  _sin_lut(OS1::make_sin_lut()),
+  _cos_lut(OS1::make_cos_lut()),
+  _x_offset_array(mdata.x_offset_array),
+  _y_offset_array(mdata.y_offset_array),
+  _completed(1),
+  _receive_time(0),
+  _decimation(1),
+  _next_decimation(1)
+{
+  // calibration arrays are indexed by ring, pad missing entries
+  _x_offset_array.resize(_height, 0.0);
+  _y_offset_array.resize(_height, 0.0);
+
+  // vertical angle of each ring as an index into the trigonometric tables
+  for (uint32_t ring = 0; ring < _height; ring++) {
+    const double av = ring < mdata.av_offset_array.size() ? mdata.av_offset_array[ring] : 0.0;
+    _av_offset_lut.push_back(
+      static_cast<uint32_t>(static_cast<int32_t>(av * 100) + 36000) % 36000);
+  }
+
+  for (auto & frame : _frames) {
+    frame.height = _height;
+    frame.points.resize(static_cast<std::size_t>(_max_width) * _height);
+  }
+
+  reset();
+}
+
+void FrameDecoder::setFrameCallback(FrameCallback callback)
+{
+  _callback = std::move(callback);
+}
+
+void FrameDecoder::reset()
+{
+  _id_frame = 0;
+  _packets = 0;
+  _id_col = 0;
+  _azimuth_last = -1;
+  _ts_last = -1;
+  _decimation = _next_decimation;
+}
+
+bool FrameDecoder::decode(const uint8_t * packet, uint64_t receive_time)
+{
+  _receive_time = receive_time;
+  _packets++;
+  ROS2_OUSTER_TRACEPOINT(decode_start, _id_frame, _packets);
+  const bool completed = _is_3d ? decodeOLE3DV2(packet) : decodeOLE2DV2(packet);
+  ROS2_OUSTER_TRACEPOINT(decode_end, _id_frame, _packets, completed ? 1 : 0);
+  return completed;
+}
+
+bool FrameDecoder::wrapsAround(
+  const uint8_t * packet, bool is_3d, int32_t & azimuth_last)
+{
+  // same layouts and wrap condition as the decoding below
+  const int columns = is_3d ? 12 : 150;
+  const int offset = is_3d ? 2 : 40;
+  const int stride = is_3d ? 100 : 8;
+
+  bool wrapped = false;
+  for (int icol = 0; icol < columns; icol++) {
+    uint16_t azimuth;
+    std::memcpy(&azimuth, packet + offset + stride * icol, sizeof(uint16_t));
+    if (azimuth_last != -1 && std::abs(azimuth_last - azimuth) > 10000) {
+      wrapped = true;
+    }
+    azimuth_last = azimuth;
+  }
+  return wrapped;
+}
+
+int32_t FrameDecoder::firstAzimuth(const uint8_t * packet, bool is_3d)
+{
+  uint16_t azimuth;
+  std::memcpy(&azimuth, packet + (is_3d ? 2 : 40), sizeof(uint16_t));
+  return azimuth < 36000 ? azimuth : -1;
+}
+
+void FrameDecoder::completeFrame(uint64_t timestamp)
+{
+  const int assembling = 1 - _completed;
+  LidarFrame & frame = _frames[assembling];
+  frame.id = _id_frame;
+  frame.timestamp = timestamp;
+  frame.receive_time = _receive_time;
+  frame.width = std::min((_id_col + _decimation - 1) / _decimation, _max_width);
+  frame.packets = _packets;
+  ROS2_OUSTER_TRACEPOINT(
+    frame_complete, frame.id, frame.packets, frame.width, frame.timestamp, frame.receive_time);
+
+  // the next frame is assembled in the other buffer
+  _completed = assembling;
+
+  if (_callback) {
+    _callback(frame);
+  }
+}
+
+bool FrameDecoder::decodeOLE3DV2(const uint8_t * packet)
+{
+  // 12 blocks of 100 bytes: flag, azimuth and 32 returns of 3 bytes,
+  // each block holding two firings of the 16 lasers
+  uint16_t azimuth_array[12];
+  for (int icol = 0; icol < 12; icol++) {
+    std::memcpy(&azimuth_array[icol], packet + 100 * icol + 2, sizeof(uint16_t));
+  }
+
+  double div_azimuth;
+  if (azimuth_array[11] >= azimuth_array[0]) {
+    div_azimuth = (azimuth_array[11] - azimuth_array[0]);
+  } else {
+    div_azimuth = (azimuth_array[11] + 36000 - azimuth_array[0]);
+  }
+  div_azimuth /= (11 * 32);
+
+  // timestamp in us
+  uint32_t ts;
+  std::memcpy(&ts, packet + 1200, sizeof(uint32_t));
+
+  bool completed = false;
+  for (int icol = 0; icol < 12; icol++) {
+    const uint16_t azimuth = azimuth_array[icol];
+    if (_azimuth_last != -1 && std::abs(_azimuth_last - azimuth) > 10000) {
+      // wrapped around, the frame is complete
+      // a packet counts in the frame its first column is decoded into,
+      // decode() counted it in the completed one
+      if (icol == 0) {
+        _packets--;
+      }
+      if (_ts_last != -1) {
+        completeFrame(static_cast<uint64_t>(_ts_last * 1e3));
+        completed = true;
+      }
+      _id_frame++;
+      _packets = icol == 0 ? 1 : 0;
+      _id_col = 0;
+      _ts_last = ts;
+      _decimation = _next_decimation;
+    }
+    _azimuth_last = azimuth;
+
+    LidarPoint * points = _frames[1 - _completed].points.data();
+    for (int irow = 0; irow < 32; irow++) {
+      const uint8_t * ret = packet + 100 * icol + 4 + irow * 3;
+      uint16_t distance;
+      std::memcpy(&distance, ret, sizeof(uint16_t));
+      const uint8_t intensity = ret[2];
+
+      uint32_t azimuth_ring = azimuth;
+      azimuth_ring += (uint32_t)(irow * div_azimuth);
+      azimuth_ring += 36000;
+      azimuth_ring %= 36000;
+
+      const float r = distance * 0.002;
+      const uint8_t ring = irow % 16;
+      const uint32_t av = _av_offset_lut[ring];
+
+      const uint32_t col = _id_col / _decimation;
+      if (_id_col % _decimation == 0 && col < _max_width) {
+        LidarPoint & pt = points[col * 16 + ring];
+        pt.x = r * _cos_lut[av] * _sin_lut[azimuth_ring] +
+          _x_offset_array[ring] * _cos_lut[azimuth_ring] * 0.001;
+        pt.y = r * _cos_lut[av] * _cos_lut[azimuth_ring] -
+          _x_offset_array[ring] * _sin_lut[azimuth_ring] * 0.001;
+        pt.z = r * _sin_lut[av] + _y_offset_array[ring] * 0.001;
+        pt.intensity = intensity;
+        pt.t = static_cast<uint32_t>((ts - _ts_last) * 1e3);
+        pt.reflectivity = 0;
+        pt.ring = ring;
+        pt.noise = 0;
+        pt.range = distance * 2;
+      }
+
+      if (ring == 15) {
+        _id_col++;
+      }
+    }
+  }
+
+  return completed;
+}
+
+bool FrameDecoder::decodeOLE2DV2(const uint8_t * packet)
+{
+  // timestamp in ms
+  uint32_t ts;
+  std::memcpy(&ts, packet + 28, sizeof(uint32_t));
+
+  // 150 returns of 8 bytes: azimuth, distance and intensity
+  bool completed = false;
+  for (int icol = 0; icol < 150; icol++) {
+    const uint8_t * ret = packet + 40 + 8 * icol;
+    uint16_t azimuth;
+    std::memcpy(&azimuth, ret, sizeof(uint16_t));
+
+    if (_azimuth_last != -1 && std::abs(_azimuth_last - azimuth) > 10000) {
+      // wrapped around, the frame is complete. Invalid azimuths of 0xFFFF
+      // also trigger a wrap, those short frames are not reported.
+      // a packet counts in the frame its first column is decoded into,
+      // decode() counted it in the completed one
+      if (icol == 0) {
+        _packets--;
+      }
+      if (_ts_last != -1 && _id_col > 200) {
+        completeFrame(static_cast<uint64_t>(_ts_last * 1e6));
+        completed = true;
+      }
+      _id_frame++;
+      _packets = icol == 0 ? 1 : 0;
+      _id_col = 0;
+      _ts_last = ts;
+      _decimation = _next_decimation;
+    }
+    _azimuth_last = azimuth;
+
+    uint16_t distance;
+    uint16_t intensity;
+    std::memcpy(&distance, ret + 2, sizeof(uint16_t));
+    std::memcpy(&intensity, ret + 4, sizeof(uint16_t));
+
+    if (distance >= 0xFFF0) {
+      distance = 0;
+      intensity = 0;
+    }
+
+    const uint32_t azimuth_ring = (azimuth + 36000u) % 36000;
+    const float r = distance * 0.001;
+
+    const uint32_t col = _id_col / _decimation;
+    if (_id_col % _decimation == 0 && col < _max_width) {
+      LidarPoint & pt = _frames[1 - _completed].points[col];
+      pt.x = r * _cos_lut[azimuth_ring];
+      pt.y = r * _sin_lut[azimuth_ring];
+      pt.z = 0;
+      pt.intensity = intensity;
+      pt.t = static_cast<uint32_t>((ts - _ts_last) * 1e6);
+      pt.reflectivity = 0;
+      pt.ring = 0;
+      pt.noise = 0;
+      pt.range = distance;
+    }
+
+    _id_col++;
+  }
+
+  return completed;
+}
+
+}  // namespace ros2_ouster
@@ -0,0 +1,199 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "ros2_ouster/core/frame_ring_reader.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+using frame_ring::RingHeader;
+using frame_ring::SlotHeader;
+
+FrameRingReader::FrameRingReader(const std::string & name)
+: _name(name),
+  _map(nullptr),
+  _map_size(0),
+  _header(nullptr),
+  _slots(nullptr),
+  _inode(0),
+  _last(0),
+  _lost(0)
+{
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    throw OusterDriverException(
+            "Failed to open shared memory " + name + ": " + std::strerror(errno));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(RingHeader))) {
+    ::close(fd);
+    throw OusterDriverException("Shared memory " + name + " is not a frame ring.");
+  }
+  _inode = static_cast<uint64_t>(st.st_ino);
+
+  _map_size = static_cast<std::size_t>(st.st_size);
+  void * map = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    throw OusterDriverException(
+            "Failed to map shared memory " + name + ": " + std::strerror(errno));
+  }
+  _map = static_cast<uint8_t *>(map);
+  _header = reinterpret_cast<RingHeader *>(_map);
+
+  const bool ready = std::memcmp(_header->magic, frame_ring::MAGIC, sizeof(_header->magic)) == 0;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!ready || _header->version != frame_ring::VERSION ||
+    _header->point_size != sizeof(LidarPoint) || _header->slot_count == 0 ||
+    _header->slot_size < frame_ring::align(sizeof(SlotHeader)) +
+    static_cast<std::size_t>(_header->max_points) * sizeof(LidarPoint) ||
+    (_map_size - frame_ring::align(sizeof(RingHeader))) / _header->slot_size <
+    _header->slot_count)
+  {
+    munmap(_map, _map_size);
+    throw OusterDriverException("Shared memory " + name + " is not a frame ring.");
+  }
+  _slots = _map + frame_ring::align(sizeof(RingHeader));
+
+  // the newest frame is the first handed out
+  const uint64_t head = _header->head.load(std::memory_order_acquire);
+  _last = head > 0 ? head - 1 : 0;
+  _header->readers.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameRingReader::~FrameRingReader()
+{
+  _header->readers.fetch_sub(1, std::memory_order_relaxed);
+  munmap(_map, _map_size);
+}
+
+bool FrameRingReader::next(FrameView & view)
+{
+  const uint64_t head = _header->head.load(std::memory_order_acquire);
+  uint64_t sequence = _last + 1;
+  if (head >= sequence && head - sequence >= _header->slot_count) {
+    // the writer went around the ring, the oldest frames are gone
+    const uint64_t oldest = head - _header->slot_count + 1;
+    _lost += oldest - sequence;
+    sequence = oldest;
+  }
+
+  for (; sequence <= head; sequence++) {
+    if (get(sequence, view)) {
+      _last = sequence;
+      return true;
+    }
+    _lost++;
+  }
+  _last = head > _last ? head : _last;
+  return false;
+}
+
+bool FrameRingReader::latest(FrameView & view)
+{
+  const uint64_t head = _header->head.load(std::memory_order_acquire);
+  if (head <= _last || !get(head, view)) {
+    return false;
+  }
+  _last = head;
+  return true;
+}
+
+bool FrameRingReader::valid(const FrameView & view) const
+{
+  if (view.sequence == 0) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot(view.sequence)->sequence.load(std::memory_order_relaxed) == 2 * view.sequence;
+}
+
+bool FrameRingReader::read(LidarFrame & frame)
+{
+  FrameView view;
+  while (next(view)) {
+    frame.id = view.id;
+    frame.timestamp = view.timestamp;
+    frame.receive_time = view.receive_time;
+    frame.width = view.width;
+    frame.height = view.height;
+    frame.points.assign(view.points, view.points + view.size());
+    if (valid(view)) {
+      return true;
+    }
+    _lost++;
+  }
+  return false;
+}
+
+bool FrameRingReader::closed() const
+{
+  if (_header->closed.load(std::memory_order_acquire) != 0) {
+    return true;
+  }
+
+  // a writer that crashed leaves the ring open, its replacement creates
+  // a new object under the same name
+  const int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return true;
+  }
+  struct stat st;
+  const bool same = fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_ino) == _inode;
+  ::close(fd);
+  return !same;
+}
+
+bool FrameRingReader::get(uint64_t sequence, FrameView & view) const
+{
+  const SlotHeader * header = slot(sequence);
+  const uint64_t begin = header->sequence.load(std::memory_order_acquire);
+  if (begin != 2 * sequence) {
+    return false;
+  }
+
+  view.sequence = sequence;
+  view.id = header->id;
+  view.timestamp = header->timestamp;
+  view.receive_time = header->receive_time;
+  view.width = header->width;
+  view.height = header->height;
+  view.points = reinterpret_cast<const LidarPoint *>(
+    reinterpret_cast<const uint8_t *>(header) + frame_ring::align(sizeof(SlotHeader)));
+
+  // the header must be consistent for the size to be trusted, the points
+  // are checked by the caller with valid()
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return header->sequence.load(std::memory_order_relaxed) == begin &&
+         view.size() <= _header->max_points;
+}
+
+const SlotHeader * FrameRingReader::slot(uint64_t sequence) const
+{
+  return reinterpret_cast<const SlotHeader *>(
+    _slots + ((sequence - 1) % _header->slot_count) * _header->slot_size);
+}
+
+}  // namespace ros2_ouster
@@ -0,0 +1,154 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "ros2_ouster/core/frame_ring_writer.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+using frame_ring::RingHeader;
+using frame_ring::SlotHeader;
+
+namespace
+{
+
+/**
+ * @brief Mark a ring left by a previous writer as closed, so that its
+ * readers move to the new one
+ */
+void closeExisting(const std::string & name)
+{
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(RingHeader))) {
+    void * map = mmap(nullptr, sizeof(RingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map != MAP_FAILED) {
+      RingHeader * header = static_cast<RingHeader *>(map);
+      if (std::memcmp(header->magic, frame_ring::MAGIC, sizeof(header->magic)) == 0) {
+        header->closed.store(1, std::memory_order_release);
+      }
+      munmap(map, sizeof(RingHeader));
+    }
+  }
+  ::close(fd);
+}
+
+}  // namespace
+
+FrameRingWriter::FrameRingWriter(
+  const std::string & name, std::size_t slot_count, std::size_t max_points)
+: _name(name),
+  _map(nullptr),
+  _map_size(0),
+  _header(nullptr),
+  _slots(nullptr),
+  _written(0)
+{
+  slot_count = std::max<std::size_t>(slot_count, 1);
+  const std::size_t slot_size =
+    frame_ring::align(sizeof(SlotHeader)) + frame_ring::align(max_points * sizeof(LidarPoint));
+  _map_size = frame_ring::align(sizeof(RingHeader)) + slot_count * slot_size;
+
+  // readers of a previous ring keep their mapping, a new object is created
+  closeExisting(name);
+  shm_unlink(name.c_str());
+  const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0) {
+    throw OusterDriverException(
+            "Failed to create shared memory " + name + ": " + std::strerror(errno));
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(_map_size)) != 0) {
+    const int err = errno;
+    ::close(fd);
+    shm_unlink(name.c_str());
+    throw OusterDriverException(
+            "Failed to size shared memory " + name + ": " + std::strerror(err));
+  }
+
+  void * map = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    throw OusterDriverException(
+            "Failed to map shared memory " + name + ": " + std::strerror(errno));
+  }
+  _map = static_cast<uint8_t *>(map);
+  _slots = _map + frame_ring::align(sizeof(RingHeader));
+
+  // the memory is zeroed: no frame yet. The magic comes last, readers
+  // attaching before are turned away.
+  _header = reinterpret_cast<RingHeader *>(_map);
+  _header->version = frame_ring::VERSION;
+  _header->slot_count = static_cast<uint32_t>(slot_count);
+  _header->slot_size = slot_size;
+  _header->max_points = static_cast<uint32_t>(max_points);
+  _header->point_size = static_cast<uint32_t>(sizeof(LidarPoint));
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(_header->magic, frame_ring::MAGIC, sizeof(_header->magic));
+}
+
+FrameRingWriter::~FrameRingWriter()
+{
+  _header->closed.store(1, std::memory_order_release);
+  munmap(_map, _map_size);
+  shm_unlink(_name.c_str());
+}
+
+void FrameRingWriter::write(const LidarFrame & frame)
+{
+  const uint64_t sequence = _written + 1;
+  SlotHeader * slot = reinterpret_cast<SlotHeader *>(
+    _slots + ((sequence - 1) % _header->slot_count) * _header->slot_size);
+  LidarPoint * points = reinterpret_cast<LidarPoint *>(
+    reinterpret_cast<uint8_t *>(slot) + frame_ring::align(sizeof(SlotHeader)));
+
+  // whole columns that fit in the slot
+  uint32_t width = frame.width;
+  if (frame.height > 0 && frame.size() > _header->max_points) {
+    width = _header->max_points / frame.height;
+  }
+
+  slot->sequence.store(2 * sequence - 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot->id = frame.id;
+  slot->timestamp = frame.timestamp;
+  slot->receive_time = frame.receive_time;
+  slot->width = width;
+  slot->height = frame.height;
+  std::memcpy(
+    points, frame.points.data(),
+    static_cast<std::size_t>(width) * frame.height * sizeof(LidarPoint));
+
+  slot->sequence.store(2 * sequence, std::memory_order_release);
+  _header->head.store(sequence, std::memory_order_release);
+  _written = sequence;
+}
+
+}  // namespace ros2_ouster
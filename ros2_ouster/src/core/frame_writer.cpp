@@ -0,0 +1,283 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "ros2_ouster/core/frame_writer.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+namespace
+{
+
+// bytes of a point in the files: x, y, z, intensity, t, reflectivity,
+// ring, noise and range, packed
+constexpr std::size_t POINT_SIZE = 4 * 4 + 4 + 2 + 1 + 2 + 4;
+
+template<typename T>
+inline uint8_t * put(uint8_t * out, T value)
+{
+  std::memcpy(out, &value, sizeof(T));
+  return out + sizeof(T);
+}
+
+std::string pcdHeader(const LidarFrame & frame)
+{
+  return
+    "# .PCD v0.7 - Point Cloud Data file format\n"
+    "VERSION 0.7\n"
+    "FIELDS x y z intensity t reflectivity ring noise range\n"
+    "SIZE 4 4 4 4 4 2 1 2 4\n"
+    "TYPE F F F F U U U U U\n"
+    "COUNT 1 1 1 1 1 1 1 1 1\n"
+    "WIDTH " + std::to_string(frame.width) + "\n"
+    "HEIGHT " + std::to_string(frame.height) + "\n"
+    "VIEWPOINT 0 0 0 1 0 0 0\n"
+    "POINTS " + std::to_string(frame.size()) + "\n"
+    "DATA binary\n";
+}
+
+std::string plyHeader(const LidarFrame & frame)
+{
+  return
+    "ply\n"
+    "format binary_little_endian 1.0\n"
+    "comment frame " + std::to_string(frame.id) + "\n"
+    "obj_info width " + std::to_string(frame.width) +
+    " height " + std::to_string(frame.height) + "\n"
+    "element vertex " + std::to_string(frame.size()) + "\n"
+    "property float x\n"
+    "property float y\n"
+    "property float z\n"
+    "property float intensity\n"
+    "property uint t\n"
+    "property ushort reflectivity\n"
+    "property uchar ring\n"
+    "property ushort noise\n"
+    "property uint range\n"
+    "end_header\n";
+}
+
+}  // namespace
+
+constexpr std::size_t FrameWriter::ALIGNMENT;
+
+FrameFileFormat toFrameFileFormat(const std::string & name)
+{
+  if (name == "pcd") {
+    return FrameFileFormat::PCD;
+  } else if (name == "ply") {
+    return FrameFileFormat::PLY;
+  }
+  throw OusterDriverException("Unknown frame file format " + name + ", expected pcd or ply.");
+}
+
+FrameWriter::FrameWriter(
+  const std::string & directory, FrameFileFormat format, bool direct_io)
+: _directory(directory),
+  _format(format),
+  _direct_io(direct_io),
+  _has_pending(false),
+  _buffer(nullptr),
+  _buffer_size(0),
+  _stop(false),
+  _written(0),
+  _skipped(0),
+  _failed(0)
+{
+  if (_directory.empty()) {
+    _directory = ".";
+  }
+  if (mkdir(_directory.c_str(), 0755) != 0 && errno != EEXIST) {
+    throw OusterDriverException(
+            "Failed to create directory " + _directory + ": " + std::strerror(errno));
+  }
+
+  _worker = std::thread(&FrameWriter::worker, this);
+}
+
+FrameWriter::~FrameWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_one();
+  _worker.join();
+  std::free(_buffer);
+}
+
+bool FrameWriter::write(const LidarFrame & frame)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_has_pending) {
+      _skipped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    // only the valid points are copied, the capacity is kept between frames
+    _pending.id = frame.id;
+    _pending.timestamp = frame.timestamp;
+    _pending.receive_time = frame.receive_time;
+    _pending.width = frame.width;
+    _pending.height = frame.height;
+    _pending.points.assign(frame.points.begin(), frame.points.begin() + frame.size());
+    _has_pending = true;
+  }
+  _cv.notify_one();
+  return true;
+}
+
+std::string FrameWriter::fileName(const LidarFrame & frame, FrameFileFormat format)
+{
+  // sorting the names sorts the frames by time
+  char name[64];
+  std::snprintf(
+    name, sizeof(name), "%" PRIu64 ".%09" PRIu64 "_%06" PRIu64 ".%s",
+    frame.timestamp / 1000000000u, frame.timestamp % 1000000000u, frame.id,
+    format == FrameFileFormat::PCD ? "pcd" : "ply");
+  return name;
+}
+
+void FrameWriter::worker()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _cv.wait(lock, [this] {return _stop || _has_pending;});
+    if (!_has_pending) {
+      break;
+    }
+    std::swap(_pending, _writing);
+    _has_pending = false;
+    lock.unlock();
+
+    const std::size_t size = serialize(_writing);
+    if (size > 0 && writeFile(_directory + "/" + fileName(_writing, _format), size)) {
+      _written.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      _failed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    lock.lock();
+  }
+}
+
+std::size_t FrameWriter::serialize(const LidarFrame & frame)
+{
+  const std::string header =
+    _format == FrameFileFormat::PCD ? pcdHeader(frame) : plyHeader(frame);
+  const std::size_t size = header.size() + frame.size() * POINT_SIZE;
+  if (!reserve(size)) {
+    return 0;
+  }
+
+  std::memcpy(_buffer, header.data(), header.size());
+  uint8_t * out = _buffer + header.size();
+
+  // frames are column major, files hold the rings one after the other
+  for (uint32_t ring = 0; ring < frame.height; ring++) {
+    for (uint32_t col = 0; col < frame.width; col++) {
+      const LidarPoint & pt = frame.points[col * frame.height + ring];
+      out = put(out, pt.x);
+      out = put(out, pt.y);
+      out = put(out, pt.z);
+      out = put(out, pt.intensity);
+      out = put(out, pt.t);
+      out = put(out, pt.reflectivity);
+      out = put(out, pt.ring);
+      out = put(out, pt.noise);
+      out = put(out, pt.range);
+    }
+  }
+  return size;
+}
+
+bool FrameWriter::writeFile(const std::string & path, std::size_t size)
+{
+  const std::string tmp_path = path + ".tmp";
+  int fd = -1;
+  if (_direct_io) {
+    fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    if (fd < 0 && errno == EINVAL) {
+      // not supported by the file system
+      _direct_io = false;
+    }
+  }
+  if (!_direct_io) {
+    fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  }
+  if (fd < 0) {
+    return false;
+  }
+
+  // direct I/O writes whole aligned blocks, the padding is cut after
+  const std::size_t write_size =
+    _direct_io ? (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1) : size;
+  std::memset(_buffer + size, 0, write_size - size);
+
+  bool ok = true;
+  std::size_t offset = 0;
+  while (offset < write_size) {
+    const ssize_t written = ::write(fd, _buffer + offset, write_size - offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ok = false;
+      break;
+    }
+    offset += static_cast<std::size_t>(written);
+  }
+  if (ok && write_size != size) {
+    ok = ftruncate(fd, static_cast<off_t>(size)) == 0;
+  }
+  ok = ::close(fd) == 0 && ok;
+
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool FrameWriter::reserve(std::size_t size)
+{
+  const std::size_t needed = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  if (needed <= _buffer_size) {
+    return true;
+  }
+
+  void * buffer = nullptr;
+  if (posix_memalign(&buffer, ALIGNMENT, needed) != 0) {
+    return false;
+  }
+  std::free(_buffer);
+  _buffer = static_cast<uint8_t *>(buffer);
+  _buffer_size = needed;
+  return true;
+}
+
+}  // namespace ros2_ouster
@@ -0,0 +1,172 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ros2_ouster/core/health_monitor.hpp"
+
+namespace ros2_ouster
+{
+
+namespace
+{
+
+std::string format(const char * format, double value)
+{
+  char buffer[64];
+  std::snprintf(buffer, sizeof(buffer), format, value);
+  return buffer;
+}
+
+uint64_t delta(uint64_t value, uint64_t earlier)
+{
+  return value > earlier ? value - earlier : 0;
+}
+
+}  // namespace
+
+HealthSample HealthSample::take(
+  const PipelineStatistics & statistics, uint64_t kernel_drops, uint64_t user_drops, bool idle)
+{
+  const PipelineCounters & counters = statistics.counters();
+  HealthSample sample;
+  sample.time = std::chrono::steady_clock::now();
+  sample.idle = idle;
+  sample.lidar_packets = counters.total(PipelineCounter::LIDAR_PACKETS);
+  sample.imu_packets = counters.total(PipelineCounter::IMU_PACKETS);
+  sample.decoded_packets = counters.total(PipelineCounter::DECODED_PACKETS);
+  sample.frames = counters.total(PipelineCounter::FRAMES);
+  sample.frame_packets = counters.total(PipelineCounter::FRAME_PACKETS);
+  sample.missing_packets = counters.total(PipelineCounter::MISSING_PACKETS);
+  sample.kernel_drops = kernel_drops;
+  sample.user_drops = user_drops;
+  sample.decode = statistics.stage(PipelineStage::DECODE).snapshot();
+  sample.publish = statistics.stage(PipelineStage::PUBLISH).snapshot();
+  return sample;
+}
+
+HealthMonitor::HealthMonitor(const HealthThresholds & thresholds)
+: _thresholds(thresholds)
+{
+  _last.time = std::chrono::steady_clock::now();
+}
+
+void HealthMonitor::restart(const HealthSample & sample)
+{
+  _last = sample;
+}
+
+HealthReport HealthMonitor::update(const HealthSample & sample)
+{
+  HealthReport report;
+  const HealthSample last = _last;
+  _last = sample;
+
+  if (sample.idle) {
+    report.message = "Idle, no subscribers";
+    return report;
+  }
+
+  const double period = std::chrono::duration<double>(sample.time - last.time).count();
+  if (period <= 0.0) {
+    report.level = HealthLevel::STALE;
+    report.message = "No time elapsed";
+    return report;
+  }
+
+  const uint64_t lidar_packets = delta(sample.lidar_packets, last.lidar_packets);
+  const uint64_t decoded_packets = delta(sample.decoded_packets, last.decoded_packets);
+  const uint64_t frames = delta(sample.frames, last.frames);
+  const uint64_t frame_packets = delta(sample.frame_packets, last.frame_packets);
+  const uint64_t missing_packets = delta(sample.missing_packets, last.missing_packets);
+  const uint64_t kernel_drops = delta(sample.kernel_drops, last.kernel_drops);
+  const uint64_t user_drops = delta(sample.user_drops, last.user_drops);
+  const LatencyHistogram::Snapshot decode = sample.decode.since(last.decode);
+  const LatencyHistogram::Snapshot publish = sample.publish.since(last.publish);
+
+  const double packet_rate = lidar_packets / period;
+  const double frame_rate = frames / period;
+  const double completeness = frame_packets + missing_packets > 0 ?
+    static_cast<double>(frame_packets) / (frame_packets + missing_packets) : 1.0;
+  const double kernel_drop_rate = kernel_drops / period;
+  const double user_drop_rate = user_drops / period;
+  const double decode_p99 = decode.percentile(0.99) * 1e-9;
+  const double publish_p99 = publish.percentile(0.99) * 1e-9;
+
+  std::vector<std::string> problems;
+  auto warn = [&](const std::string & problem) {
+      report.level = std::max(report.level, HealthLevel::WARN);
+      problems.push_back(problem);
+    };
+
+  if (lidar_packets == 0) {
+    report.level = HealthLevel::ERROR;
+    problems.push_back("No lidar packets received");
+  } else if (_thresholds.min_packet_rate > 0.0 && packet_rate < _thresholds.min_packet_rate) {
+    warn("Low packet rate");
+  }
+
+  // frames are only checked when some processor decodes them
+  if (decoded_packets > 0) {
+    if (frames == 0) {
+      warn("No frames completed");
+    } else if (_thresholds.min_frame_rate > 0.0 && frame_rate < _thresholds.min_frame_rate) {
+      warn("Low frame rate");
+    }
+    if (_thresholds.min_completeness > 0.0 && completeness < _thresholds.min_completeness) {
+      warn("Incomplete frames");
+    }
+  }
+
+  if (kernel_drop_rate > _thresholds.max_kernel_drop_rate) {
+    warn("Packets dropped by the kernel");
+  }
+  if (user_drop_rate > _thresholds.max_user_drop_rate) {
+    warn("Stale outputs dropped");
+  }
+  if (_thresholds.max_decode_time > 0.0 && decode_p99 > _thresholds.max_decode_time) {
+    warn("Slow decoding");
+  }
+  if (_thresholds.max_publish_time > 0.0 && publish_p99 > _thresholds.max_publish_time) {
+    warn("Slow publishing");
+  }
+
+  if (problems.empty()) {
+    report.message = "OK";
+  }
+  for (std::size_t i = 0; i < problems.size(); i++) {
+    report.message += (i > 0 ? "; " : "") + problems[i];
+  }
+
+  report.values = {
+    {"Lidar packet rate (Hz)", format("%.1f", packet_rate)},
+    {"IMU packet rate (Hz)", format("%.1f", delta(sample.imu_packets, last.imu_packets) / period)},
+    {"Frame rate (Hz)", format("%.2f", frame_rate)},
+    {"Frame completeness", format("%.4f", completeness)},
+    {"Kernel drops", format("%.0f", static_cast<double>(kernel_drops))},
+    {"Kernel drops total", format("%.0f", static_cast<double>(sample.kernel_drops))},
+    {"Stale outputs dropped", format("%.0f", static_cast<double>(user_drops))},
+    {"Stale outputs dropped total", format("%.0f", static_cast<double>(sample.user_drops))},
+    {"Decode time mean (ms)", format("%.4f", decode.mean() * 1e-6)},
+    {"Decode time p99 (ms)", format("%.4f", decode_p99 * 1e3)},
+    {"Publish time mean (ms)", format("%.4f", publish.mean() * 1e-6)},
+    {"Publish time p99 (ms)", format("%.4f", publish_p99 * 1e3)},
+    {"Period (s)", format("%.3f", period)},
+  };
+  return report;
+}
+
+}  // namespace ros2_ouster
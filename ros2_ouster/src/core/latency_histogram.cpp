@@ -0,0 +1,186 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ros2_ouster/core/latency_histogram.hpp"
+
+namespace ros2_ouster
+{
+
+constexpr unsigned LatencyHistogram::SUB_BUCKET_BITS;
+constexpr unsigned LatencyHistogram::MAX_VALUE_BITS;
+constexpr std::size_t LatencyHistogram::SUB_BUCKETS;
+constexpr std::size_t LatencyHistogram::BUCKETS;
+
+double LatencyHistogram::Snapshot::mean() const
+{
+  return count > 0 ? static_cast<double>(sum) / count : 0.0;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double ratio) const
+{
+  if (count == 0) {
+    return 0;
+  }
+
+  // rank of the value, counting from 1
+  ratio = std::min(std::max(ratio, 0.0), 1.0);
+  const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(ratio * count + 0.5), 1);
+  uint64_t seen = 0;
+  for (std::size_t i = 0; i < counts.size(); i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min((lowest(i) + highest(i)) / 2, max);
+    }
+  }
+  return max;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Snapshot::since(const Snapshot & earlier) const
+{
+  Snapshot delta;
+  delta.counts.resize(counts.size(), 0);
+  for (std::size_t i = 0; i < counts.size() && i < earlier.counts.size(); i++) {
+    delta.counts[i] = counts[i] > earlier.counts[i] ? counts[i] - earlier.counts[i] : 0;
+  }
+  delta.count = count > earlier.count ? count - earlier.count : 0;
+  delta.sum = sum > earlier.sum ? sum - earlier.sum : 0;
+
+  for (std::size_t i = delta.counts.size(); i > 0; i--) {
+    if (delta.counts[i - 1] > 0) {
+      delta.max = std::min(highest(i - 1), max);
+      break;
+    }
+  }
+  return delta;
+}
+
+LatencyHistogram::LatencyHistogram()
+: _counts(new std::atomic<uint64_t>[BUCKETS]),
+  _count(0),
+  _sum(0),
+  _max(0)
+{
+  for (std::size_t i = 0; i < BUCKETS; i++) {
+    _counts[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+  Snapshot snapshot;
+  snapshot.counts.resize(BUCKETS);
+  for (std::size_t i = 0; i < BUCKETS; i++) {
+    snapshot.counts[i] = _counts[i].load(std::memory_order_relaxed);
+  }
+  snapshot.count = _count.load(std::memory_order_relaxed);
+  snapshot.sum = _sum.load(std::memory_order_relaxed);
+  snapshot.max = _max.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+void LatencyHistogram::reset()
+{
+  for (std::size_t i = 0; i < BUCKETS; i++) {
+    _counts[i].store(0, std::memory_order_relaxed);
+  }
+  _count.store(0, std::memory_order_relaxed);
+  _sum.store(0, std::memory_order_relaxed);
+  _max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::lowest(std::size_t index)
+{
+  if (index < 2 * SUB_BUCKETS) {
+    return index;
+  }
+  const unsigned shift = static_cast<unsigned>(index / SUB_BUCKETS) - 1;
+  return static_cast<uint64_t>(index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+}
+
+uint64_t LatencyHistogram::highest(std::size_t index)
+{
+  if (index < 2 * SUB_BUCKETS) {
+    return index;
+  }
+  const unsigned shift = static_cast<unsigned>(index / SUB_BUCKETS) - 1;
+  return lowest(index) + (uint64_t(1) << shift) - 1;
+}
+
+const char * toString(PipelineStage stage)
+{
+  switch (stage) {
+    case PipelineStage::RECEIVE:
+      return "receive";
+    case PipelineStage::DECODE:
+      return "decode";
+    case PipelineStage::ASSEMBLY:
+      return "assembly";
+    case PipelineStage::CONVERSION:
+      return "conversion";
+    case PipelineStage::PUBLISH:
+      return "publish";
+    default:
+      return "unknown";
+  }
+}
+
+LatencyHistogram & PipelineStatistics::processor(const std::string & name)
+{
+  return *find(name).histogram;
+}
+
+ResourceUsage & PipelineStatistics::processorUsage(const std::string & name)
+{
+  return *find(name).usage;
+}
+
+std::vector<std::string> PipelineStatistics::processors() const
+{
+  std::vector<std::string> names;
+  for (const auto & processor : _processors) {
+    names.push_back(processor.name);
+  }
+  return names;
+}
+
+void PipelineStatistics::reset()
+{
+  for (LatencyHistogram & stage : _stages) {
+    stage.reset();
+  }
+  for (ResourceUsage & usage : _stage_usage) {
+    usage.reset();
+  }
+  for (Processor & processor : _processors) {
+    processor.histogram->reset();
+    processor.usage->reset();
+  }
+}
+
+PipelineStatistics::Processor & PipelineStatistics::find(const std::string & name)
+{
+  for (Processor & processor : _processors) {
+    if (processor.name == name) {
+      return processor;
+    }
+  }
+  _processors.push_back(
+    Processor{name, std::make_unique<LatencyHistogram>(), std::make_unique<ResourceUsage>()});
+  return _processors.back();
+}
+
+}  // namespace ros2_ouster
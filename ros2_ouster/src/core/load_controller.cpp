@@ -0,0 +1,105 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <string>
+
+#include "ros2_ouster/core/load_controller.hpp"
+
+namespace ros2_ouster
+{
+
+constexpr unsigned LoadController::CALM_WINDOWS;
+constexpr double LoadController::RESTORE_RATIO;
+
+LoadController::LoadController(double budget, std::chrono::nanoseconds window)
+: _budget(budget),
+  _window(window),
+  _window_start(Clock::now()),
+  _busy_ns(0),
+  _frames(0),
+  _level(FULL),
+  _calm_windows(0),
+  _load(0.0),
+  _busy_per_frame_ms(0.0)
+{
+}
+
+bool LoadController::update(Clock::time_point now)
+{
+  const auto elapsed = now - _window_start;
+  if (elapsed < _window) {
+    return false;
+  }
+
+  const int64_t busy_ns = _busy_ns.exchange(0, std::memory_order_relaxed);
+  const uint64_t frames = _frames.exchange(0, std::memory_order_relaxed);
+  _window_start = now;
+
+  _load = static_cast<double>(busy_ns) /
+    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  _busy_per_frame_ms = frames > 0 ? busy_ns * 1e-6 / frames : 0.0;
+
+  const unsigned current = level();
+  if (_load > _budget) {
+    _calm_windows = 0;
+    if (current < HALF_RATE) {
+      _level.store(current + 1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  if (_load < _budget * RESTORE_RATIO && current > FULL) {
+    if (++_calm_windows >= CALM_WINDOWS) {
+      _calm_windows = 0;
+      _level.store(current - 1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  _calm_windows = 0;
+  return false;
+}
+
+std::string LoadController::describe() const
+{
+  std::string outputs;
+  switch (level()) {
+    case FULL:
+      outputs = "all outputs at full resolution";
+      break;
+    case SHED_OPTIONAL:
+      outputs = "optional outputs disabled";
+      break;
+    case DECIMATE_2:
+      outputs = "optional outputs disabled, every 2nd column";
+      break;
+    case DECIMATE_4:
+      outputs = "optional outputs disabled, every 4th column";
+      break;
+    default:
+      outputs = "optional outputs disabled, every 4th column, every 2nd frame";
+      break;
+  }
+
+  char buffer[256];
+  std::snprintf(
+    buffer, sizeof(buffer),
+    "CPU load %.2f of a budget of %.2f cores (%.2f ms per frame), level %u: %s",
+    _load, _budget, _busy_per_frame_ms, level(), outputs.c_str());
+  return std::string(buffer);
+}
+
+}  // namespace ros2_ouster
@@ -0,0 +1,314 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros2_ouster/core/compressed_reader.hpp"
+#include "ros2_ouster/core/load_generator.hpp"
+#include "ros2_ouster/core/packet_reader.hpp"
+#include "ros2_ouster/core/recording_format.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+namespace
+{
+
+/**
+ * @brief Append the lidar packets of a recording to packets
+ */
+template<typename ReaderT>
+void loadPackets(ReaderT & reader, RecordedPackets & packets)
+{
+  packets.metadata = reader.metadata();
+  Packet packet;
+  uint64_t first = 0;
+  while (reader.next(packet)) {
+    if (packet.state != ClientState::LIDAR_DATA) {
+      continue;
+    }
+    if (packets.times.empty()) {
+      first = packet.receive_time;
+    }
+    packets.offsets.push_back(packets.data.size());
+    packets.times.push_back(packet.receive_time > first ? packet.receive_time - first : 0);
+    packets.data.insert(packets.data.end(), packet.data, packet.data + packet.size);
+  }
+}
+
+}  // namespace
+
+SyntheticPacketSource::SyntheticPacketSource(
+  const Metadata & mdata, const SyntheticScene & scene, double rotation_rate, uint32_t seed)
+: _generator(mdata, scene, rotation_rate, 0, seed)
+{
+  _packet.resize(_generator.packetSize());
+}
+
+const uint8_t * SyntheticPacketSource::next(std::size_t & size, uint64_t & time)
+{
+  time = _generator.time();
+  _generator.next(_packet.data());
+  size = _packet.size();
+  return _packet.data();
+}
+
+std::shared_ptr<const RecordedPackets> RecordedPackets::load(const std::string & path)
+{
+  char magic[sizeof(recording::MAGIC)] = {};
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(magic, sizeof(magic))) {
+      throw OusterDriverException("Failed to read recording " + path + ".");
+    }
+  }
+
+  auto packets = std::make_shared<RecordedPackets>();
+  if (std::memcmp(magic, recording::COMPRESSED_MAGIC, sizeof(magic)) == 0) {
+    CompressedReader reader(path);
+    loadPackets(reader, *packets);
+  } else {
+    PacketReader reader(path);
+    loadPackets(reader, *packets);
+  }
+
+  if (packets->times.empty()) {
+    throw OusterDriverException("Recording " + path + " holds no lidar packets.");
+  }
+  packets->offsets.push_back(packets->data.size());
+
+  // the loop goes on one packet interval after the last packet
+  const std::size_t count = packets->times.size();
+  const uint64_t last = packets->times.back();
+  packets->period = count > 1 ? last + last / (count - 1) : 1000000;
+  if (packets->period == 0) {
+    packets->period = 1000000;
+  }
+  return packets;
+}
+
+RecordedPacketSource::RecordedPacketSource(std::shared_ptr<const RecordedPackets> packets)
+: _packets(std::move(packets)),
+  _index(0),
+  _loop_time(0)
+{
+}
+
+const uint8_t * RecordedPacketSource::next(std::size_t & size, uint64_t & time)
+{
+  const std::size_t index = _index;
+  time = _loop_time + _packets->times[index];
+  size = _packets->offsets[index + 1] - _packets->offsets[index];
+
+  _index++;
+  if (_index == _packets->times.size()) {
+    _index = 0;
+    _loop_time += _packets->period;
+  }
+  return _packets->data.data() + _packets->offsets[index];
+}
+
+struct LoadGenerator::Sensor
+{
+  std::unique_ptr<PacketSource> source;
+  int fd{-1};
+  sockaddr_in address;
+  std::chrono::nanoseconds offset{0};   // stagger from the start
+
+  const uint8_t * packet{nullptr};      // next packet to send
+  std::size_t size{0};
+  std::chrono::steady_clock::time_point due;
+
+  std::vector<uint8_t> held;            // packet sent after the next one
+  bool holding{false};
+};
+
+LoadGenerator::LoadGenerator(
+  const LoadGeneratorOptions & options, std::vector<std::unique_ptr<PacketSource>> sources)
+: _options(options),
+  _running(false),
+  _sent(0),
+  _lost(0),
+  _reordered(0),
+  _late(0),
+  _errors(0)
+{
+  in_addr host;
+  if (inet_pton(AF_INET, options.host.c_str(), &host) != 1) {
+    throw OusterDriverException("Invalid IPv4 address " + options.host + ".");
+  }
+
+  const std::size_t count = sources.size();
+  for (std::size_t i = 0; i < count; i++) {
+    auto sensor = std::make_unique<Sensor>();
+    sensor->source = std::move(sources[i]);
+    sensor->offset = std::chrono::nanoseconds(1000000 * i / count);
+
+    std::memset(&sensor->address, 0, sizeof(sensor->address));
+    sensor->address.sin_family = AF_INET;
+    sensor->address.sin_addr = host;
+    sensor->address.sin_port =
+      htons(static_cast<uint16_t>(options.port + static_cast<int>(i) * options.port_stride));
+
+    sensor->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sensor->fd < 0) {
+      throw OusterDriverException(
+              std::string("Failed to open a UDP socket: ") + std::strerror(errno));
+    }
+    _sensors.push_back(std::move(sensor));
+  }
+}
+
+LoadGenerator::~LoadGenerator()
+{
+  stop();
+  for (auto & sensor : _sensors) {
+    if (sensor->fd >= 0) {
+      ::close(sensor->fd);
+    }
+  }
+}
+
+void LoadGenerator::start()
+{
+  if (_running.exchange(true)) {
+    return;
+  }
+  _started = std::chrono::steady_clock::now();
+  _thread = std::thread(&LoadGenerator::run, this);
+}
+
+void LoadGenerator::stop()
+{
+  _running = false;
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
+
+LoadStatistics LoadGenerator::statistics() const
+{
+  LoadStatistics stats;
+  stats.sent = _sent.load(std::memory_order_relaxed);
+  stats.lost = _lost.load(std::memory_order_relaxed);
+  stats.reordered = _reordered.load(std::memory_order_relaxed);
+  stats.late = _late.load(std::memory_order_relaxed);
+  stats.errors = _errors.load(std::memory_order_relaxed);
+  return stats;
+}
+
+double LoadGenerator::packetRate() const
+{
+  const double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - _started).count();
+  return elapsed > 0.0 ? _sent.load(std::memory_order_relaxed) / elapsed : 0.0;
+}
+
+void LoadGenerator::run()
+{
+  using Clock = std::chrono::steady_clock;
+
+  std::mt19937 random(_options.seed);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::normal_distribution<double> jitter(0.0, 1.0);
+
+  // due time of the packet sent at a time of the sensor, never before the
+  // previous one of the sensor so jitter does not reorder
+  auto schedule = [&](Sensor & sensor, uint64_t time) {
+      const Clock::time_point previous = sensor.due;
+      if (_options.rate <= 0.0) {
+        sensor.due = Clock::now();
+        return;
+      }
+      double delay = time / _options.rate;
+      if (_options.jitter > 0.0) {
+        delay += jitter(random) * _options.jitter * 1e9;
+      }
+      sensor.due = _started + sensor.offset +
+        std::chrono::nanoseconds(static_cast<int64_t>(std::max(delay, 0.0)));
+      sensor.due = std::max(sensor.due, previous);
+    };
+
+  auto send = [&](const Sensor & sensor, const uint8_t * data, std::size_t size) {
+      const ssize_t sent = sendto(
+        sensor.fd, data, size, 0,
+        reinterpret_cast<const sockaddr *>(&sensor.address), sizeof(sensor.address));
+      if (sent == static_cast<ssize_t>(size)) {
+        _sent.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        _errors.fetch_add(1, std::memory_order_relaxed);
+      }
+    };
+
+  for (auto & sensor : _sensors) {
+    uint64_t time = 0;
+    sensor->due = _started;
+    sensor->packet = sensor->source->next(sensor->size, time);
+    schedule(*sensor, time);
+    sensor->holding = false;
+  }
+
+  while (_running && !_sensors.empty()) {
+    Sensor & sensor = **std::min_element(
+      _sensors.begin(), _sensors.end(),
+      [](const std::unique_ptr<Sensor> & a, const std::unique_ptr<Sensor> & b) {
+        return a->due < b->due;
+      });
+
+    // sleep in short steps to notice being stopped
+    Clock::time_point now = Clock::now();
+    while (now < sensor.due && _running) {
+      std::this_thread::sleep_until(std::min(sensor.due, now + std::chrono::milliseconds(100)));
+      now = Clock::now();
+    }
+    if (!_running) {
+      break;
+    }
+    if (now - sensor.due > std::chrono::milliseconds(1)) {
+      _late.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (_options.loss > 0.0 && uniform(random) < _options.loss) {
+      _lost.fetch_add(1, std::memory_order_relaxed);
+    } else if (!sensor.holding && _options.reorder > 0.0 && uniform(random) < _options.reorder) {
+      sensor.held.assign(sensor.packet, sensor.packet + sensor.size);
+      sensor.holding = true;
+      _reordered.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      send(sensor, sensor.packet, sensor.size);
+      if (sensor.holding) {
+        send(sensor, sensor.held.data(), sensor.held.size());
+        sensor.holding = false;
+      }
+    }
+
+    uint64_t time = 0;
+    sensor.packet = sensor.source->next(sensor.size, time);
+    schedule(sensor, time);
+  }
+}
+
+}  // namespace ros2_ouster
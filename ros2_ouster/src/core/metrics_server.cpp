@@ -0,0 +1,304 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "ros2_ouster/core/metrics_server.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+namespace
+{
+
+// upper bounds of the histogram buckets served in s, the finer buckets
+// recorded are summed into these
+constexpr double BUCKET_BOUNDS[] = {
+  1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3,
+  5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+
+// longest request read, the request line is all that is used
+constexpr std::size_t MAX_REQUEST = 8192;
+
+const char * describe(PipelineCounter counter)
+{
+  switch (counter) {
+    case PipelineCounter::LIDAR_PACKETS:
+      return "Lidar packets read from the sensor.";
+    case PipelineCounter::IMU_PACKETS:
+      return "IMU packets read from the sensor.";
+    case PipelineCounter::DECODED_PACKETS:
+      return "Lidar packets decoded into frames.";
+    case PipelineCounter::FRAMES:
+      return "Frames completed.";
+    case PipelineCounter::FRAME_PACKETS:
+      return "Lidar packets of the frames completed.";
+    case PipelineCounter::MISSING_PACKETS:
+      return "Lidar packets estimated missing from the frames completed.";
+    default:
+      return "";
+  }
+}
+
+void appendCounter(
+  std::string & out, const std::string & name, const std::string & help, uint64_t value)
+{
+  const std::string metric = "ouster_" + name + "_total";
+  out += "# HELP " + metric + " " + help + "\n";
+  out += "# TYPE " + metric + " counter\n";
+  out += metric + " " + std::to_string(value) + "\n";
+}
+
+void appendHistogram(
+  std::string & out, const std::string & metric, const std::string & labels,
+  const LatencyHistogram::Snapshot & histogram)
+{
+  char buffer[64];
+  std::size_t i = 0;
+  uint64_t cumulative = 0;
+  for (const double bound : BUCKET_BOUNDS) {
+    const uint64_t bound_ns = static_cast<uint64_t>(bound * 1e9 + 0.5);
+    while (i < histogram.counts.size() && LatencyHistogram::highest(i) <= bound_ns) {
+      cumulative += histogram.counts[i++];
+    }
+    std::snprintf(buffer, sizeof(buffer), "%g", bound);
+    out += metric + "_bucket{" + labels + ",le=\"" + buffer + "\"} " +
+      std::to_string(cumulative) + "\n";
+  }
+
+  // the count is that of the buckets, consistent with them even while
+  // values are recorded
+  for (; i < histogram.counts.size(); i++) {
+    cumulative += histogram.counts[i];
+  }
+  out += metric + "_bucket{" + labels + ",le=\"+Inf\"} " + std::to_string(cumulative) + "\n";
+  std::snprintf(buffer, sizeof(buffer), "%.9f", histogram.sum * 1e-9);
+  out += metric + "_sum{" + labels + "} " + buffer + "\n";
+  out += metric + "_count{" + labels + "} " + std::to_string(cumulative) + "\n";
+}
+
+bool sendAll(int fd, const std::string & data)
+{
+  std::size_t sent = 0;
+  while (sent < data.size()) {
+    const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    sent += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+std::string response(const char * status, const char * content_type, const std::string & body)
+{
+  return std::string("HTTP/1.1 ") + status + "\r\n"
+         "Content-Type: " + content_type + "\r\n"
+         "Content-Length: " + std::to_string(body.size()) + "\r\n"
+         "Connection: close\r\n\r\n" + body;
+}
+
+}  // namespace
+
+MetricsServer::MetricsServer(const PipelineStatistics & statistics, int port)
+: _statistics(statistics),
+  _port(port),
+  _fd(-1),
+  _running(false)
+{
+  _fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (_fd < 0) {
+    throw OusterDriverException(
+            std::string("Failed to open the metrics socket: ") + std::strerror(errno));
+  }
+
+  int reuse = 1;
+  setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(static_cast<uint16_t>(port));
+  if (bind(_fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0 ||
+    listen(_fd, 4) < 0)
+  {
+    const std::string error = std::strerror(errno);
+    ::close(_fd);
+    throw OusterDriverException(
+            "Failed to listen for metrics on 127.0.0.1:" + std::to_string(port) + ": " + error);
+  }
+
+  // port 0 lets the kernel choose
+  socklen_t length = sizeof(address);
+  if (getsockname(_fd, reinterpret_cast<sockaddr *>(&address), &length) == 0) {
+    _port = ntohs(address.sin_port);
+  }
+}
+
+MetricsServer::~MetricsServer()
+{
+  stop();
+  ::close(_fd);
+}
+
+void MetricsServer::addCounter(
+  const std::string & name, const std::string & help, CounterCallback read)
+{
+  _counters.push_back(Counter{name, help, std::move(read)});
+}
+
+void MetricsServer::start()
+{
+  if (_running.exchange(true)) {
+    return;
+  }
+  _thread = std::thread(&MetricsServer::run, this);
+}
+
+void MetricsServer::stop()
+{
+  _running = false;
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
+
+std::string MetricsServer::render() const
+{
+  std::string out;
+  const PipelineCounters & counters = _statistics.counters();
+  const std::size_t count = static_cast<std::size_t>(PipelineCounter::COUNT);
+  for (std::size_t i = 0; i < count; i++) {
+    const PipelineCounter counter = static_cast<PipelineCounter>(i);
+    appendCounter(out, toString(counter), describe(counter), counters.total(counter));
+  }
+  for (const Counter & counter : _counters) {
+    appendCounter(out, counter.name, counter.help, counter.read());
+  }
+
+  const std::string stage_metric = "ouster_stage_latency_seconds";
+  out += "# HELP " + stage_metric + " Latency of each stage of the pipeline.\n";
+  out += "# TYPE " + stage_metric + " histogram\n";
+  const std::size_t stages = static_cast<std::size_t>(PipelineStage::COUNT);
+  for (std::size_t i = 0; i < stages; i++) {
+    const PipelineStage stage = static_cast<PipelineStage>(i);
+    appendHistogram(
+      out, stage_metric, std::string("stage=\"") + toString(stage) + "\"",
+      _statistics.stage(stage).snapshot());
+  }
+
+  const std::string processor_metric = "ouster_processor_latency_seconds";
+  out += "# HELP " + processor_metric + " Time each processor takes per packet.\n";
+  out += "# TYPE " + processor_metric + " histogram\n";
+  const std::vector<std::string> processors = _statistics.processors();
+  for (std::size_t i = 0; i < processors.size(); i++) {
+    appendHistogram(
+      out, processor_metric, "processor=\"" + processors[i] + "\"",
+      _statistics.processorAt(i).snapshot());
+  }
+
+  char buffer[64];
+  out += "# HELP ouster_processor_cpu_seconds_total Thread CPU time of each processor.\n";
+  out += "# TYPE ouster_processor_cpu_seconds_total counter\n";
+  for (std::size_t i = 0; i < processors.size(); i++) {
+    std::snprintf(
+      buffer, sizeof(buffer), "%.9f", _statistics.processorUsageAt(i).totals().cpu_time * 1e-9);
+    out += "ouster_processor_cpu_seconds_total{processor=\"" + processors[i] + "\"} " +
+      buffer + "\n";
+  }
+  if (allocationsCounted()) {
+    out += "# HELP ouster_processor_allocated_bytes_total Bytes allocated by each processor.\n";
+    out += "# TYPE ouster_processor_allocated_bytes_total counter\n";
+    for (std::size_t i = 0; i < processors.size(); i++) {
+      out += "ouster_processor_allocated_bytes_total{processor=\"" + processors[i] + "\"} " +
+        std::to_string(_statistics.processorUsageAt(i).totals().allocated_bytes) + "\n";
+    }
+  }
+  return out;
+}
+
+void MetricsServer::run()
+{
+  while (_running) {
+    // wake up regularly to notice being stopped
+    pollfd listener;
+    listener.fd = _fd;
+    listener.events = POLLIN;
+    if (::poll(&listener, 1, 100) <= 0) {
+      continue;
+    }
+
+    const int fd = accept(_fd, nullptr, nullptr);
+    if (fd < 0) {
+      continue;
+    }
+    serve(fd);
+    ::close(fd);
+  }
+}
+
+void MetricsServer::serve(int fd)
+{
+  // a stalled client must not hold the server up
+  timeval timeout;
+  timeout.tv_sec = 1;
+  timeout.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST) {
+    const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+      break;
+    }
+    request.append(buffer, static_cast<std::size_t>(n));
+  }
+
+  // request line: method, target and version
+  const std::size_t line_end = request.find("\r\n");
+  const std::string line = request.substr(0, line_end);
+  const std::size_t method_end = line.find(' ');
+  const std::size_t target_end = line.find(' ', method_end + 1);
+  if (method_end == std::string::npos || target_end == std::string::npos) {
+    sendAll(fd, response("400 Bad Request", "text/plain", "Bad request\n"));
+    return;
+  }
+
+  const std::string method = line.substr(0, method_end);
+  std::string target = line.substr(method_end + 1, target_end - method_end - 1);
+  target = target.substr(0, target.find('?'));
+  if (method != "GET") {
+    sendAll(fd, response("405 Method Not Allowed", "text/plain", "Method not allowed\n"));
+  } else if (target != "/metrics" && target != "/") {
+    sendAll(fd, response("404 Not Found", "text/plain", "Not found, see /metrics\n"));
+  } else {
+    sendAll(fd, response("200 OK", "text/plain; version=0.0.4; charset=utf-8", render()));
+  }
+}
+
+}  // namespace ros2_ouster
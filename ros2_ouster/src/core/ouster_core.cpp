@@ -0,0 +1,117 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <utility>
+
+#include "ros2_ouster/core/ouster_core.hpp"
+#include "ros2_ouster/core/tracing.hpp"
+
+namespace ros2_ouster
+{
+
+OusterCore::OusterCore(std::unique_ptr<SensorInterface> sensor)
+: _sensor(std::move(sensor)), _lidar_packet_size(0), _imu_packet_size(0), _packets(0)
+{
+}
+
+OusterCore::~OusterCore() = default;
+
+void OusterCore::configure(const Configuration & config, const Metadata & mdata)
+{
+  _sensor->configure(config);
+  _lidar_packet_size = static_cast<std::size_t>(config.lidar_packet_size);
+  _imu_packet_size = static_cast<std::size_t>(config.imu_packet_size);
+
+  _decoder = std::make_unique<FrameDecoder>(mdata);
+  _decoder->setFrameCallback(_frame_callback);
+}
+
+void OusterCore::reset(const Configuration & config)
+{
+  _sensor->reset(config);
+  if (_decoder) {
+    _decoder->reset();
+  }
+}
+
+void OusterCore::setPacketCallback(PacketCallback callback)
+{
+  _packet_callback = std::move(callback);
+}
+
+void OusterCore::setFrameCallback(FrameCallback callback)
+{
+  _frame_callback = std::move(callback);
+  if (_decoder) {
+    _decoder->setFrameCallback(_frame_callback);
+  }
+}
+
+void OusterCore::setIdle(bool idle)
+{
+  _sensor->setIdle(idle);
+  if (!idle && _decoder) {
+    _decoder->reset();
+  }
+}
+
+std::size_t OusterCore::drain()
+{
+  return _sensor->drain();
+}
+
+uint64_t OusterCore::kernelDrops() const
+{
+  return _sensor->kernelDrops();
+}
+
+ClientState OusterCore::poll()
+{
+  const ClientState state = _sensor->get();
+  uint8_t * data = _sensor->readPacket(state);
+  if (!data) {
+    return ClientState::TIMEOUT;
+  }
+
+  uint64_t receive_time = _sensor->receiveTime();
+  if (receive_time == 0) {
+    receive_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+
+  const std::size_t size =
+    state == ClientState::LIDAR_DATA ? _lidar_packet_size : _imu_packet_size;
+  _packets++;
+  ROS2_OUSTER_TRACEPOINT(
+    packet_receive, static_cast<int>(state), _packets, static_cast<uint32_t>(size),
+    receive_time);
+
+  if (_packet_callback) {
+    Packet packet;
+    packet.state = state;
+    packet.data = data;
+    packet.size = size;
+    packet.receive_time = receive_time;
+    _packet_callback(packet);
+  }
+
+  if (state == ClientState::LIDAR_DATA && _frame_callback && _decoder) {
+    _decoder->decode(data, receive_time);
+  }
+
+  return state;
+}
+
+}  // namespace ros2_ouster
@@ -0,0 +1,285 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ros2_ouster/core/packet_codec.hpp"
+#include "ros2_ouster/core/recording_format.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+using recording::RecordHeader;
+
+namespace
+{
+
+constexpr std::size_t OLE_3D_V2_SIZE = 1206;
+constexpr std::size_t OLE_2D_V2_SIZE = 1240;
+
+/**
+ * @brief Planes of a field across the packets of a block, walked in the
+ * order of the fields of a packet
+ */
+struct PlaneCursor
+{
+  uint8_t * planes;
+  std::size_t index;    // index of the packet
+  std::size_t count;    // packets in the block
+  std::size_t offset;   // bytes per packet of the planes walked so far
+
+  /**
+   * @brief The next plane, holding width bytes per packet, at this packet
+   */
+  uint8_t * next(std::size_t width)
+  {
+    uint8_t * plane = planes + offset * count + index * width;
+    offset += width;
+    return plane;
+  }
+};
+
+template<bool Encode>
+inline void copyBytes(uint8_t * field, uint8_t * plane, std::size_t size)
+{
+  if (Encode) {
+    std::memcpy(plane, field, size);
+  } else {
+    std::memcpy(field, plane, size);
+  }
+}
+
+/**
+ * @brief Code an integer field as the delta to the previous value, with
+ * byte j of the delta at planes[j][index]
+ */
+template<bool Encode, typename T>
+inline void codeDelta(uint8_t * field, uint8_t * const * planes, std::size_t index, T & last)
+{
+  T value;
+  if (Encode) {
+    std::memcpy(&value, field, sizeof(T));
+    const T delta = static_cast<T>(value - last);
+    for (std::size_t j = 0; j < sizeof(T); j++) {
+      planes[j][index] = static_cast<uint8_t>(delta >> (8 * j));
+    }
+  } else {
+    T delta = 0;
+    for (std::size_t j = 0; j < sizeof(T); j++) {
+      delta = static_cast<T>(delta | static_cast<T>(planes[j][index]) << (8 * j));
+    }
+    value = static_cast<T>(last + delta);
+    std::memcpy(field, &value, sizeof(T));
+  }
+  last = value;
+}
+
+}  // namespace
+
+PacketCodec::PacketCodec(const Metadata & mdata)
+: _is_3d(mdata.lidar_vendor == std::string("OLE_3D_V2")),
+  _lidar_size(0),
+  _azimuth_last(0),
+  _intensity_last(0),
+  _ts_last(0)
+{
+  // packets of an unexpected size are kept as they are
+  const std::size_t expected = _is_3d ? OLE_3D_V2_SIZE : OLE_2D_V2_SIZE;
+  if (mdata.lidar_packet_size == static_cast<int>(expected)) {
+    _lidar_size = expected;
+  }
+  std::memset(_distance_last, 0, sizeof(_distance_last));
+}
+
+std::size_t PacketCodec::compress(
+  const uint8_t * records, std::size_t size, std::size_t count,
+  std::vector<uint8_t> & compressed)
+{
+  // the planes hold the same bytes as the records, rearranged
+  _planes.resize(size);
+  if (!transcode<true>(const_cast<uint8_t *>(records), count, _planes.data(), size)) {
+    throw OusterDriverException("Malformed block of packets to compress.");
+  }
+
+  uLongf compressed_size = compressBound(static_cast<uLong>(size));
+  compressed.resize(compressed_size);
+  if (compress2(
+      compressed.data(), &compressed_size, _planes.data(),
+      static_cast<uLong>(size), Z_BEST_SPEED) != Z_OK)
+  {
+    throw OusterDriverException("Failed to compress a block of packets.");
+  }
+  compressed.resize(compressed_size);
+  return size;
+}
+
+bool PacketCodec::decompress(
+  const uint8_t * compressed, std::size_t size, std::size_t count,
+  std::size_t encoded_size, std::vector<uint8_t> & records)
+{
+  _planes.resize(encoded_size);
+  uLongf planes_size = static_cast<uLongf>(encoded_size);
+  if (uncompress(
+      _planes.data(), &planes_size, compressed,
+      static_cast<uLong>(size)) != Z_OK || planes_size != encoded_size)
+  {
+    return false;
+  }
+
+  records.resize(encoded_size);
+  return transcode<false>(records.data(), count, _planes.data(), encoded_size);
+}
+
+template<bool Encode>
+bool PacketCodec::transcode(
+  uint8_t * records, std::size_t count, uint8_t * planes, std::size_t size)
+{
+  if (count * sizeof(RecordHeader) > size) {
+    return false;
+  }
+
+  // record headers first, decoding them gives the positions of the packets
+  uint8_t * time_planes[8];
+  uint8_t * size_planes[4];
+  uint8_t * state_planes[4];
+  PlaneCursor headers{planes, 0, count, 0};
+  for (uint8_t *& plane : time_planes) {
+    plane = headers.next(1);
+  }
+  for (uint8_t *& plane : size_planes) {
+    plane = headers.next(1);
+  }
+  for (uint8_t *& plane : state_planes) {
+    plane = headers.next(1);
+  }
+
+  uint64_t time_last = 0;
+  uint32_t size_last = 0;
+  uint32_t state_last = 0;
+  std::size_t lidar_count = 0;
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < count; i++) {
+    uint8_t * header = records + offset;
+    if (offset + sizeof(RecordHeader) > size) {
+      return false;
+    }
+    codeDelta<Encode>(header + offsetof(RecordHeader, receive_time), time_planes, i, time_last);
+    codeDelta<Encode>(header + offsetof(RecordHeader, size), size_planes, i, size_last);
+    codeDelta<Encode>(header + offsetof(RecordHeader, state), state_planes, i, state_last);
+    if (size_last > size - offset - sizeof(RecordHeader)) {
+      return false;
+    }
+    if (_lidar_size != 0 && state_last == ClientState::LIDAR_DATA &&
+      size_last == _lidar_size)
+    {
+      lidar_count++;
+    }
+    offset += sizeof(RecordHeader) + size_last;
+  }
+  if (offset != size) {
+    return false;
+  }
+
+  // then the lidar packets field by field, then the other packets
+  uint8_t * lidar_planes = planes + count * sizeof(RecordHeader);
+  uint8_t * other = lidar_planes + lidar_count * _lidar_size;
+  _azimuth_last = 0;
+  _intensity_last = 0;
+  _ts_last = 0;
+  std::memset(_distance_last, 0, sizeof(_distance_last));
+
+  std::size_t lidar_index = 0;
+  offset = 0;
+  for (std::size_t i = 0; i < count; i++) {
+    RecordHeader record;
+    std::memcpy(&record, records + offset, sizeof(record));
+    uint8_t * packet = records + offset + sizeof(RecordHeader);
+    if (_lidar_size != 0 && record.state == ClientState::LIDAR_DATA &&
+      record.size == _lidar_size)
+    {
+      if (_is_3d) {
+        transcodeOLE3DV2<Encode>(packet, lidar_planes, lidar_index++, lidar_count);
+      } else {
+        transcodeOLE2DV2<Encode>(packet, lidar_planes, lidar_index++, lidar_count);
+      }
+    } else {
+      copyBytes<Encode>(packet, other, record.size);
+      other += record.size;
+    }
+    offset += sizeof(RecordHeader) + record.size;
+  }
+  return true;
+}
+
+template<bool Encode>
+void PacketCodec::transcodeOLE3DV2(
+  uint8_t * packet, uint8_t * planes, std::size_t index, std::size_t count)
+{
+  // 12 blocks of 100 bytes: flag, azimuth and 32 returns of distance and
+  // intensity, then the timestamp and 2 factory bytes
+  PlaneCursor cursor{planes, index, count, 0};
+  uint8_t * flags = cursor.next(24);
+  uint8_t * const azimuths[2] = {cursor.next(12), cursor.next(12)};
+  uint8_t * const distances[2] = {cursor.next(384), cursor.next(384)};
+  uint8_t * intensities = cursor.next(384);
+  uint8_t * const ts[4] = {cursor.next(1), cursor.next(1), cursor.next(1), cursor.next(1)};
+  uint8_t * tail = cursor.next(2);
+
+  for (std::size_t icol = 0; icol < 12; icol++) {
+    uint8_t * block = packet + 100 * icol;
+    copyBytes<Encode>(block, flags + 2 * icol, 2);
+    codeDelta<Encode>(block + 2, azimuths, icol, _azimuth_last);
+    for (std::size_t irow = 0; irow < 32; irow++) {
+      uint8_t * ret = block + 4 + irow * 3;
+      codeDelta<Encode>(ret, distances, icol * 32 + irow, _distance_last[irow % 16]);
+      copyBytes<Encode>(ret + 2, intensities + icol * 32 + irow, 1);
+    }
+  }
+  codeDelta<Encode>(packet + 1200, ts, 0, _ts_last);
+  copyBytes<Encode>(packet + 1204, tail, 2);
+}
+
+template<bool Encode>
+void PacketCodec::transcodeOLE2DV2(
+  uint8_t * packet, uint8_t * planes, std::size_t index, std::size_t count)
+{
+  // 40 bytes of header with the timestamp at 28, then 150 returns of
+  // 8 bytes: azimuth, distance, intensity and 2 other bytes
+  PlaneCursor cursor{planes, index, count, 0};
+  uint8_t * head = cursor.next(28);
+  uint8_t * const ts[4] = {cursor.next(1), cursor.next(1), cursor.next(1), cursor.next(1)};
+  uint8_t * head_tail = cursor.next(8);
+  uint8_t * const azimuths[2] = {cursor.next(150), cursor.next(150)};
+  uint8_t * const distances[2] = {cursor.next(150), cursor.next(150)};
+  uint8_t * const intensities[2] = {cursor.next(150), cursor.next(150)};
+  uint8_t * rest = cursor.next(300);
+
+  copyBytes<Encode>(packet, head, 28);
+  codeDelta<Encode>(packet + 28, ts, 0, _ts_last);
+  copyBytes<Encode>(packet + 32, head_tail, 8);
+  for (std::size_t icol = 0; icol < 150; icol++) {
+    uint8_t * ret = packet + 40 + 8 * icol;
+    codeDelta<Encode>(ret, azimuths, icol, _azimuth_last);
+    codeDelta<Encode>(ret + 2, distances, icol, _distance_last[0]);
+    codeDelta<Encode>(ret + 4, intensities, icol, _intensity_last);
+    copyBytes<Encode>(ret + 6, rest + 2 * icol, 2);
+  }
+}
+
+}  // namespace ros2_ouster
@@ -0,0 +1,311 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "ros2_ouster/core/packet_generator.hpp"
+
+namespace ros2_ouster
+{
+
+namespace
+{
+
+constexpr std::size_t OLE_3D_V2_PACKET_SIZE = 1206;
+constexpr std::size_t OLE_2D_V2_PACKET_SIZE = 1240;
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+
+// returns encoded in 2 mm (OLE_3D_V2) or 1 mm (OLE_2D_V2) units, values
+// from 0xFFF0 are invalid for OLE_2D_V2
+constexpr double OLE_3D_V2_MAX_RANGE = 0xFFFF * 0.002;
+constexpr double OLE_2D_V2_MAX_RANGE = 0xFFEF * 0.001;
+
+inline double dot(const double a[3], const double b[3])
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+}  // namespace
+
+Metadata syntheticMetadata(const std::string & lidar_vendor)
+{
+  const bool is_3d = lidar_vendor == std::string("OLE_3D_V2");
+  Metadata mdata;
+  mdata.imu_port = 0;
+  mdata.lidar_port = 0;
+  mdata.lidar_vendor = lidar_vendor;
+  mdata.num_lasers = is_3d ? 16 : 1;
+  mdata.ring_scan = 0;
+  mdata.distance_resolution = is_3d ? 0.002 : 0.001;
+  mdata.lidar_packet_size = static_cast<int>(
+    is_3d ? OLE_3D_V2_PACKET_SIZE : OLE_2D_V2_PACKET_SIZE);
+  mdata.imu_packet_size = 842;
+  for (int ring = 0; ring < mdata.num_lasers; ring++) {
+    mdata.x_offset_array.push_back(0.0);
+    mdata.y_offset_array.push_back(0.0);
+    mdata.ah_offset_array.push_back(0.0);
+    mdata.av_offset_array.push_back(is_3d ? -15.0 + 2.0 * ring : 0.0);
+    mdata.laser_id_array.push_back(ring);
+  }
+  return mdata;
+}
+
+SyntheticScene SyntheticScene::room()
+{
+  SyntheticScene scene;
+  scene.planes = {
+    {{0.0, 0.0, 1.0}, -1.0, 40.0f},    // floor
+    {{0.0, 0.0, 1.0}, 2.0, 20.0f},     // ceiling
+    {{1.0, 0.0, 0.0}, 10.0, 120.0f},   // walls
+    {{1.0, 0.0, 0.0}, -10.0, 120.0f},
+    {{0.0, 1.0, 0.0}, 8.0, 90.0f},
+    {{0.0, 1.0, 0.0}, -8.0, 90.0f},
+  };
+  scene.boxes = {
+    {{2.0, 1.0, -1.0}, {3.0, 2.5, 0.5}, 200.0f},
+    {{-4.0, -3.0, -1.0}, {-2.5, -2.0, 1.5}, 160.0f},
+    {{5.0, -6.0, -1.0}, {7.0, -5.0, 0.0}, 230.0f},
+  };
+  return scene;
+}
+
+PacketGenerator::PacketGenerator(
+  const Metadata & mdata, const SyntheticScene & scene, double rotation_rate,
+  uint32_t columns, uint32_t seed)
+: _is_3d(mdata.lidar_vendor == std::string("OLE_3D_V2")),
+  _scene(scene),
+  _rotation_rate(rotation_rate > 0.0 ? rotation_rate : 10.0),
+  _units_per_packet(_is_3d ? 12 : 150),
+  _seed(seed),
+  _noise(0.0, 1.0),
+  _uniform(0.0, 1.0)
+{
+  // an OLE_3D_V2 block holds two columns
+  if (_is_3d) {
+    _units = std::max<uint32_t>(columns > 0 ? columns / 2 : 1000, 1);
+  } else {
+    _units = std::max<uint32_t>(columns > 0 ? columns : 1600, 1);
+  }
+
+  // angles quantized as FrameDecoder does, to the 0.01 degree of its tables
+  const std::size_t lasers = _is_3d ? 16 : 1;
+  for (std::size_t ring = 0; ring < lasers; ring++) {
+    const double av = ring < mdata.av_offset_array.size() ? mdata.av_offset_array[ring] : 0.0;
+    const double av_rad = static_cast<int32_t>(av * 100) * 0.01 * DEG_TO_RAD;
+    _sin_av.push_back(std::sin(av_rad));
+    _cos_av.push_back(std::cos(av_rad));
+    _x_offset.push_back(ring < mdata.x_offset_array.size() ? mdata.x_offset_array[ring] : 0.0);
+    _y_offset.push_back(ring < mdata.y_offset_array.size() ? mdata.y_offset_array[ring] : 0.0);
+  }
+
+  reset();
+}
+
+std::size_t PacketGenerator::packetSize() const
+{
+  return _is_3d ? OLE_3D_V2_PACKET_SIZE : OLE_2D_V2_PACKET_SIZE;
+}
+
+double PacketGenerator::packetRate() const
+{
+  return _rotation_rate * _units / _units_per_packet;
+}
+
+std::size_t PacketGenerator::packetsPerRevolution() const
+{
+  return (_units + _units_per_packet - 1) / _units_per_packet;
+}
+
+uint64_t PacketGenerator::time() const
+{
+  const double unit_ns = 1e9 / (_rotation_rate * _units);
+  return static_cast<uint64_t>(_packet * _units_per_packet * unit_ns);
+}
+
+void PacketGenerator::skip(std::size_t count)
+{
+  _packet += count;
+}
+
+void PacketGenerator::reset()
+{
+  _packet = 0;
+  _random.seed(_seed);
+  _noise.reset();
+  _uniform.reset();
+}
+
+uint16_t PacketGenerator::azimuth(uint64_t index) const
+{
+  return static_cast<uint16_t>((index % _units) * 36000 / _units);
+}
+
+void PacketGenerator::next(uint8_t * packet)
+{
+  if (_is_3d) {
+    next3D(packet);
+  } else {
+    next2D(packet);
+  }
+  _packet++;
+}
+
+double PacketGenerator::cast(
+  const double origin[3], const double direction[3], float & intensity)
+{
+  double nearest = std::numeric_limits<double>::infinity();
+
+  for (const SyntheticPlane & plane : _scene.planes) {
+    const double denom = dot(plane.normal, direction);
+    if (std::fabs(denom) < 1e-9) {
+      continue;
+    }
+    const double t = (plane.offset - dot(plane.normal, origin)) / denom;
+    if (t > 0.0 && t < nearest) {
+      nearest = t;
+      intensity = plane.intensity;
+    }
+  }
+
+  // slab test, from outside the box only
+  for (const SyntheticBox & box : _scene.boxes) {
+    double t_near = 0.0;
+    double t_far = std::numeric_limits<double>::infinity();
+    bool hit = true;
+    for (int axis = 0; axis < 3 && hit; axis++) {
+      if (std::fabs(direction[axis]) < 1e-12) {
+        hit = origin[axis] >= box.min[axis] && origin[axis] <= box.max[axis];
+        continue;
+      }
+      double t1 = (box.min[axis] - origin[axis]) / direction[axis];
+      double t2 = (box.max[axis] - origin[axis]) / direction[axis];
+      if (t1 > t2) {
+        std::swap(t1, t2);
+      }
+      t_near = std::max(t_near, t1);
+      t_far = std::min(t_far, t2);
+      hit = t_near <= t_far;
+    }
+    if (hit && t_near > 0.0 && t_near < nearest) {
+      nearest = t_near;
+      intensity = box.intensity;
+    }
+  }
+
+  if (nearest > _scene.max_range) {
+    return -1.0;
+  }
+  if (_scene.dropout > 0.0 && _uniform(_random) < _scene.dropout) {
+    return -1.0;
+  }
+  if (_scene.range_noise > 0.0) {
+    nearest = std::max(nearest + _noise(_random) * _scene.range_noise, 0.0);
+  }
+  return nearest;
+}
+
+void PacketGenerator::next3D(uint8_t * packet)
+{
+  std::memset(packet, 0, OLE_3D_V2_PACKET_SIZE);
+
+  const uint64_t first = _packet * _units_per_packet;
+  uint16_t azimuths[12];
+  for (uint64_t block = 0; block < 12; block++) {
+    azimuths[block] = azimuth(first + block);
+  }
+
+  // returns of a block sweep to the next block, as decoded
+  double div_azimuth = azimuths[11] >= azimuths[0] ?
+    azimuths[11] - azimuths[0] : azimuths[11] + 36000 - azimuths[0];
+  div_azimuth /= (11 * 32);
+
+  for (int block = 0; block < 12; block++) {
+    uint8_t * data = packet + 100 * block;
+    data[0] = 0xFF;
+    data[1] = 0xEE;
+    std::memcpy(data + 2, &azimuths[block], sizeof(uint16_t));
+
+    for (int irow = 0; irow < 32; irow++) {
+      const int ring = irow % 16;
+      const uint32_t azimuth_ring =
+        (azimuths[block] + static_cast<uint32_t>(irow * div_azimuth) + 36000) % 36000;
+      const double ah = azimuth_ring * 0.01 * DEG_TO_RAD;
+      const double sin_ah = std::sin(ah);
+      const double cos_ah = std::cos(ah);
+
+      const double origin[3] = {
+        _x_offset[ring] * cos_ah * 0.001,
+        -_x_offset[ring] * sin_ah * 0.001,
+        _y_offset[ring] * 0.001};
+      const double direction[3] = {
+        _cos_av[ring] * sin_ah,
+        _cos_av[ring] * cos_ah,
+        _sin_av[ring]};
+
+      float intensity = 0.0f;
+      const double range = cast(origin, direction, intensity);
+      uint16_t distance = 0;
+      uint8_t reflectivity = 0;
+      if (range >= 0.0 && range <= OLE_3D_V2_MAX_RANGE) {
+        distance = static_cast<uint16_t>(std::lround(range / 0.002));
+        reflectivity = static_cast<uint8_t>(std::min(intensity, 255.0f));
+      }
+
+      uint8_t * ret = data + 4 + 3 * irow;
+      std::memcpy(ret, &distance, sizeof(uint16_t));
+      ret[2] = reflectivity;
+    }
+  }
+
+  // time of the first block in us, wrapping around
+  const uint32_t ts = static_cast<uint32_t>(time() / 1000);
+  std::memcpy(packet + 1200, &ts, sizeof(uint32_t));
+}
+
+void PacketGenerator::next2D(uint8_t * packet)
+{
+  std::memset(packet, 0, OLE_2D_V2_PACKET_SIZE);
+
+  // time of the first return in ms, wrapping around
+  const uint32_t ts = static_cast<uint32_t>(time() / 1000000);
+  std::memcpy(packet + 28, &ts, sizeof(uint32_t));
+
+  const uint64_t first = _packet * _units_per_packet;
+  const double origin[3] = {0.0, 0.0, 0.0};
+  for (uint64_t i = 0; i < 150; i++) {
+    const uint16_t az = azimuth(first + i);
+    const double ah = az * 0.01 * DEG_TO_RAD;
+    const double direction[3] = {std::cos(ah), std::sin(ah), 0.0};
+
+    float intensity = 0.0f;
+    const double range = cast(origin, direction, intensity);
+    uint16_t distance = 0xFFFF;
+    uint16_t value = 0;
+    if (range >= 0.0 && range <= OLE_2D_V2_MAX_RANGE) {
+      distance = static_cast<uint16_t>(std::lround(range / 0.001));
+      value = static_cast<uint16_t>(std::max(intensity, 0.0f));
+    }
+
+    uint8_t * ret = packet + 40 + 8 * i;
+    std::memcpy(ret, &az, sizeof(uint16_t));
+    std::memcpy(ret + 2, &distance, sizeof(uint16_t));
+    std::memcpy(ret + 4, &value, sizeof(uint16_t));
+  }
+}
+
+}  // namespace ros2_ouster
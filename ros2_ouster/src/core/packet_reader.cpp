@@ -0,0 +1,145 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "ros2_ouster/core/packet_reader.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+using recording::FrameIndexEntry;
+using recording::RecordHeader;
+using recording::RecordingHeader;
+
+PacketReader::PacketReader(const std::string & path)
+: _map(nullptr),
+  _map_size(0),
+  _header(nullptr),
+  _data(nullptr),
+  _data_size(0),
+  _index(nullptr),
+  _frames(0),
+  _offset(0)
+{
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw OusterDriverException(
+            "Failed to open recording " + path + ": " + std::strerror(errno));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(RecordingHeader))) {
+    ::close(fd);
+    throw OusterDriverException("Recording " + path + " is too short.");
+  }
+
+  // private writable mapping: packets are handed out mutable without
+  // copies, any write stays local to this process
+  _map_size = static_cast<std::size_t>(st.st_size);
+  void * map = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    throw OusterDriverException(
+            "Failed to map recording " + path + ": " + std::strerror(errno));
+  }
+  _map = static_cast<uint8_t *>(map);
+  _header = reinterpret_cast<const RecordingHeader *>(_map);
+
+  if (std::memcmp(_header->magic, recording::MAGIC, sizeof(_header->magic)) != 0 ||
+    _header->version != recording::VERSION)
+  {
+    munmap(_map, _map_size);
+    throw OusterDriverException("File " + path + " is not a packet recording.");
+  }
+
+  if (_header->data_offset > _map_size ||
+    sizeof(RecordingHeader) + _header->metadata_size > _header->data_offset ||
+    _header->data_size > _map_size - _header->data_offset ||
+    _header->index_offset > _map_size ||
+    _header->frame_count > (_map_size - _header->index_offset) / sizeof(FrameIndexEntry))
+  {
+    munmap(_map, _map_size);
+    throw OusterDriverException("Recording " + path + " is truncated.");
+  }
+
+  try {
+    _metadata = recording::metadataFromJson(
+      std::string(
+        reinterpret_cast<const char *>(_map + sizeof(RecordingHeader)),
+        _header->metadata_size));
+  } catch (const OusterDriverException &) {
+    munmap(_map, _map_size);
+    throw;
+  }
+
+  _data = _map + _header->data_offset;
+  _data_size = _header->data_size;
+  _index = reinterpret_cast<const FrameIndexEntry *>(_map + _header->index_offset);
+  _frames = _header->frame_count;
+  madvise(_map, _map_size, MADV_SEQUENTIAL);
+}
+
+PacketReader::~PacketReader()
+{
+  munmap(_map, _map_size);
+}
+
+bool PacketReader::next(Packet & packet)
+{
+  if (_offset + sizeof(RecordHeader) > _data_size) {
+    return false;
+  }
+
+  RecordHeader record;
+  std::memcpy(&record, _data + _offset, sizeof(record));
+  const std::size_t size = recording::recordSize(record.size);
+  if (_offset + size > _data_size) {
+    return false;
+  }
+
+  packet.state = static_cast<ClientState>(record.state);
+  packet.data = _data + _offset + sizeof(RecordHeader);
+  packet.size = record.size;
+  packet.receive_time = record.receive_time;
+  _offset += size;
+  return true;
+}
+
+std::size_t PacketReader::seek(uint64_t time)
+{
+  const FrameIndexEntry * it = std::upper_bound(
+    _index, _index + _frames, time,
+    [](uint64_t t, const FrameIndexEntry & entry) {
+      return t < entry.time;
+    });
+  const std::size_t frame = it == _index ? 0 : static_cast<std::size_t>(it - _index) - 1;
+  seekFrame(frame);
+  return frame;
+}
+
+void PacketReader::seekFrame(std::size_t frame)
+{
+  _offset = frame < _frames ? _index[frame].offset : _data_size;
+}
+
+}  // namespace ros2_ouster
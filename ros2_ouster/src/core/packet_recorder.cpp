@@ -0,0 +1,186 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "ros2_ouster/core/frame_decoder.hpp"
+#include "ros2_ouster/core/packet_recorder.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+using recording::FrameIndexEntry;
+using recording::RecordHeader;
+using recording::RecordingHeader;
+
+namespace
+{
+
+inline std::size_t align8(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+}  // namespace
+
+PacketRecorder::PacketRecorder(
+  const std::string & path, const Metadata & mdata, std::size_t capacity)
+: _path(path),
+  _fd(-1),
+  _map(nullptr),
+  _map_size(0),
+  _header(nullptr),
+  _data(nullptr),
+  _index(nullptr),
+  _is_3d(mdata.lidar_vendor == std::string("OLE_3D_V2")),
+  _azimuth_last(-1),
+  _frame_start(true),
+  _packets(0),
+  _frames(0),
+  _dropped(0)
+{
+  const std::string metadata = recording::metadataToJson(mdata);
+  const std::size_t data_offset = align8(sizeof(RecordingHeader) + metadata.size());
+  capacity = align8(capacity);
+
+  // a frame holds at least one lidar packet
+  const std::size_t lidar_record = recording::recordSize(
+    static_cast<std::size_t>(mdata.lidar_packet_size > 0 ? mdata.lidar_packet_size : 1));
+  const std::size_t index_capacity = capacity / lidar_record + 1;
+  _map_size = data_offset + capacity + index_capacity * sizeof(FrameIndexEntry);
+
+  _fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (_fd < 0) {
+    throw OusterDriverException(
+            "Failed to create recording " + path + ": " + std::strerror(errno));
+  }
+
+  // reserve the blocks now, running out of space later would fault
+  // in the middle of a copy
+  const int err = posix_fallocate(_fd, 0, static_cast<off_t>(_map_size));
+  if (err != 0) {
+    ::close(_fd);
+    throw OusterDriverException(
+            "Failed to allocate " + std::to_string(_map_size) + " bytes for recording " +
+            path + ": " + std::strerror(err));
+  }
+
+  void * map = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+  if (map == MAP_FAILED) {
+    ::close(_fd);
+    throw OusterDriverException(
+            "Failed to map recording " + path + ": " + std::strerror(errno));
+  }
+  _map = static_cast<uint8_t *>(map);
+
+  _header = reinterpret_cast<RecordingHeader *>(_map);
+  std::memset(_header, 0, sizeof(RecordingHeader));
+  std::memcpy(_header->magic, recording::MAGIC, sizeof(_header->magic));
+  _header->version = recording::VERSION;
+  _header->metadata_size = static_cast<uint32_t>(metadata.size());
+  _header->data_offset = data_offset;
+  _header->data_capacity = capacity;
+  _header->index_offset = data_offset + capacity;
+  _header->index_capacity = index_capacity;
+  std::memcpy(_map + sizeof(RecordingHeader), metadata.data(), metadata.size());
+
+  _data = _map + data_offset;
+  _index = reinterpret_cast<FrameIndexEntry *>(_map + _header->index_offset);
+}
+
+PacketRecorder::~PacketRecorder()
+{
+  close();
+}
+
+bool PacketRecorder::write(const Packet & packet)
+{
+  if (!_header) {
+    return false;
+  }
+
+  const std::size_t size = recording::recordSize(packet.size);
+  if (_header->data_size + size > _header->data_capacity) {
+    _dropped++;
+    return false;
+  }
+
+  if (packet.state == ClientState::LIDAR_DATA) {
+    if (_frame_start && _header->frame_count < _header->index_capacity) {
+      FrameIndexEntry & entry = _index[_header->frame_count];
+      entry.time = packet.receive_time;
+      entry.offset = _header->data_size;
+      _header->frame_count++;
+    }
+    // the packet wrapping around is the last of its frame
+    _frame_start = FrameDecoder::wrapsAround(packet.data, _is_3d, _azimuth_last);
+  }
+
+  uint8_t * record = _data + _header->data_size;
+  RecordHeader record_header;
+  record_header.receive_time = packet.receive_time;
+  record_header.size = static_cast<uint32_t>(packet.size);
+  record_header.state = static_cast<uint32_t>(packet.state);
+  std::memcpy(record, &record_header, sizeof(record_header));
+  std::memcpy(record + sizeof(record_header), packet.data, packet.size);
+
+  // counters last, a crash leaves a consistent recording
+  if (_header->packet_count == 0) {
+    _header->first_time = packet.receive_time;
+  }
+  _header->last_time = packet.receive_time;
+  _header->data_size += size;
+  _header->packet_count++;
+  return true;
+}
+
+void PacketRecorder::close()
+{
+  if (!_header) {
+    return;
+  }
+
+  // move the index right after the records and drop the unused space
+  const std::size_t index_offset = _header->data_offset + _header->data_size;
+  const std::size_t index_size = _header->frame_count * sizeof(FrameIndexEntry);
+  std::memmove(_map + index_offset, _index, index_size);
+  _header->index_offset = index_offset;
+  _header->index_capacity = _header->frame_count;
+  _header->data_capacity = _header->data_size;
+  _header->complete = 1;
+
+  _packets = _header->packet_count;
+  _frames = _header->frame_count;
+  _header = nullptr;
+  _data = nullptr;
+  _index = nullptr;
+
+  msync(_map, _map_size, MS_ASYNC);
+  munmap(_map, _map_size);
+  _map = nullptr;
+
+  // if this fails the recording is still complete, with unused space at its end
+  const int truncated = ftruncate(_fd, static_cast<off_t>(index_offset + index_size));
+  (void)truncated;
+  ::close(_fd);
+  _fd = -1;
+}
+
+}  // namespace ros2_ouster
@@ -0,0 +1,88 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_ouster/core/pipeline_counters.hpp"
+
+namespace ros2_ouster
+{
+
+namespace
+{
+
+std::atomic<uint64_t> g_next_id(1);
+
+// the slot a thread was last assigned, by the instance it belongs to
+struct ThreadSlot
+{
+  uint64_t id{0};
+  void * slot{nullptr};
+};
+
+thread_local ThreadSlot t_slot;
+
+}  // namespace
+
+constexpr std::size_t PipelineCounters::SLOTS;
+
+const char * toString(PipelineCounter counter)
+{
+  switch (counter) {
+    case PipelineCounter::LIDAR_PACKETS:
+      return "lidar_packets";
+    case PipelineCounter::IMU_PACKETS:
+      return "imu_packets";
+    case PipelineCounter::DECODED_PACKETS:
+      return "decoded_packets";
+    case PipelineCounter::FRAMES:
+      return "frames";
+    case PipelineCounter::FRAME_PACKETS:
+      return "frame_packets";
+    case PipelineCounter::MISSING_PACKETS:
+      return "missing_packets";
+    default:
+      return "unknown";
+  }
+}
+
+PipelineCounters::PipelineCounters()
+: _next_slot(0),
+  _id(g_next_id.fetch_add(1, std::memory_order_relaxed))
+{
+  for (Slot & slot : _slots) {
+    for (std::atomic<uint64_t> & value : slot.values) {
+      value.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+uint64_t PipelineCounters::total(PipelineCounter counter) const
+{
+  uint64_t total = 0;
+  for (const Slot & slot : _slots) {
+    total += slot.values[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+PipelineCounters::Slot & PipelineCounters::slot()
+{
+  // a thread alternating between instances is reassigned a slot on each
+  // switch, threads of the driver stick to a single instance
+  if (t_slot.id != _id) {
+    t_slot.id = _id;
+    t_slot.slot = &_slots[_next_slot.fetch_add(1, std::memory_order_relaxed) % SLOTS];
+  }
+  return *static_cast<Slot *>(t_slot.slot);
+}
+
+}  // namespace ros2_ouster
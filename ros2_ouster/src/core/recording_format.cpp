@@ -0,0 +1,118 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "jsoncpp/json/json.h"
+#include "ros2_ouster/core/recording_format.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace ros2_ouster
+{
+
+namespace recording
+{
+
+namespace
+{
+
+template<typename T>
+Json::Value toArray(const std::vector<T> & values)
+{
+  Json::Value array(Json::arrayValue);
+  for (const T & value : values) {
+    array.append(static_cast<Json::Value>(value));
+  }
+  return array;
+}
+
+std::vector<double> toDoubles(const Json::Value & array)
+{
+  std::vector<double> values;
+  for (const Json::Value & value : array) {
+    values.push_back(value.asDouble());
+  }
+  return values;
+}
+
+}  // namespace
+
+std::string metadataToJson(const Metadata & mdata)
+{
+  Json::Value root;
+  root["computer_ip"] = mdata.computer_ip;
+  root["lidar_ip"] = mdata.lidar_ip;
+  root["imu_port"] = mdata.imu_port;
+  root["lidar_port"] = mdata.lidar_port;
+  root["lidar_vendor"] = mdata.lidar_vendor;
+  root["lidar_packet_size"] = mdata.lidar_packet_size;
+  root["imu_packet_size"] = mdata.imu_packet_size;
+  root["num_lasers"] = mdata.num_lasers;
+  root["distance_resolution"] = mdata.distance_resolution;
+  root["ring_scan"] = mdata.ring_scan;
+  root["x_offset_array"] = toArray(mdata.x_offset_array);
+  root["y_offset_array"] = toArray(mdata.y_offset_array);
+  root["ah_offset_array"] = toArray(mdata.ah_offset_array);
+  root["av_offset_array"] = toArray(mdata.av_offset_array);
+  root["imu_to_sensor_transform"] = toArray(mdata.imu_to_sensor_transform);
+  root["lidar_to_sensor_transform"] = toArray(mdata.lidar_to_sensor_transform);
+
+  Json::Value laser_ids(Json::arrayValue);
+  for (const int64_t id : mdata.laser_id_array) {
+    laser_ids.append(static_cast<Json::Int64>(id));
+  }
+  root["laser_id_array"] = laser_ids;
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  return Json::writeString(builder, root);
+}
+
+Metadata metadataFromJson(const std::string & json)
+{
+  Json::Value root;
+  std::string errors;
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  if (!reader->parse(json.data(), json.data() + json.size(), &root, &errors)) {
+    throw OusterDriverException("Malformed metadata in recording: " + errors);
+  }
+
+  Metadata mdata;
+  mdata.computer_ip = root["computer_ip"].asString();
+  mdata.lidar_ip = root["lidar_ip"].asString();
+  mdata.imu_port = root["imu_port"].asInt();
+  mdata.lidar_port = root["lidar_port"].asInt();
+  mdata.lidar_vendor = root["lidar_vendor"].asString();
+  mdata.lidar_packet_size = root["lidar_packet_size"].asInt();
+  mdata.imu_packet_size = root["imu_packet_size"].asInt();
+  mdata.num_lasers = root["num_lasers"].asInt();
+  mdata.distance_resolution = root["distance_resolution"].asDouble();
+  mdata.ring_scan = root["ring_scan"].asInt();
+  mdata.x_offset_array = toDoubles(root["x_offset_array"]);
+  mdata.y_offset_array = toDoubles(root["y_offset_array"]);
+  mdata.ah_offset_array = toDoubles(root["ah_offset_array"]);
+  mdata.av_offset_array = toDoubles(root["av_offset_array"]);
+  mdata.imu_to_sensor_transform = toDoubles(root["imu_to_sensor_transform"]);
+  mdata.lidar_to_sensor_transform = toDoubles(root["lidar_to_sensor_transform"]);
+  for (const Json::Value & id : root["laser_id_array"]) {
+    mdata.laser_id_array.push_back(id.asInt64());
+  }
+  return mdata;
+}
+
+}  // namespace recording
+
+}  // namespace ros2_ouster
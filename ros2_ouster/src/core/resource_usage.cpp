@@ -0,0 +1,150 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <dlfcn.h>
+#include <time.h>
+
+#include <cstdlib>
+#include <new>
+
+#include "ros2_ouster/core/resource_usage.hpp"
+
+namespace
+{
+
+// allocations of each thread, plain integers as only their thread writes
+// them and only it reads them
+thread_local uint64_t t_allocations = 0;
+thread_local uint64_t t_allocated_bytes = 0;
+
+}  // namespace
+
+namespace ros2_ouster
+{
+
+ResourceSample ResourceSample::now()
+{
+  ResourceSample sample;
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    sample.cpu_time = static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+      static_cast<uint64_t>(ts.tv_nsec);
+  }
+  sample.allocations = t_allocations;
+  sample.allocated_bytes = t_allocated_bytes;
+  return sample;
+}
+
+bool allocationsCounted()
+{
+#ifdef ROS2_OUSTER_ALLOCATION_COUNTING_ENABLED
+  // the replacement below only counts if the dynamic linker bound the
+  // process' operator new to this library. It binds the first definition
+  // found, libstdc++'s when it is loaded before this library, e.g. linked
+  // as needed or from a component loaded with dlopen.
+  static const bool counted = [] {
+      const char * symbol = sizeof(std::size_t) == 8 ? "_Znwm" : "_Znwj";
+      Dl_info bound;
+      Dl_info own;
+      void * address = dlsym(RTLD_DEFAULT, symbol);
+      return address && dladdr(address, &bound) != 0 &&
+             dladdr(reinterpret_cast<void *>(&allocationsCounted), &own) != 0 &&
+             bound.dli_fbase == own.dli_fbase;
+    }();
+  return counted;
+#else
+  return false;
+#endif
+}
+
+ResourceUsage::Totals ResourceUsage::Totals::since(const Totals & earlier) const
+{
+  Totals delta;
+  delta.calls = calls > earlier.calls ? calls - earlier.calls : 0;
+  delta.cpu_time = cpu_time > earlier.cpu_time ? cpu_time - earlier.cpu_time : 0;
+  delta.allocations = allocations > earlier.allocations ? allocations - earlier.allocations : 0;
+  delta.allocated_bytes = allocated_bytes > earlier.allocated_bytes ?
+    allocated_bytes - earlier.allocated_bytes : 0;
+  return delta;
+}
+
+ResourceUsage::ResourceUsage()
+: _calls(0),
+  _cpu_time(0),
+  _allocations(0),
+  _allocated_bytes(0)
+{
+}
+
+ResourceUsage::Totals ResourceUsage::totals() const
+{
+  Totals totals;
+  totals.calls = _calls.load(std::memory_order_relaxed);
+  totals.cpu_time = _cpu_time.load(std::memory_order_relaxed);
+  totals.allocations = _allocations.load(std::memory_order_relaxed);
+  totals.allocated_bytes = _allocated_bytes.load(std::memory_order_relaxed);
+  return totals;
+}
+
+void ResourceUsage::reset()
+{
+  _calls.store(0, std::memory_order_relaxed);
+  _cpu_time.store(0, std::memory_order_relaxed);
+  _allocations.store(0, std::memory_order_relaxed);
+  _allocated_bytes.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace ros2_ouster
+
+#ifdef ROS2_OUSTER_ALLOCATION_COUNTING_ENABLED
+
+// replaces the global operator new of the process, as the benchmarks'
+// allocation counter does, but counting per thread; the nothrow forms of
+// the standard library call these
+void * operator new(std::size_t size)
+{
+  t_allocations++;
+  t_allocated_bytes += size;
+  void * ptr = std::malloc(size > 0 ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void * operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+#endif
@@ -0,0 +1,182 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <getopt.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ros2_ouster/core/load_generator.hpp"
+#include "ros2_ouster/exception.hpp"
+
+namespace
+{
+
+std::atomic<bool> g_stop(false);
+
+void onSignal(int)
+{
+  g_stop = true;
+}
+
+void usage(const char * name)
+{
+  std::printf(
+    "Usage: %s [options]\n"
+    "Sends the lidar packets of emulated sensors over UDP, to load a driver.\n"
+    "  --sensors N          number of sensors (1)\n"
+    "  --host ADDRESS       destination IPv4 address (127.0.0.1)\n"
+    "  --port PORT          port of the first sensor (2368)\n"
+    "  --port-stride N      added to the port for each further sensor (1)\n"
+    "  --vendor FORMAT      OLE_3D_V2 or OLE_2D_V2, for synthetic packets (OLE_3D_V2)\n"
+    "  --rotation-rate HZ   revolutions per second of synthetic sensors (10)\n"
+    "  --range-noise M      standard deviation of synthetic ranges (0)\n"
+    "  --dropout RATIO      ratio of synthetic returns missing (0)\n"
+    "  --recording PATH     replay a recording in place of synthetic packets\n"
+    "  --rate FACTOR        speed relative to the sensors, 0 as fast as possible (1)\n"
+    "  --jitter-us US       standard deviation of the send times (0)\n"
+    "  --loss RATIO         ratio of packets not sent (0)\n"
+    "  --reorder RATIO      ratio of packets sent after the next one (0)\n"
+    "  --duration S         stop after this long, 0 to run until interrupted (0)\n"
+    "  --seed N             seed of the noise, jitter, loss and reordering (0)\n",
+    name);
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  int sensors = 1;
+  std::string vendor = "OLE_3D_V2";
+  double rotation_rate = 10.0;
+  double duration = 0.0;
+  std::string recording;
+  ros2_ouster::LoadGeneratorOptions options;
+  ros2_ouster::SyntheticScene scene = ros2_ouster::SyntheticScene::room();
+
+  const option long_options[] = {
+    {"sensors", required_argument, nullptr, 'n'},
+    {"host", required_argument, nullptr, 'H'},
+    {"port", required_argument, nullptr, 'p'},
+    {"port-stride", required_argument, nullptr, 's'},
+    {"vendor", required_argument, nullptr, 'v'},
+    {"rotation-rate", required_argument, nullptr, 'r'},
+    {"range-noise", required_argument, nullptr, 'N'},
+    {"dropout", required_argument, nullptr, 'D'},
+    {"recording", required_argument, nullptr, 'f'},
+    {"rate", required_argument, nullptr, 'R'},
+    {"jitter-us", required_argument, nullptr, 'j'},
+    {"loss", required_argument, nullptr, 'l'},
+    {"reorder", required_argument, nullptr, 'o'},
+    {"duration", required_argument, nullptr, 'd'},
+    {"seed", required_argument, nullptr, 'S'},
+    {"help", no_argument, nullptr, 'h'},
+    {nullptr, 0, nullptr, 0}
+  };
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "h", long_options, nullptr)) != -1) {
+    switch (opt) {
+      case 'n': sensors = std::atoi(optarg); break;
+      case 'H': options.host = optarg; break;
+      case 'p': options.port = std::atoi(optarg); break;
+      case 's': options.port_stride = std::atoi(optarg); break;
+      case 'v': vendor = optarg; break;
+      case 'r': rotation_rate = std::atof(optarg); break;
+      case 'N': scene.range_noise = std::atof(optarg); break;
+      case 'D': scene.dropout = std::atof(optarg); break;
+      case 'f': recording = optarg; break;
+      case 'R': options.rate = std::atof(optarg); break;
+      case 'j': options.jitter = std::atof(optarg) * 1e-6; break;
+      case 'l': options.loss = std::atof(optarg); break;
+      case 'o': options.reorder = std::atof(optarg); break;
+      case 'd': duration = std::atof(optarg); break;
+      case 'S': options.seed = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+
+  if (sensors < 1) {
+    std::fprintf(stderr, "At least one sensor is needed.\n");
+    return 1;
+  }
+
+  std::unique_ptr<ros2_ouster::LoadGenerator> generator;
+  try {
+    std::vector<std::unique_ptr<ros2_ouster::PacketSource>> sources;
+    if (!recording.empty()) {
+      auto packets = ros2_ouster::RecordedPackets::load(recording);
+      for (int i = 0; i < sensors; i++) {
+        sources.push_back(std::make_unique<ros2_ouster::RecordedPacketSource>(packets));
+      }
+    } else {
+      const ros2_ouster::Metadata mdata = ros2_ouster::syntheticMetadata(vendor);
+      for (int i = 0; i < sensors; i++) {
+        sources.push_back(
+          std::make_unique<ros2_ouster::SyntheticPacketSource>(
+            mdata, scene, rotation_rate, options.seed + i));
+      }
+    }
+    generator = std::make_unique<ros2_ouster::LoadGenerator>(options, std::move(sources));
+  } catch (const ros2_ouster::OusterDriverException & e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+
+  std::printf(
+    "Sending %d sensor(s) to %s:%d, port stride %d\n",
+    sensors, options.host.c_str(), options.port, options.port_stride);
+  std::printf("%8s %12s %12s %10s %10s %10s %8s\n",
+    "time(s)", "sent", "packets/s", "lost", "reordered", "late", "errors");
+
+  const auto start = std::chrono::steady_clock::now();
+  generator->start();
+  int reports = 0;
+  while (!g_stop) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const double elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    const bool done = duration > 0.0 && elapsed >= duration;
+    if (elapsed >= reports + 1 || done) {
+      reports++;
+      const ros2_ouster::LoadStatistics stats = generator->statistics();
+      std::printf(
+        "%8.1f %12lu %12.1f %10lu %10lu %10lu %8lu\n",
+        elapsed, static_cast<unsigned long>(stats.sent), generator->packetRate(),
+        static_cast<unsigned long>(stats.lost), static_cast<unsigned long>(stats.reordered),
+        static_cast<unsigned long>(stats.late), static_cast<unsigned long>(stats.errors));
+      std::fflush(stdout);
+    }
+    if (done) {
+      break;
+    }
+  }
+  generator->stop();
+  return 0;
+}
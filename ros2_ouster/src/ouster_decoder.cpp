@@ -0,0 +1,234 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/qos.hpp"
+#include "rclcpp_components/register_node_macro.hpp"
+#include "ros2_ouster/ouster_decoder.hpp"
+#include "ros2_ouster/exception.hpp"
+#include "ros2_ouster/OS1/processor_factories.hpp"
+
+namespace ros2_ouster
+{
+
+using std::placeholders::_1;
+
+OusterDecoder::OusterDecoder(const rclcpp::NodeOptions & options)
+: LifecycleInterface("OusterDecoder", options),
+  _use_system_default_qos(false),
+  _os1_proc_mask(0)
+{
+  this->declare_parameter("laser_frame", rclcpp::ParameterValue(std::string("laser_data_frame")));
+  this->declare_parameter("imu_frame", rclcpp::ParameterValue(std::string("imu_data_frame")));
+  this->declare_parameter("use_system_default_qos", rclcpp::ParameterValue(false));
+  this->declare_parameter("os1_proc_mask", rclcpp::ParameterValue(std::string("PCL")));
+  this->declare_parameter("processor_threads", rclcpp::ParameterValue(1));
+  this->declare_parameter(
+    "processor_thread_affinity", rclcpp::ParameterValue(std::vector<int64_t>()));
+  this->declare_parameter(
+    "frame_file_directory", rclcpp::ParameterValue(std::string("/tmp/ouster_frames")));
+  this->declare_parameter("frame_file_format", rclcpp::ParameterValue(std::string("pcd")));
+  this->declare_parameter("frame_file_every", rclcpp::ParameterValue(1));
+  this->declare_parameter("frame_file_direct_io", rclcpp::ParameterValue(false));
+  this->declare_parameter(
+    "frame_ring_name", rclcpp::ParameterValue(std::string("/ouster_frames")));
+  this->declare_parameter("frame_ring_slots", rclcpp::ParameterValue(4));
+}
+
+OusterDecoder::~OusterDecoder()
+{
+  destroyProcessors();
+}
+
+void OusterDecoder::onConfigure()
+{
+  _laser_data_frame = get_parameter("laser_frame").as_string();
+  _imu_data_frame = get_parameter("imu_frame").as_string();
+  _use_system_default_qos = get_parameter("use_system_default_qos").as_bool();
+
+  // packets are already batched, publishing them again makes no sense
+  _os1_proc_mask =
+    ros2_ouster::toProcMask(get_parameter("os1_proc_mask").as_string()) &
+    ~ros2_ouster::OS1_PROC_RAW;
+
+  const int processor_threads = get_parameter("processor_threads").as_int();
+  const std::vector<int64_t> affinity_param =
+    get_parameter("processor_thread_affinity").as_integer_array();
+  const std::vector<int> affinity(affinity_param.begin(), affinity_param.end());
+  try {
+    _scheduler = std::make_unique<ProcessorScheduler>(
+      static_cast<std::size_t>(std::max(processor_threads, 1)), affinity);
+    _frame_files.directory = get_parameter("frame_file_directory").as_string();
+    _frame_files.format = toFrameFileFormat(get_parameter("frame_file_format").as_string());
+    _frame_files.every =
+      static_cast<std::size_t>(std::max<int64_t>(get_parameter("frame_file_every").as_int(), 1));
+    _frame_files.direct_io = get_parameter("frame_file_direct_io").as_bool();
+    _frame_ring.name = get_parameter("frame_ring_name").as_string();
+    _frame_ring.slots =
+      static_cast<std::size_t>(std::max<int64_t>(get_parameter("frame_ring_slots").as_int(), 1));
+  } catch (const OusterDriverException & e) {
+    RCLCPP_FATAL(this->get_logger(), "Exception thrown: (%s)", e.what());
+    exit(-1);
+  }
+
+  // the metadata is latched by the driver
+  _metadata_sub = this->create_subscription<ouster_msgs::msg::Metadata>(
+    "metadata", rclcpp::QoS(1).transient_local(),
+    std::bind(&OusterDecoder::metadataCallback, this, _1));
+
+  const rclcpp::QoS qos = _use_system_default_qos ?
+    rclcpp::QoS(rclcpp::SystemDefaultsQoS()) : rclcpp::QoS(rclcpp::SensorDataQoS());
+  _packets_sub = this->create_subscription<ouster_msgs::msg::PacketBatch>(
+    "packets", qos, std::bind(&OusterDecoder::packetsCallback, this, _1));
+}
+
+void OusterDecoder::onActivate()
+{
+  DataProcessorMapIt it;
+  for (it = _data_processors.begin(); it != _data_processors.end(); ++it) {
+    it->second->onActivate();
+  }
+}
+
+void OusterDecoder::onError()
+{
+}
+
+void OusterDecoder::onDeactivate()
+{
+  DataProcessorMapIt it;
+  for (it = _data_processors.begin(); it != _data_processors.end(); ++it) {
+    it->second->onDeactivate();
+  }
+}
+
+void OusterDecoder::onCleanup()
+{
+  _packets_sub.reset();
+  _metadata_sub.reset();
+  destroyProcessors();
+  _scheduler.reset();
+  _metadata.reset();
+}
+
+void OusterDecoder::onShutdown()
+{
+  _packets_sub.reset();
+  _metadata_sub.reset();
+  destroyProcessors();
+  _scheduler.reset();
+}
+
+void OusterDecoder::metadataCallback(const ouster_msgs::msg::Metadata::SharedPtr msg)
+{
+  if (_metadata && *_metadata == *msg) {
+    return;
+  }
+
+  RCLCPP_INFO(
+    this->get_logger(), "Decoding packets of a %s sensor with %i lasers.",
+    msg->lidar_vendor.c_str(), msg->num_lasers);
+
+  // publishers of the previous processors are destroyed before
+  // those of the new ones are created
+  destroyProcessors();
+  _metadata = std::make_unique<ouster_msgs::msg::Metadata>(*msg);
+
+  const ros2_ouster::Metadata mdata = fromMsg(*msg);
+
+  // recorded packets are old by design, they are never dropped as stale
+  try {
+    if (_use_system_default_qos) {
+      _data_processors = ros2_ouster::createProcessors(
+        shared_from_this(), mdata, _imu_data_frame, _laser_data_frame,
+        rclcpp::SystemDefaultsQoS(), _os1_proc_mask, 0, _frame_files, _frame_ring);
+    } else {
+      _data_processors = ros2_ouster::createProcessors(
+        shared_from_this(), mdata, _imu_data_frame, _laser_data_frame,
+        rclcpp::SensorDataQoS(), _os1_proc_mask, 0, _frame_files, _frame_ring);
+    }
+    _scheduler->configure(_data_processors);
+  } catch (const OusterDriverException & e) {
+    RCLCPP_FATAL(this->get_logger(), "Exception thrown: (%s)", e.what());
+    exit(-1);
+  }
+
+  if (this->isActive()) {
+    DataProcessorMapIt it;
+    for (it = _data_processors.begin(); it != _data_processors.end(); ++it) {
+      it->second->onActivate();
+    }
+  }
+}
+
+void OusterDecoder::packetsCallback(std::unique_ptr<ouster_msgs::msg::PacketBatch> msg)
+{
+  if (!this->isActive()) {
+    return;
+  }
+
+  if (!_metadata) {
+    RCLCPP_WARN_THROTTLE(
+      this->get_logger(), *this->get_clock(), 5000,
+      "Received packets but no metadata yet, dropping them.");
+    return;
+  }
+
+  if (msg->packet_size == 0 ||
+    msg->data.size() != msg->packet_size * msg->receive_times.size())
+  {
+    RCLCPP_WARN(
+      this->get_logger(), "Dropping malformed batch of %zu bytes.", msg->data.size());
+    return;
+  }
+
+  // the decoders read fixed offsets of the packets of the sensor
+  if (msg->packet_size != static_cast<uint32_t>(_metadata->lidar_packet_size)) {
+    RCLCPP_WARN_THROTTLE(
+      this->get_logger(), *this->get_clock(), 5000,
+      "Dropping batch of %u byte packets, the sensor sends %i byte packets.",
+      msg->packet_size, _metadata->lidar_packet_size);
+    return;
+  }
+
+  Packet packet;
+  packet.state = ClientState::LIDAR_DATA;
+  packet.size = msg->packet_size;
+  for (std::size_t i = 0; i < msg->receive_times.size(); i++) {
+    packet.data = msg->data.data() + i * msg->packet_size;
+    packet.receive_time = msg->receive_times[i];
+    _scheduler->process(packet);
+  }
+}
+
+void OusterDecoder::destroyProcessors()
+{
+  if (_scheduler) {
+    _scheduler->clear();
+  }
+
+  DataProcessorMapIt it;
+  for (it = _data_processors.begin(); it != _data_processors.end(); ++it) {
+    delete it->second;
+  }
+  _data_processors.clear();
+}
+
+}  // namespace ros2_ouster
+
+RCLCPP_COMPONENTS_REGISTER_NODE(ros2_ouster::OusterDecoder)
@@ -11,6 +11,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -22,6 +23,8 @@
 #include "ros2_ouster/exception.hpp"
 #include "ros2_ouster/interfaces/lifecycle_interface.hpp"
 #include "ros2_ouster/interfaces/sensor_interface.hpp"
+#include "ros2_ouster/OS1/pcap_sensor.hpp"
+#include "ros2_ouster/OS1/synthetic_sensor.hpp"
 #include "ros2_ouster/OS1/processor_factories.hpp"
 
 namespace ros2_ouster
@@ -35,12 +38,15 @@ using namespace std::chrono_literals;
 OusterDriver::OusterDriver(
   std::unique_ptr<SensorInterface> sensor,
   const rclcpp::NodeOptions & options)
-: LifecycleInterface("OusterDriver", options), _sensor{std::move(sensor)}
+: LifecycleInterface("OusterDriver", options),
+  _core{std::make_unique<OusterCore>(std::move(sensor))}
 {
   // added by zyl for clang warning
   _use_system_default_qos = false;
   _use_ros_time =false;
+  _idle = false;
   _os1_proc_mask = 0;
+  _reported_drops = 0;
 
   // modified by zyl
   this->declare_parameter("lidar_ip", "192.168.1.100");
@@ -57,6 +63,38 @@ OusterDriver::OusterDriver(
   this->declare_parameter("use_system_default_qos", rclcpp::ParameterValue(false));
   // used to gen processor,
   this->declare_parameter("os1_proc_mask", rclcpp::ParameterValue(std::string("PCL")));
+  this->declare_parameter("packets_per_message", rclcpp::ParameterValue(0));
+  this->declare_parameter(
+    "frame_file_directory", rclcpp::ParameterValue(std::string("/tmp/ouster_frames")));
+  this->declare_parameter("frame_file_format", rclcpp::ParameterValue(std::string("pcd")));
+  this->declare_parameter("frame_file_every", rclcpp::ParameterValue(1));
+  this->declare_parameter("frame_file_direct_io", rclcpp::ParameterValue(false));
+  this->declare_parameter(
+    "frame_ring_name", rclcpp::ParameterValue(std::string("/ouster_frames")));
+  this->declare_parameter("frame_ring_slots", rclcpp::ParameterValue(4));
+  this->declare_parameter("processor_threads", rclcpp::ParameterValue(1));
+  this->declare_parameter(
+    "processor_thread_affinity", rclcpp::ParameterValue(std::vector<int64_t>()));
+  this->declare_parameter("max_frame_age", rclcpp::ParameterValue(0.0));
+  this->declare_parameter("cpu_budget", rclcpp::ParameterValue(0.0));
+  this->declare_parameter("idle_without_subscribers", rclcpp::ParameterValue(true));
+  this->declare_parameter("record_file", rclcpp::ParameterValue(std::string("")));
+  this->declare_parameter("record_size_mb", rclcpp::ParameterValue(1024));
+  this->declare_parameter("record_compression", rclcpp::ParameterValue(false));
+  this->declare_parameter("flight_recorder_seconds", rclcpp::ParameterValue(0.0));
+  this->declare_parameter("statistics_period", rclcpp::ParameterValue(1.0));
+  this->declare_parameter("diagnostics_period", rclcpp::ParameterValue(1.0));
+  this->declare_parameter("diagnostics_min_packet_rate", rclcpp::ParameterValue(0.0));
+  this->declare_parameter("diagnostics_min_frame_rate", rclcpp::ParameterValue(0.0));
+  this->declare_parameter("diagnostics_min_completeness", rclcpp::ParameterValue(0.95));
+  this->declare_parameter("diagnostics_max_kernel_drop_rate", rclcpp::ParameterValue(0.0));
+  this->declare_parameter("diagnostics_max_user_drop_rate", rclcpp::ParameterValue(0.0));
+  this->declare_parameter("diagnostics_max_decode_time", rclcpp::ParameterValue(0.001));
+  this->declare_parameter("diagnostics_max_publish_time", rclcpp::ParameterValue(0.02));
+  this->declare_parameter("metrics_port", rclcpp::ParameterValue(0));
+  this->declare_parameter(
+    "flight_recorder_file",
+    rclcpp::ParameterValue(std::string("/tmp/ouster_flight_recorder.ring")));
 
   // added by zyl
   this->declare_parameter("x_offset_array");
@@ -68,6 +106,12 @@ OusterDriver::OusterDriver(
   this->declare_parameter("distance_resolution");
   this->declare_parameter("ring_scan");
   this->declare_parameter("lidar_vendor", rclcpp::ParameterValue(std::string("OLE_3D_V2")));
+  this->declare_parameter("sensor_type", rclcpp::ParameterValue(std::string("sensor")));
+  this->declare_parameter("pcap_file", rclcpp::ParameterValue(std::string("")));
+  this->declare_parameter("replay_rate", rclcpp::ParameterValue(1.0));
+  this->declare_parameter("synthetic_rotation_rate", rclcpp::ParameterValue(10.0));
+  this->declare_parameter("synthetic_range_noise", rclcpp::ParameterValue(0.0));
+  this->declare_parameter("synthetic_dropout", rclcpp::ParameterValue(0.0));
 
 }
 
@@ -136,14 +180,6 @@ void OusterDriver::onConfigure()
   _metadata_srv = this->create_service<ouster_msgs::srv::GetMetadata>(
     "~/get_metadata", std::bind(&OusterDriver::getMetadata, this, _1, _2, _3));
 
-  //
-  try {
-    _sensor->configure(lidar_config);
-  } catch (const OusterDriverException & e) {
-    RCLCPP_FATAL(this->get_logger(), "Exception thrown: (%s)", e.what());
-    exit(-1);
-  }
-
   // added by zyl
   // ros2_ouster::Metadata mdata;
 
@@ -178,19 +214,248 @@ void OusterDriver::onConfigure()
   //ros2_ouster::Metadata mdata = _sensor->getMetadata();
   // end of added
 
-  // create processors according _os1_proc_mask
-  if (_use_system_default_qos) {
+  // replay a capture in place of the sensor
+  if (get_parameter("sensor_type").as_string() == "pcap") {
+    const std::string pcap_file = get_parameter("pcap_file").as_string();
+    const double replay_rate = get_parameter("replay_rate").as_double();
+    if (replay_rate > 0.0) {
+      RCLCPP_INFO(
+        this->get_logger(), "Replaying %s at %.2fx speed.", pcap_file.c_str(), replay_rate);
+    } else {
+      RCLCPP_INFO(
+        this->get_logger(), "Replaying %s as fast as possible.", pcap_file.c_str());
+    }
+    _core = std::make_unique<OusterCore>(
+      std::make_unique<OS1::PcapSensor>(pcap_file, replay_rate));
+  } else if (get_parameter("sensor_type").as_string() == "synthetic") {
+    // a room seen by a sensor of the configured format
+    ros2_ouster::SyntheticScene scene = ros2_ouster::SyntheticScene::room();
+    scene.range_noise = get_parameter("synthetic_range_noise").as_double();
+    scene.dropout = get_parameter("synthetic_dropout").as_double();
+    const double rotation_rate = get_parameter("synthetic_rotation_rate").as_double();
+    const double replay_rate = get_parameter("replay_rate").as_double();
     RCLCPP_INFO(
-      this->get_logger(), "Using system defaults QoS for sensor data");
-    _data_processors = ros2_ouster::createProcessors(
-      shared_from_this(), mdata, _imu_data_frame, _laser_data_frame,
-      rclcpp::SystemDefaultsQoS(), _os1_proc_mask);
-  } else {
-    _data_processors = ros2_ouster::createProcessors(
-      shared_from_this(), mdata, _imu_data_frame, _laser_data_frame,
-      rclcpp::SensorDataQoS(), _os1_proc_mask);
+      this->get_logger(), "Generating synthetic %s packets at %.1f Hz.",
+      mdata.lidar_vendor.c_str(), rotation_rate);
+    _core = std::make_unique<OusterCore>(
+      std::make_unique<OS1::SyntheticSensor>(mdata, scene, rotation_rate, replay_rate));
+  }
+
+  try {
+    _core->configure(lidar_config, mdata);
+  } catch (const OusterDriverException & e) {
+    RCLCPP_FATAL(this->get_logger(), "Exception thrown: (%s)", e.what());
+    exit(-1);
+  }
+
+  // latched, so that late subscribers such as recorders can decode packets
+  _metadata_pub = this->create_publisher<ouster_msgs::msg::Metadata>(
+    "metadata", rclcpp::QoS(1).transient_local());
+
+  // latencies of each stage and processor, published periodically as the
+  // change over the period and served as totals
+  _statistics = std::make_unique<PipelineStatistics>();
+  _statistics_start = std::chrono::steady_clock::now();
+  _statistics_pub = this->create_publisher<ouster_msgs::msg::PipelineStatistics>(
+    "statistics", rclcpp::QoS(10));
+  _statistics_srv = this->create_service<ouster_msgs::srv::GetStatistics>(
+    "~/get_statistics", std::bind(&OusterDriver::getStatistics, this, _1, _2, _3));
+
+  // health over each period checked against thresholds, for fleet monitoring
+  HealthThresholds thresholds;
+  thresholds.min_packet_rate = get_parameter("diagnostics_min_packet_rate").as_double();
+  thresholds.min_frame_rate = get_parameter("diagnostics_min_frame_rate").as_double();
+  thresholds.min_completeness = get_parameter("diagnostics_min_completeness").as_double();
+  thresholds.max_kernel_drop_rate =
+    get_parameter("diagnostics_max_kernel_drop_rate").as_double();
+  thresholds.max_user_drop_rate = get_parameter("diagnostics_max_user_drop_rate").as_double();
+  thresholds.max_decode_time = get_parameter("diagnostics_max_decode_time").as_double();
+  thresholds.max_publish_time = get_parameter("diagnostics_max_publish_time").as_double();
+  _health = std::make_unique<HealthMonitor>(thresholds);
+  _diagnostics_pub = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+    "/diagnostics", rclcpp::QoS(10));
+
+  // create processors according _os1_proc_mask
+  const std::size_t packets_per_message =
+    static_cast<std::size_t>(std::max<int64_t>(get_parameter("packets_per_message").as_int(), 0));
+  try {
+    ros2_ouster::FrameWriterOptions frame_files;
+    frame_files.directory = get_parameter("frame_file_directory").as_string();
+    frame_files.format = toFrameFileFormat(get_parameter("frame_file_format").as_string());
+    frame_files.every =
+      static_cast<std::size_t>(std::max<int64_t>(get_parameter("frame_file_every").as_int(), 1));
+    frame_files.direct_io = get_parameter("frame_file_direct_io").as_bool();
+    ros2_ouster::FrameRingOptions frame_ring;
+    frame_ring.name = get_parameter("frame_ring_name").as_string();
+    frame_ring.slots =
+      static_cast<std::size_t>(std::max<int64_t>(get_parameter("frame_ring_slots").as_int(), 1));
+
+    if (_use_system_default_qos) {
+      RCLCPP_INFO(
+        this->get_logger(), "Using system defaults QoS for sensor data");
+      _data_processors = ros2_ouster::createProcessors(
+        shared_from_this(), mdata, _imu_data_frame, _laser_data_frame,
+        rclcpp::SystemDefaultsQoS(), _os1_proc_mask, packets_per_message, frame_files,
+        frame_ring);
+    } else {
+      _data_processors = ros2_ouster::createProcessors(
+        shared_from_this(), mdata, _imu_data_frame, _laser_data_frame,
+        rclcpp::SensorDataQoS(), _os1_proc_mask, packets_per_message, frame_files,
+        frame_ring);
+    }
+  } catch (const OusterDriverException & e) {
+    RCLCPP_FATAL(this->get_logger(), "Exception thrown: (%s)", e.what());
+    exit(-1);
+  }
+
+  // outputs older than this when about to be published are dropped
+  const double max_frame_age = get_parameter("max_frame_age").as_double();
+  _deadline = std::make_unique<FrameDeadline>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(std::max(max_frame_age, 0.0))));
+  _reported_drops = 0;
+
+  // load is shed in steps while decoding and processing exceed the budget
+  const double cpu_budget = get_parameter("cpu_budget").as_double();
+  if (cpu_budget > 0.0) {
+    _load = std::make_unique<LoadController>(cpu_budget);
+  }
+
+  for (DataProcessorMapIt it = _data_processors.begin(); it != _data_processors.end(); ++it) {
+    it->second->setFrameDeadline(_deadline.get());
+    it->second->setLoadController(_load.get());
+    it->second->setStatistics(_statistics.get());
+  }
+
+  // counters and latencies for Prometheus to scrape, on localhost only
+  const int metrics_port = get_parameter("metrics_port").as_int();
+  if (metrics_port > 0) {
+    try {
+      _metrics = std::make_unique<MetricsServer>(*_statistics, metrics_port);
+      _metrics->addCounter(
+        "kernel_drops", "Packets dropped by the kernel for a full socket buffer.",
+        [this]() {return _core->kernelDrops();});
+      _metrics->addCounter(
+        "stale_outputs", "Outputs dropped for being older than max_frame_age.",
+        [this]() {return _deadline->dropped();});
+    } catch (const OusterDriverException & e) {
+      RCLCPP_WARN(this->get_logger(), "Not serving metrics: %s", e.what());
+    }
+  }
+
+  const int processor_threads = get_parameter("processor_threads").as_int();
+  const std::vector<int64_t> affinity_param =
+    get_parameter("processor_thread_affinity").as_integer_array();
+  const std::vector<int> affinity(affinity_param.begin(), affinity_param.end());
+  try {
+    _scheduler = std::make_unique<ProcessorScheduler>(
+      static_cast<std::size_t>(std::max(processor_threads, 1)), affinity);
+    _scheduler->configure(_data_processors);
+  } catch (const OusterDriverException & e) {
+    RCLCPP_FATAL(this->get_logger(), "Exception thrown: (%s)", e.what());
+    exit(-1);
+  }
+
+  // raw packets are recorded as received, before any processing
+  const std::string record_file = get_parameter("record_file").as_string();
+  if (!record_file.empty()) {
+    const int64_t record_size_mb = std::max<int64_t>(get_parameter("record_size_mb").as_int(), 1);
+    const bool record_compression = get_parameter("record_compression").as_bool();
+    try {
+      if (record_compression) {
+        _compressed_recorder = std::make_unique<CompressedRecorder>(
+          record_file, mdata, static_cast<std::size_t>(record_size_mb) << 20);
+      } else {
+        _recorder = std::make_unique<PacketRecorder>(
+          record_file, mdata, static_cast<std::size_t>(record_size_mb) << 20);
+      }
+    } catch (const OusterDriverException & e) {
+      RCLCPP_FATAL(this->get_logger(), "Exception thrown: (%s)", e.what());
+      exit(-1);
+    }
+    if (record_compression) {
+      RCLCPP_INFO(
+        this->get_logger(), "Recording compressed packets to %s, up to %li MB.",
+        record_file.c_str(), static_cast<long>(record_size_mb));
+    } else {
+      RCLCPP_INFO(
+        this->get_logger(), "Recording packets to %s, up to %li MB.",
+        record_file.c_str(), static_cast<long>(record_size_mb));
+    }
+  }
+
+  // the last packets are kept in memory, dumped on request or anomalies
+  const double flight_recorder_seconds = get_parameter("flight_recorder_seconds").as_double();
+  if (flight_recorder_seconds > 0.0) {
+    const std::string flight_recorder_file = get_parameter("flight_recorder_file").as_string();
+    try {
+      _flight_recorder = std::make_unique<FlightRecorder>(
+        flight_recorder_file, mdata,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>(flight_recorder_seconds)));
+    } catch (const OusterDriverException & e) {
+      RCLCPP_FATAL(this->get_logger(), "Exception thrown: (%s)", e.what());
+      exit(-1);
+    }
+
+    if (!_flight_recorder->recovered().empty()) {
+      RCLCPP_WARN(
+        this->get_logger(), "Previous run did not shut down cleanly, dumped its last packets to %s.",
+        _flight_recorder->recovered().c_str());
+    }
+    _flight_recorder->setDumpCallback(
+      [this](const std::string & path, const std::string & reason) {
+        RCLCPP_WARN(
+          this->get_logger(), "Flight recorder dumped the last packets to %s (%s).",
+          path.c_str(), reason.c_str());
+      });
+    _flight_recorder_srv = this->create_service<std_srvs::srv::Trigger>(
+      "~/dump_flight_recorder",
+      std::bind(&OusterDriver::dumpFlightRecorder, this, _1, _2, _3));
   }
 
+  // packets are decoded and published by the processors
+  _core->setPacketCallback(
+    [this](const Packet & packet) {
+      if (_flight_recorder) {
+        _flight_recorder->write(packet);
+      }
+      if (_recorder && !_recorder->write(packet) && _recorder->dropped() == 1) {
+        RCLCPP_WARN(
+          this->get_logger(), "Recording %s is full, no longer recording packets.",
+          _recorder->path().c_str());
+      }
+      if (_compressed_recorder && !_compressed_recorder->write(packet)) {
+        RCLCPP_WARN_THROTTLE(
+          this->get_logger(), *this->get_clock(), 5000,
+          "Dropped %lu packets in total from recording %s, it is full or "
+          "compressing too slowly.",
+          static_cast<unsigned long>(_compressed_recorder->dropped()),
+          _compressed_recorder->path().c_str());
+      }
+
+      // the kernel stamps packets with the system clock on receipt
+      const int64_t received = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+      _statistics->stage(PipelineStage::RECEIVE).record(
+        static_cast<uint64_t>(std::max<int64_t>(
+          received - static_cast<int64_t>(packet.receive_time), 0)));
+      _statistics->counters().add(
+        packet.state == ClientState::LIDAR_DATA ?
+        PipelineCounter::LIDAR_PACKETS : PipelineCounter::IMU_PACKETS);
+
+      uint64_t override_ts =
+      this->_use_ros_time ? this->now().nanoseconds() : 0;
+      if (!_load) {
+        _scheduler->process(packet, override_ts);
+        return;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      _scheduler->process(packet, override_ts);
+      _load->addBusyTime(std::chrono::steady_clock::now() - start);
+    });
+
   // tf2 broadcast
 
   // _tf_b = std::make_unique<tf2_ros::StaticTransformBroadcaster>(
@@ -201,6 +466,11 @@ void OusterDriver::onConfigure()
 
 void OusterDriver::onActivate()
 {
+  _metadata_pub->on_activate();
+  _metadata_pub->publish(toMsg(mdata));
+  _statistics_pub->on_activate();
+  _diagnostics_pub->on_activate();
+
   DataProcessorMapIt it;
   for (it = _data_processors.begin(); it != _data_processors.end(); ++it) {
     it->second->onActivate();
@@ -213,6 +483,44 @@ void OusterDriver::onActivate()
   _process_timer = this->create_wall_timer(
 	1000000ns,
 	std::bind(&OusterDriver::processData, this));
+
+  // Checked at a fraction of the frame period, so that processing resumes
+  // within a frame of a subscriber appearing.
+  _idle = false;
+  if (get_parameter("idle_without_subscribers").as_bool()) {
+    if (isRecording()) {
+      RCLCPP_INFO(
+        this->get_logger(), "Recording packets, processing continues without subscribers.");
+    }
+    _idle_timer = this->create_wall_timer(
+      50ms, std::bind(&OusterDriver::checkSubscribers, this));
+  }
+
+  const double statistics_period = get_parameter("statistics_period").as_double();
+  if (statistics_period > 0.0) {
+    _published_statistics = snapshotStatistics();
+    _published_usage = snapshotUsage();
+    _statistics_published = std::chrono::steady_clock::now();
+    _statistics_timer = this->create_wall_timer(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(statistics_period)),
+      std::bind(&OusterDriver::publishStatistics, this));
+  }
+
+  const double diagnostics_period = get_parameter("diagnostics_period").as_double();
+  if (diagnostics_period > 0.0) {
+    _health->restart(healthSample());
+    _diagnostics_timer = this->create_wall_timer(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(diagnostics_period)),
+      std::bind(&OusterDriver::publishDiagnostics, this));
+  }
+
+  if (_metrics) {
+    _metrics->start();
+    RCLCPP_INFO(
+      this->get_logger(), "Serving metrics on http://127.0.0.1:%i/metrics", _metrics->port());
+  }
 }
 
 void OusterDriver::onError()
@@ -224,25 +532,95 @@ void OusterDriver::onDeactivate()
   _process_timer->cancel();
   _process_timer.reset();
 
+  if (_idle_timer) {
+    _idle_timer->cancel();
+    _idle_timer.reset();
+  }
+  if (_idle) {
+    _core->setIdle(false);
+    _idle = false;
+  }
+  if (_statistics_timer) {
+    _statistics_timer->cancel();
+    _statistics_timer.reset();
+  }
+  if (_diagnostics_timer) {
+    _diagnostics_timer->cancel();
+    _diagnostics_timer.reset();
+  }
+  if (_metrics) {
+    _metrics->stop();
+  }
+
   DataProcessorMapIt it;
   for (it = _data_processors.begin(); it != _data_processors.end(); ++it) {
     it->second->onDeactivate();
   }
+
+  _metadata_pub->on_deactivate();
+  _statistics_pub->on_deactivate();
+  _diagnostics_pub->on_deactivate();
 }
 
 void OusterDriver::onCleanup()
 {
-  _data_processors.clear();
+  _core->setPacketCallback(nullptr);
+  _metrics.reset();
+  destroyProcessors();
+  _scheduler.reset();
+  _deadline.reset();
+  _load.reset();
+  _statistics_srv.reset();
+  _statistics_pub.reset();
+  _statistics.reset();
+  _diagnostics_pub.reset();
+  _health.reset();
+  _published_statistics.clear();
+  _published_usage.clear();
+  _recorder.reset();
+  closeCompressedRecording();
+  _flight_recorder_srv.reset();
+  _flight_recorder.reset();
   _tf_b.reset();
   _reset_srv.reset();
   _metadata_srv.reset();
+  _metadata_pub.reset();
 }
 
 void OusterDriver::onShutdown()
 {
   _process_timer->cancel();
   _process_timer.reset();
+  if (_idle_timer) {
+    _idle_timer->cancel();
+    _idle_timer.reset();
+  }
+  if (_statistics_timer) {
+    _statistics_timer->cancel();
+    _statistics_timer.reset();
+  }
+  if (_diagnostics_timer) {
+    _diagnostics_timer->cancel();
+    _diagnostics_timer.reset();
+  }
+  _metrics.reset();
   _tf_b.reset();
+  // shutting down from active skips deactivating, so the image processor
+  // may still be rendering on the pool
+  destroyProcessors();
+  _scheduler.reset();
+  _recorder.reset();
+  closeCompressedRecording();
+  _flight_recorder.reset();
+  _statistics_srv.reset();
+  _statistics.reset();
+}
+
+void OusterDriver::destroyProcessors()
+{
+  if (_scheduler) {
+    _scheduler->clear();
+  }
 
   DataProcessorMapIt it;
   for (it = _data_processors.begin(); it != _data_processors.end(); ++it) {
@@ -275,31 +653,214 @@ void OusterDriver::broadcastStaticTransforms(
 void OusterDriver::processData()
 {
   try {
-    ClientState state = _sensor->get();
-    /*
-    RCLCPP_DEBUG(
-      this->get_logger(),
-      "Packet with state: %s",
-      ros2_ouster::toString(state).c_str());
-    */
-    uint8_t * packet_data = _sensor->readPacket(state);
-
-    if (packet_data) {
-    	uint32_t size = sizeof(packet_data);
-      std::pair<DataProcessorMapIt, DataProcessorMapIt> key_its;
-      key_its = _data_processors.equal_range(state);
-      uint64_t override_ts = 
-        this->_use_ros_time ? this->now().nanoseconds() : 0;
-
-      for (DataProcessorMapIt it = key_its.first; it != key_its.second; it++) {
-        it->second->process(packet_data, override_ts);
+    // drain the packets ready within a budget of one timer period, a
+    // packet per tick would cap the sensor at the tick rate, e.g. replay
+    // as fast as possible or of a sensor sending above 1 kpkt/s
+    const auto budget_end = std::chrono::steady_clock::now() + 1ms;
+    while (_core->poll() != ClientState::TIMEOUT &&
+      std::chrono::steady_clock::now() < budget_end)
+    {
+    }
+
+    const uint64_t drops = _deadline->dropped();
+    if (drops != _reported_drops) {
+      RCLCPP_WARN_THROTTLE(
+        this->get_logger(), *this->get_clock(), 5000,
+        "Dropped %lu outputs in total for being older than the maximum "
+        "frame age of %.3fs.",
+        static_cast<unsigned long>(drops),
+        _deadline->maxAge() * 1e-9);
+      _reported_drops = drops;
+      if (_flight_recorder) {
+        _flight_recorder->trigger("frame_overrun");
+      }
+    }
+
+    const unsigned load_level = _load ? _load->level() : 0;
+    if (_load && _load->update()) {
+      if (_load->level() > load_level) {
+        RCLCPP_WARN(this->get_logger(), "Shedding load: %s", _load->describe().c_str());
+      } else {
+        RCLCPP_INFO(this->get_logger(), "Restoring outputs: %s", _load->describe().c_str());
       }
     }
   } catch (const OusterDriverException & e) {
     RCLCPP_WARN(
       this->get_logger(),
       "Failed to process packet with exception %s.", e.what());
+    if (_flight_recorder) {
+      _flight_recorder->trigger("sensor_error");
+    }
+  }
+}
+
+void OusterDriver::publishStatistics()
+{
+  const std::vector<LatencyHistogram::Snapshot> snapshots = snapshotStatistics();
+  const std::vector<ResourceUsage::Totals> usage = snapshotUsage();
+  const auto now = std::chrono::steady_clock::now();
+  const double period = std::chrono::duration<double>(now - _statistics_published).count();
+
+  std::vector<LatencyHistogram::Snapshot> changes;
+  changes.reserve(snapshots.size());
+  for (std::size_t i = 0; i < snapshots.size(); i++) {
+    changes.push_back(
+      i < _published_statistics.size() ?
+      snapshots[i].since(_published_statistics[i]) : snapshots[i]);
+  }
+  std::vector<ResourceUsage::Totals> usage_changes;
+  usage_changes.reserve(usage.size());
+  for (std::size_t i = 0; i < usage.size(); i++) {
+    usage_changes.push_back(
+      i < _published_usage.size() ? usage[i].since(_published_usage[i]) : usage[i]);
+  }
+
+  _statistics_pub->publish(toStatisticsMsg(changes, usage_changes, period));
+  _published_statistics = snapshots;
+  _published_usage = usage;
+  _statistics_published = now;
+}
+
+void OusterDriver::publishDiagnostics()
+{
+  diagnostic_msgs::msg::DiagnosticArray msg;
+  msg.header.stamp = this->now();
+  msg.status.push_back(
+    toMsg(
+      _health->update(healthSample()), std::string(this->get_name()) + ": pipeline",
+      mdata.lidar_ip));
+  _diagnostics_pub->publish(msg);
+}
+
+HealthSample OusterDriver::healthSample() const
+{
+  return HealthSample::take(*_statistics, _core->kernelDrops(), _deadline->dropped(), _idle);
+}
+
+std::vector<LatencyHistogram::Snapshot> OusterDriver::snapshotStatistics() const
+{
+  std::vector<LatencyHistogram::Snapshot> snapshots;
+  const std::size_t stages = static_cast<std::size_t>(PipelineStage::COUNT);
+  for (std::size_t i = 0; i < stages; i++) {
+    snapshots.push_back(_statistics->stage(static_cast<PipelineStage>(i)).snapshot());
+  }
+  const std::size_t processors = _statistics->processors().size();
+  for (std::size_t i = 0; i < processors; i++) {
+    snapshots.push_back(_statistics->processorAt(i).snapshot());
+  }
+  return snapshots;
+}
+
+std::vector<ResourceUsage::Totals> OusterDriver::snapshotUsage() const
+{
+  std::vector<ResourceUsage::Totals> usage;
+  const std::size_t stages = static_cast<std::size_t>(PipelineStage::COUNT);
+  for (std::size_t i = 0; i < stages; i++) {
+    usage.push_back(_statistics->stageUsage(static_cast<PipelineStage>(i)).totals());
+  }
+  const std::size_t processors = _statistics->processors().size();
+  for (std::size_t i = 0; i < processors; i++) {
+    usage.push_back(_statistics->processorUsageAt(i).totals());
+  }
+  return usage;
+}
+
+ouster_msgs::msg::PipelineStatistics OusterDriver::toStatisticsMsg(
+  const std::vector<LatencyHistogram::Snapshot> & snapshots,
+  const std::vector<ResourceUsage::Totals> & usage, double period)
+{
+  ouster_msgs::msg::PipelineStatistics msg;
+  msg.header.stamp = this->now();
+  msg.period = period;
+
+  const std::size_t stages = static_cast<std::size_t>(PipelineStage::COUNT);
+  const std::vector<std::string> processors = _statistics->processors();
+  for (std::size_t i = 0; i < snapshots.size(); i++) {
+    if (i < stages) {
+      msg.stages.push_back(toMsg(snapshots[i], toString(static_cast<PipelineStage>(i))));
+    } else if (i - stages < processors.size()) {
+      msg.processors.push_back(toMsg(snapshots[i], processors[i - stages]));
+    }
+  }
+  for (std::size_t i = 0; i < usage.size(); i++) {
+    if (i < stages) {
+      msg.stage_usage.push_back(toMsg(usage[i], toString(static_cast<PipelineStage>(i))));
+    } else if (i - stages < processors.size()) {
+      msg.processor_usage.push_back(toMsg(usage[i], processors[i - stages]));
+    }
+  }
+  msg.allocations_counted = allocationsCounted();
+  return msg;
+}
+
+bool OusterDriver::isRecording() const
+{
+  return _recorder || _compressed_recorder || _flight_recorder;
+}
+
+void OusterDriver::checkSubscribers()
+{
+  // recorders are fed from the packet callback, they count as subscribers
+  // so that a recording has no gaps
+  bool subscribed = isRecording();
+  DataProcessorMapIt it;
+  for (it = _data_processors.begin(); it != _data_processors.end(); ++it) {
+    if (it->second->hasSubscribers()) {
+      subscribed = true;
+      break;
+    }
+  }
+
+  if (subscribed == _idle) {
+    setIdle(!subscribed);
+  } else if (_idle) {
+    // the kernel drops most packets with the minimal socket buffers,
+    // discard the few it queued
+    _core->drain();
+  }
+}
+
+void OusterDriver::setIdle(bool idle)
+{
+  if (idle) {
+    RCLCPP_INFO(this->get_logger(), "No subscribers, idling until one appears.");
+    _process_timer->cancel();
+    _core->setIdle(true);
+  } else {
+    RCLCPP_INFO(this->get_logger(), "Subscriber appeared, resuming processing.");
+    _core->setIdle(false);
+    if (_flight_recorder) {
+      _flight_recorder->restart();
+    }
+
+    // packets were skipped, partially assembled frames are stale
+    DataProcessorMapIt it;
+    for (it = _data_processors.begin(); it != _data_processors.end(); ++it) {
+      it->second->reset();
+    }
+    _process_timer->reset();
+    // the period checked starts now, not while idle
+    _health->restart(healthSample());
   }
+
+  _idle = idle;
+}
+
+void OusterDriver::closeCompressedRecording()
+{
+  if (!_compressed_recorder) {
+    return;
+  }
+
+  _compressed_recorder->close();
+  RCLCPP_INFO(
+    this->get_logger(), "Recorded %lu packets to %s, compressed %.2f:1 at %.1f MB/s, "
+    "%lu packets dropped.",
+    static_cast<unsigned long>(_compressed_recorder->packets()),
+    _compressed_recorder->path().c_str(), _compressed_recorder->ratio(),
+    _compressed_recorder->throughput(),
+    static_cast<unsigned long>(_compressed_recorder->dropped()));
+  _compressed_recorder.reset();
 }
 
 void OusterDriver::resetService(
@@ -318,7 +879,7 @@ void OusterDriver::resetService(
   lidar_config.lidar_port = get_parameter("lidar_port").as_int();
   lidar_config.lidar_mode = get_parameter("lidar_mode").as_string();
   lidar_config.timestamp_mode = get_parameter("timestamp_mode").as_string();
-  _sensor->reset(lidar_config);
+  _core->reset(lidar_config);
 }
 
 void OusterDriver::getMetadata(
@@ -333,4 +894,37 @@ void OusterDriver::getMetadata(
   response->metadata = toMsg(mdata);
 }
 
+void OusterDriver::getStatistics(
+  const std::shared_ptr<rmw_request_id_t>/*request_header*/,
+  const std::shared_ptr<ouster_msgs::srv::GetStatistics::Request> request,
+  std::shared_ptr<ouster_msgs::srv::GetStatistics::Response> response)
+{
+  const auto now = std::chrono::steady_clock::now();
+  response->statistics = toStatisticsMsg(
+    snapshotStatistics(), snapshotUsage(),
+    std::chrono::duration<double>(now - _statistics_start).count());
+
+  if (request->reset) {
+    _statistics->reset();
+    _statistics_start = now;
+    // the next period starts from empty histograms
+    _published_statistics = snapshotStatistics();
+    _published_usage = snapshotUsage();
+  }
+}
+
+void OusterDriver::dumpFlightRecorder(
+  const std::shared_ptr<rmw_request_id_t>/*request_header*/,
+  const std::shared_ptr<std_srvs::srv::Trigger::Request>/*request*/,
+  std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+{
+  try {
+    response->message = _flight_recorder->dump("request");
+    response->success = true;
+  } catch (const OusterDriverException & e) {
+    response->message = e.what();
+    response->success = false;
+  }
+}
+
 }  // namespace ros2_ouster
@@ -0,0 +1,185 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ros2_ouster/exception.hpp"
+#include "ros2_ouster/processor_scheduler.hpp"
+
+namespace ros2_ouster
+{
+
+ProcessorScheduler::ProcessorScheduler(
+  std::size_t threads, const std::vector<int> & affinity)
+{
+  if (threads > 1) {
+    _pool = std::make_unique<ThreadPool>(threads, affinity);
+  }
+}
+
+void ProcessorScheduler::configure(const DataProcessorMap & processors)
+{
+  _graphs.clear();
+
+  std::map<ClientState, std::vector<DataProcessorInterface *>> by_state;
+  for (auto it = processors.begin(); it != processors.end(); ++it) {
+    by_state[it->first].push_back(it->second);
+    it->second->setProducts(&_products);
+    it->second->setThreadPool(_pool.get());
+  }
+
+  for (auto & state_processors : by_state) {
+    std::vector<DataProcessorInterface *> & nodes = state_processors.second;
+
+    // every data type other than the raw packet needs exactly one producer
+    for (DataProcessorInterface * consumer : nodes) {
+      for (std::size_t i = 1; i < DATA_TYPE_COUNT; i++) {
+        const DataType type = static_cast<DataType>(1u << i);
+        if ((consumer->consumes() & type) == 0) {
+          continue;
+        }
+
+        std::size_t producers = 0;
+        for (DataProcessorInterface * producer : nodes) {
+          if (producer != consumer && (producer->produces() & type) != 0) {
+            producers++;
+          }
+        }
+
+        if (producers != 1) {
+          throw OusterDriverException(
+                  std::string("Data processor consumes ") + toString(type) +
+                  " which is produced by " + std::to_string(producers) +
+                  " processors, exactly one is required.");
+        }
+      }
+    }
+
+    // Kahn's algorithm, grouping processors whose dependencies are all
+    // satisfied by earlier levels into the same level
+    std::vector<std::size_t> in_degree(nodes.size(), 0);
+    std::vector<std::vector<std::size_t>> dependents(nodes.size());
+    for (std::size_t c = 0; c < nodes.size(); c++) {
+      const std::uint32_t needs = nodes[c]->consumes() & ~RAW_PACKET;
+      for (std::size_t p = 0; p < nodes.size(); p++) {
+        if (p != c && (nodes[p]->produces() & needs) != 0) {
+          dependents[p].push_back(c);
+          in_degree[c]++;
+        }
+      }
+    }
+
+    std::vector<Level> levels;
+    std::vector<std::size_t> frontier;
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+      if (in_degree[i] == 0) {
+        frontier.push_back(i);
+      }
+    }
+
+    std::size_t scheduled = 0;
+    while (!frontier.empty()) {
+      Level level;
+      std::vector<std::size_t> next;
+      for (std::size_t i : frontier) {
+        level.push_back(nodes[i]);
+        scheduled++;
+        for (std::size_t d : dependents[i]) {
+          if (--in_degree[d] == 0) {
+            next.push_back(d);
+          }
+        }
+      }
+      levels.push_back(level);
+      frontier.swap(next);
+    }
+
+    if (scheduled != nodes.size()) {
+      throw OusterDriverException(
+              std::string("Data processors have cyclic dependencies."));
+    }
+
+    _graphs[state_processors.first] = levels;
+  }
+}
+
+void ProcessorScheduler::process(const Packet & packet, uint64_t override_ts)
+{
+  auto graph = _graphs.find(packet.state);
+  if (graph == _graphs.end()) {
+    return;
+  }
+
+  _products.clear();
+  _products.set(RAW_PACKET, &packet);
+  for (const Level & level : graph->second) {
+    runLevel(level, packet.data, override_ts);
+  }
+}
+
+void ProcessorScheduler::clear()
+{
+  _graphs.clear();
+  _products.clear();
+}
+
+void ProcessorScheduler::runLevel(
+  const Level & level, uint8_t * data, uint64_t override_ts)
+{
+  // only run processors whose inputs were produced in this run
+  const std::uint32_t available = _products.available();
+  _ready.clear();
+  for (DataProcessorInterface * processor : level) {
+    if ((processor->consumes() & ~available) == 0) {
+      _ready.push_back(processor);
+    }
+  }
+
+  if (_ready.empty()) {
+    return;
+  }
+
+  if (!_pool || _ready.size() == 1) {
+    for (DataProcessorInterface * processor : _ready) {
+      run(processor, data, override_ts);
+    }
+    return;
+  }
+
+  _pool->parallelFor(
+    0, _ready.size(), 1, [this, data, override_ts](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i != end; i++) {
+        run(_ready[i], data, override_ts);
+      }
+    });
+}
+
+void ProcessorScheduler::run(
+  DataProcessorInterface * processor, uint8_t * data, uint64_t override_ts)
+{
+  LatencyHistogram * histogram = processor->histogram();
+  if (!histogram) {
+    processor->process(data, override_ts);
+    return;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const ResourceSample usage = ResourceSample::now();
+  processor->process(data, override_ts);
+  histogram->record(start);
+  processor->usage()->record(usage);
+}
+
+}  // namespace ros2_ouster
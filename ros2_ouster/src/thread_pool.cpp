@@ -0,0 +1,199 @@
+// Copyright 2020, Steve Macenski
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <utility>
+#include <vector>
+
+#include "ros2_ouster/thread_pool.hpp"
+
+namespace ros2_ouster
+{
+
+namespace
+{
+// queue owned by the current thread, if it is a worker of a pool
+thread_local const void * tls_pool = nullptr;
+thread_local std::size_t tls_queue = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(std::size_t threads, const std::vector<int> & affinity)
+: _queued(0), _stop(false)
+{
+  const std::size_t workers = threads > 1 ? threads - 1 : 0;
+  for (std::size_t i = 0; i <= workers; i++) {
+    _queues.emplace_back(std::make_unique<Queue>());
+  }
+
+  for (std::size_t i = 0; i < workers; i++) {
+    const int core = affinity.empty() ? -1 : affinity[i % affinity.size()];
+    _workers.emplace_back(&ThreadPool::workerLoop, this, i + 1, core);
+  }
+
+  // the cores the process may run on, which containers may restrict
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  const bool single_core = sched_getaffinity(0, sizeof(cpu_set_t), &cpus) == 0 &&
+    CPU_COUNT(&cpus) == 1;
+  _serial = _workers.empty() || single_core;
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_sleep_mutex);
+    _stop = true;
+  }
+  _sleep_cv.notify_all();
+
+  for (auto & worker : _workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::run(const std::vector<std::function<void()>> & tasks)
+{
+  parallelFor(
+    0, tasks.size(), 1, [&tasks](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i != end; i++) {
+        tasks[i]();
+      }
+    });
+}
+
+std::size_t ThreadPool::localQueue() const
+{
+  return tls_pool == this ? tls_queue : 0;
+}
+
+void ThreadPool::wake(std::size_t tasks)
+{
+  {
+    // pairs with the predicate check of sleeping workers
+    std::lock_guard<std::mutex> lock(_sleep_mutex);
+  }
+  if (tasks == 1) {
+    _sleep_cv.notify_one();
+  } else {
+    _sleep_cv.notify_all();
+  }
+}
+
+bool ThreadPool::tryRunOne()
+{
+  if (_queued.load(std::memory_order_acquire) == 0) {
+    return false;
+  }
+
+  const std::size_t home = localQueue();
+  Task task;
+  bool found = false;
+
+  // newest task of our own queue first, it is most likely still in cache
+  {
+    Queue & queue = *_queues[home];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      found = true;
+    }
+  }
+
+  // otherwise steal the oldest, typically largest remaining, task of another
+  for (std::size_t i = 1; !found && i < _queues.size(); i++) {
+    Queue & victim = *_queues[(home + i) % _queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      found = true;
+    }
+  }
+
+  if (!found) {
+    return false;
+  }
+
+  _queued.fetch_sub(1, std::memory_order_acq_rel);
+  execute(task);
+  return true;
+}
+
+void ThreadPool::execute(Task & task)
+{
+  TaskGroup * group = task.group;
+  try {
+    task.fn();
+  } catch (...) {
+    group->fail(std::current_exception());
+  }
+
+  // the waiter takes this mutex before returning, so the group outlives us
+  std::lock_guard<std::mutex> lock(group->mutex);
+  if (group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    group->done_cv.notify_all();
+  }
+}
+
+void ThreadPool::wait(TaskGroup & group)
+{
+  while (group.pending.load(std::memory_order_acquire) != 0) {
+    if (tryRunOne()) {
+      continue;
+    }
+
+    // remaining tasks of the group are all running on other threads, the
+    // last one to complete notifies under the mutex
+    std::unique_lock<std::mutex> lock(group.mutex);
+    group.done_cv.wait(
+      lock, [&group] {return group.pending.load(std::memory_order_acquire) == 0;});
+  }
+
+  std::lock_guard<std::mutex> lock(group.mutex);
+  if (group.error) {
+    std::rethrow_exception(group.error);
+  }
+}
+
+void ThreadPool::workerLoop(std::size_t index, int core)
+{
+  tls_pool = this;
+  tls_queue = index;
+
+  if (core >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+  }
+
+  while (true) {
+    if (tryRunOne()) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(_sleep_mutex);
+    _sleep_cv.wait(
+      lock, [this] {
+        return _stop || _queued.load(std::memory_order_acquire) != 0;
+      });
+    if (_stop) {
+      return;
+    }
+  }
+}
+
+}  // namespace ros2_ouster